@@ -0,0 +1,123 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "EngineInterface.h"
+#include "JobSystem.h"
+
+// Measures how a ParallelFor over a million entities scales with the number of threads
+// JobSystemBenchmark [entities] [iterations]
+
+const int kDefaultEntityCount = 1000000;
+const int kDefaultIterations = 50;
+
+struct Entity
+{
+	float mPosition[2];
+	float mVelocity[2];
+};
+
+// A step of a simple simulation, enough arithmetic per entity for memory bandwidth not to be the only thing measured
+static void UpdateEntities(Entity* pEntities, int nBegin, int nEnd, float fDeltaT)
+{
+	for (int i = nBegin; i < nEnd; ++i)
+	{
+		Entity& entity = pEntities[i];
+
+		// Steering towards the middle of the viewport
+		const float fToCenterX = kViewportWidth / 2.0f - entity.mPosition[0];
+		const float fToCenterY = kViewportHeight / 2.0f - entity.mPosition[1];
+		const float fDistance = sqrtf(fToCenterX * fToCenterX + fToCenterY * fToCenterY) + 1.0f;
+
+		entity.mVelocity[0] += fToCenterX / fDistance * 10.0f * fDeltaT;
+		entity.mVelocity[1] += fToCenterY / fDistance * 10.0f * fDeltaT;
+
+		entity.mPosition[0] += entity.mVelocity[0] * fDeltaT;
+		entity.mPosition[1] += entity.mVelocity[1] * fDeltaT;
+
+		// Bouncing off the edges
+		if (entity.mPosition[0] < 0.0f || entity.mPosition[0] > kViewportWidth)
+		{
+			entity.mVelocity[0] = -entity.mVelocity[0];
+		}
+
+		if (entity.mPosition[1] < 0.0f || entity.mPosition[1] > kViewportHeight)
+		{
+			entity.mVelocity[1] = -entity.mVelocity[1];
+		}
+	}
+}
+
+static void ResetEntities(std::vector<Entity>& entities)
+{
+	srand(1);
+
+	for (Entity& entity : entities)
+	{
+		entity.mPosition[0] = (float)(rand() % kViewportWidth);
+		entity.mPosition[1] = (float)(rand() % kViewportHeight);
+		entity.mVelocity[0] = (float)(rand() % 200 - 100);
+		entity.mVelocity[1] = (float)(rand() % 200 - 100);
+	}
+}
+
+// Best time of the iterations in milliseconds, the best one is the least disturbed by everything else running on the machine
+static double Measure(JobSystem& jobSystem, std::vector<Entity>& entities, int nIterations)
+{
+	ResetEntities(entities);
+
+	Entity* pEntities = entities.data();
+	double fBest = 1e30;
+
+	for (int i = 0; i < nIterations; ++i)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		jobSystem.ParallelFor((int)entities.size(), 0, [pEntities](int nBegin, int nEnd)
+		{
+			UpdateEntities(pEntities, nBegin, nEnd, 1 / 60.0f);
+		});
+
+		const double fMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		fBest = (fMilliseconds < fBest) ? fMilliseconds : fBest;
+	}
+
+	return fBest;
+}
+
+int main(int argc, char** argv)
+{
+	const int nEntities = (argc > 1) ? atoi(argv[1]) : kDefaultEntityCount;
+	const int nIterations = (argc > 2) ? atoi(argv[2]) : kDefaultIterations;
+
+	int nMaxThreads = (int)std::thread::hardware_concurrency();
+	nMaxThreads = (nMaxThreads > 0) ? nMaxThreads : 1;
+
+	std::vector<Entity> entities(nEntities > 0 ? nEntities : 1);
+
+	printf("%d entities, best of %d iterations, %d hardware threads\n", (int)entities.size(), nIterations, nMaxThreads);
+	printf("threads      ms   speedup   efficiency\n");
+
+	double fSingleThreaded = 0.0;
+
+	// Doubling the threads each time, and the whole machine last
+	for (int nThreads = 1; nThreads <= nMaxThreads; nThreads = (nThreads * 2 > nMaxThreads && nThreads < nMaxThreads) ? nMaxThreads : nThreads * 2)
+	{
+		JobSystem jobSystem;
+		jobSystem.Initialize(nThreads - 1);
+
+		const double fMilliseconds = Measure(jobSystem, entities, nIterations);
+
+		if (nThreads == 1)
+		{
+			fSingleThreaded = fMilliseconds;
+		}
+
+		const double fSpeedup = fSingleThreaded / fMilliseconds;
+		printf("%7d %7.3f %9.2f %11.0f%%\n", nThreads, fMilliseconds, fSpeedup, fSpeedup / nThreads * 100.0);
+	}
+
+	return 0;
+}
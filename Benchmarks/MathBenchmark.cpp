@@ -0,0 +1,273 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "EngineTypes.h"
+#include "BatchMath.h"
+
+// Compares the BatchMath kernels with the scalar exVector2 / exMatrix4 code they replace
+// MathBenchmark [points] [iterations]
+
+const int kDefaultPointCount = 1000000;
+const int kDefaultIterations = 20;
+const int kMatrixMultiplies = 1000000;
+
+// Keeps the results alive so the compiler can't drop the loops
+static volatile float gSink;
+
+// Best of the iterations, in milliseconds
+template <typename Function>
+static double Measure(int nIterations, Function function)
+{
+	double fBest = 1.0e30;
+
+	for (int i = 0; i < nIterations; ++i)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		function();
+		const double fMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		fBest = (fMilliseconds < fBest) ? fMilliseconds : fBest;
+	}
+
+	return fBest;
+}
+
+static void Report(const char* szName, double fScalar, double fBatch, double fError)
+{
+	printf("%-18s scalar %8.3f ms   batch %8.3f ms   %5.2fx   max error %g\n", szName, fScalar, fBatch, fScalar / fBatch, fError);
+}
+
+// The straightforward row vector product, the way it would be written without BatchMath
+static void MultiplyMatrixScalar(exMatrix4* pOut, const exMatrix4& a, const exMatrix4& b)
+{
+	const float* pA = a.ToFloatPtr();
+	const float* pB = b.ToFloatPtr();
+	float* pResult = pOut->ToFloatPtr();
+
+	for (int i = 0; i < 4; ++i)
+	{
+		for (int j = 0; j < 4; ++j)
+		{
+			float fSum = 0.0f;
+
+			for (int k = 0; k < 4; ++k)
+			{
+				fSum += pA[i * 4 + k] * pB[k * 4 + j];
+			}
+
+			pResult[i * 4 + j] = fSum;
+		}
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const int nPoints = (argc > 1) ? atoi(argv[1]) : kDefaultPointCount;
+	const int nIterations = (argc > 2) ? atoi(argv[2]) : kDefaultIterations;
+
+	if (nPoints < 1 || nIterations < 1)
+	{
+		fprintf(stderr, "usage: %s [points >= 1] [iterations >= 1]\n", argv[0]);
+		return 1;
+	}
+
+	printf("%d points, best of %d runs, BatchMath compiled for %s\n", nPoints, nIterations, BatchMath::GetInstructionSet());
+
+	// The same points as an array of exVector2 and as two arrays
+	std::vector<exVector2> points(nPoints);
+	std::vector<float> pointsX(nPoints);
+	std::vector<float> pointsY(nPoints);
+
+	srand(1);
+
+	for (int i = 0; i < nPoints; ++i)
+	{
+		points[i] = exVector2((rand() % 20000) / 10.0f - 1000.0f, (rand() % 20000) / 10.0f - 1000.0f);
+		pointsX[i] = points[i].x;
+		pointsY[i] = points[i].y;
+	}
+
+	// What the camera does to a world position, like UpdateCamera's view matrix
+	const exMatrix4 view = exMatrix4::exMakeScaleTranslationMatrix(1.5f, exVector2(400.0f, 300.0f));
+
+	std::vector<exVector2> transformed(nPoints);
+	std::vector<float> transformedX(nPoints);
+	std::vector<float> transformedY(nPoints);
+
+	const double fTransformScalar = Measure(nIterations, [&]()
+	{
+		for (int i = 0; i < nPoints; ++i)
+		{
+			const exVector2& v2Point = points[i];
+			transformed[i] = exVector2(v2Point.x * view.m11 + v2Point.y * view.m21 + view.m41, v2Point.x * view.m12 + v2Point.y * view.m22 + view.m42);
+		}
+	});
+
+	const double fTransformBatch = Measure(nIterations, [&]()
+	{
+		BatchMath::TransformPoints(view, pointsX.data(), pointsY.data(), transformedX.data(), transformedY.data(), nPoints);
+	});
+
+	double fError = 0.0;
+
+	for (int i = 0; i < nPoints; ++i)
+	{
+		fError = fmax(fError, fmax(fabs(transformed[i].x - transformedX[i]), fabs(transformed[i].y - transformedY[i])));
+	}
+
+	Report("transform points", fTransformScalar, fTransformBatch, fError);
+
+	// Normalizing works in place, so every run starts from a fresh copy, copied the same way for both
+	std::vector<exVector2> normalized(nPoints);
+	std::vector<float> normalizedX(nPoints);
+	std::vector<float> normalizedY(nPoints);
+
+	const double fNormalizeScalar = Measure(nIterations, [&]()
+	{
+		normalized = points;
+
+		for (int i = 0; i < nPoints; ++i)
+		{
+			normalized[i].Normalize();
+		}
+	});
+
+	const double fNormalizeBatch = Measure(nIterations, [&]()
+	{
+		normalizedX = pointsX;
+		normalizedY = pointsY;
+
+		BatchMath::NormalizeVectors(normalizedX.data(), normalizedY.data(), nPoints);
+	});
+
+	fError = 0.0;
+
+	for (int i = 0; i < nPoints; ++i)
+	{
+		if (points[i].SquaredMagnitude() > 0.0f)
+		{
+			fError = fmax(fError, fmax(fabs(normalized[i].x - normalizedX[i]), fabs(normalized[i].y - normalizedY[i])));
+		}
+	}
+
+	Report("normalize vectors", fNormalizeScalar, fNormalizeBatch, fError);
+
+	exVector2 v2ScalarMin(0.0f, 0.0f);
+	exVector2 v2ScalarMax(0.0f, 0.0f);
+
+	const double fBoundsScalar = Measure(nIterations, [&]()
+	{
+		v2ScalarMin = points[0];
+		v2ScalarMax = points[0];
+
+		// Same compares as ComputeBounds' scalar tail, fminf and fmaxf pay for NaN handling it doesn't have
+		for (int i = 1; i < nPoints; ++i)
+		{
+			v2ScalarMin.x = (points[i].x < v2ScalarMin.x) ? points[i].x : v2ScalarMin.x;
+			v2ScalarMin.y = (points[i].y < v2ScalarMin.y) ? points[i].y : v2ScalarMin.y;
+			v2ScalarMax.x = (points[i].x > v2ScalarMax.x) ? points[i].x : v2ScalarMax.x;
+			v2ScalarMax.y = (points[i].y > v2ScalarMax.y) ? points[i].y : v2ScalarMax.y;
+		}
+	});
+
+	exVector2 v2BatchMin(0.0f, 0.0f);
+	exVector2 v2BatchMax(0.0f, 0.0f);
+
+	const double fBoundsBatch = Measure(nIterations, [&]()
+	{
+		BatchMath::ComputeBounds(pointsX.data(), pointsY.data(), nPoints, v2BatchMin, v2BatchMax);
+	});
+
+	fError = fmax(fmax(fabs(v2ScalarMin.x - v2BatchMin.x), fabs(v2ScalarMin.y - v2BatchMin.y)), fmax(fabs(v2ScalarMax.x - v2BatchMax.x), fabs(v2ScalarMax.y - v2BatchMax.y)));
+
+	Report("bounds", fBoundsScalar, fBoundsBatch, fError);
+
+	// Boxes around the points against a view that sees about a tenth of them, the way the command buffer culls
+	const exVector2 v2ViewMin(-300.0f, -200.0f);
+	const exVector2 v2ViewMax(300.0f, 200.0f);
+
+	std::vector<float> boundsMaxX(nPoints);
+	std::vector<float> boundsMaxY(nPoints);
+
+	for (int i = 0; i < nPoints; ++i)
+	{
+		boundsMaxX[i] = pointsX[i] + 10.0f;
+		boundsMaxY[i] = pointsY[i] + 10.0f;
+	}
+
+	std::vector<uint32_t> visible(nPoints);
+	int nScalarVisible = 0;
+
+	const double fCullScalar = Measure(nIterations, [&]()
+	{
+		nScalarVisible = 0;
+
+		for (int i = 0; i < nPoints; ++i)
+		{
+			if (boundsMaxX[i] >= v2ViewMin.x && pointsX[i] <= v2ViewMax.x && boundsMaxY[i] >= v2ViewMin.y && pointsY[i] <= v2ViewMax.y)
+			{
+				visible[nScalarVisible++] = (uint32_t)i;
+			}
+		}
+	});
+
+	const std::vector<uint32_t> scalarVisible(visible.begin(), visible.begin() + nScalarVisible);
+	int nBatchVisible = 0;
+
+	const double fCullBatch = Measure(nIterations, [&]()
+	{
+		nBatchVisible = BatchMath::FindOverlappingBounds(pointsX.data(), pointsY.data(), boundsMaxX.data(), boundsMaxY.data(), nPoints, v2ViewMin, v2ViewMax, visible.data());
+	});
+
+	const bool bSameVisible = nScalarVisible == nBatchVisible && std::equal(scalarVisible.begin(), scalarVisible.end(), visible.begin());
+
+	Report("cull bounds", fCullScalar, fCullBatch, bSameVisible ? 0.0 : 1.0);
+
+	// A chain of products, each depending on the previous one, the way transforms are concatenated
+	const exMatrix4 projection = exMatrix4::exOrthographicProjectionMatrix(800.0f, 600.0f, -100.0f, 100.0f);
+
+	exMatrix4 scalarResult = view;
+	exMatrix4 batchResult = view;
+
+	const double fMultiplyScalar = Measure(nIterations, [&]()
+	{
+		scalarResult = view;
+
+		for (int i = 0; i < kMatrixMultiplies; ++i)
+		{
+			MultiplyMatrixScalar(&scalarResult, scalarResult, projection);
+			scalarResult.m41 = view.m41;
+		}
+	});
+
+	const double fMultiplyBatch = Measure(nIterations, [&]()
+	{
+		batchResult = view;
+
+		for (int i = 0; i < kMatrixMultiplies; ++i)
+		{
+			BatchMath::MultiplyMatrix(&batchResult, batchResult, projection);
+			batchResult.m41 = view.m41;
+		}
+	});
+
+	const exMatrix4 single = view * projection;
+	exMatrix4 singleScalar;
+	MultiplyMatrixScalar(&singleScalar, view, projection);
+
+	fError = 0.0;
+
+	for (int i = 0; i < 16; ++i)
+	{
+		fError = fmax(fError, fabs(single.ToFloatPtr()[i] - singleScalar.ToFloatPtr()[i]));
+	}
+
+	Report("4x4 multiply x1M", fMultiplyScalar, fMultiplyBatch, fError);
+
+	gSink = transformed[nPoints / 2].x + transformedX[nPoints / 2] + normalized[0].x + normalizedX[0] + scalarResult.m11 + batchResult.m11;
+
+	return 0;
+}
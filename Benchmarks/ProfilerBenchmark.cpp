@@ -0,0 +1,55 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "Profiler.h"
+
+// Measures what a PROFILE_SCOPE costs, recording included
+// ProfilerBenchmark [scopes] [trace.json]
+
+const int kDefaultScopeCount = 10000000;
+
+// Kept out of line so the loop really has a body to time
+#if defined(_MSC_VER)
+__declspec(noinline)
+#else
+__attribute__((noinline))
+#endif
+static int Work(int nValue)
+{
+	return nValue * 3 + 1;
+}
+
+int main(int argc, char** argv)
+{
+	const int nScopes = (argc > 1) ? atoi(argv[1]) : kDefaultScopeCount;
+	volatile int nSink = 0;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < nScopes; ++i)
+	{
+		nSink = Work(nSink);
+	}
+
+	const double fEmpty = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+	start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < nScopes; ++i)
+	{
+		PROFILE_SCOPE("Work");
+		nSink = Work(nSink);
+	}
+
+	const double fProfiled = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+	printf("%d scopes, %.2f ns per scope\n", nScopes, (fProfiled - fEmpty) / (nScopes > 0 ? nScopes : 1));
+
+	if (argc > 2 && !Profiler::WriteChromeTrace(argv[2]))
+	{
+		fprintf(stderr, "Could not write %s\n", argv[2]);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,194 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "EngineTypes.h"
+#include "SpatialGrid.h"
+
+// Moves objects around a world, keeps a SpatialGrid up to date with them and queries it every frame,
+// the queries are checked against testing every object and timed against it
+// SpatialBenchmark [objects] [frames]
+
+const int kDefaultObjectCount = 100000;
+const int kDefaultFrameCount = 60;
+
+const float kWorldSize = 4000.0f;
+const float kCellSize = 32.0f;
+
+// Queries run every frame, a game asking about what's near its characters, what its bullets hit and so on
+const int kBoxQueries = 1000;
+const int kRadiusQueries = 1000;
+const int kRayQueries = 100;
+
+const float kQuerySize = 64.0f;
+const float kRayLength = 500.0f;
+
+struct Object
+{
+	exVector2 mPosition;
+	exVector2 mVelocity;
+	exVector2 mHalfSize;
+};
+
+static float RandomFloat(float fMin, float fMax)
+{
+	return fMin + (fMax - fMin) * (rand() / (float)RAND_MAX);
+}
+
+static double Milliseconds(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv)
+{
+	const int nObjects = (argc > 1) ? atoi(argv[1]) : kDefaultObjectCount;
+	const int nFrames = (argc > 2) ? atoi(argv[2]) : kDefaultFrameCount;
+
+	if (nObjects < 1 || nFrames < 1)
+	{
+		fprintf(stderr, "usage: %s [objects >= 1] [frames >= 1]\n", argv[0]);
+		return 1;
+	}
+
+	srand(1);
+
+	std::vector<Object> objects(nObjects);
+	std::vector<exVector2> mins(nObjects, exVector2(0.0f, 0.0f));
+	std::vector<exVector2> maxs(nObjects, exVector2(0.0f, 0.0f));
+	std::vector<int> ids(nObjects);
+
+	for (int i = 0; i < nObjects; ++i)
+	{
+		Object& object = objects[i];
+		object.mPosition = exVector2(RandomFloat(0.0f, kWorldSize), RandomFloat(0.0f, kWorldSize));
+		object.mVelocity = exVector2(RandomFloat(-60.0f, 60.0f), RandomFloat(-60.0f, 60.0f));
+		object.mHalfSize = exVector2(RandomFloat(2.0f, 8.0f), RandomFloat(2.0f, 8.0f));
+
+		mins[i] = object.mPosition - object.mHalfSize;
+		maxs[i] = object.mPosition + object.mHalfSize;
+	}
+
+	SpatialGrid grid;
+	grid.Initialize(kCellSize);
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	grid.InsertMany(mins.data(), maxs.data(), nObjects, ids.data());
+	const double fInsertTime = Milliseconds(start);
+
+	double fUpdateTime = 0.0;
+	double fBoxTime = 0.0;
+	double fRadiusTime = 0.0;
+	double fRayTime = 0.0;
+	double fBruteForceTime = 0.0;
+	long long nFound = 0;
+	int nMismatches = 0;
+
+	const float fDeltaT = 1.0f / 60.0f;
+
+	for (int nFrame = 0; nFrame < nFrames; ++nFrame)
+	{
+		// Moving everything, bouncing off the edges of the world
+		for (int i = 0; i < nObjects; ++i)
+		{
+			Object& object = objects[i];
+			object.mPosition += object.mVelocity * fDeltaT;
+
+			if (object.mPosition.x < 0.0f || object.mPosition.x > kWorldSize)
+			{
+				object.mVelocity.x = -object.mVelocity.x;
+			}
+
+			if (object.mPosition.y < 0.0f || object.mPosition.y > kWorldSize)
+			{
+				object.mVelocity.y = -object.mVelocity.y;
+			}
+
+			mins[i] = object.mPosition - object.mHalfSize;
+			maxs[i] = object.mPosition + object.mHalfSize;
+		}
+
+		start = std::chrono::steady_clock::now();
+		grid.UpdateMany(ids.data(), mins.data(), maxs.data(), nObjects);
+		fUpdateTime += Milliseconds(start);
+
+		std::vector<exVector2> queries(kBoxQueries, exVector2(0.0f, 0.0f));
+
+		for (exVector2& v2Query : queries)
+		{
+			v2Query = exVector2(RandomFloat(0.0f, kWorldSize), RandomFloat(0.0f, kWorldSize));
+		}
+
+		std::vector<int> boxCounts(kBoxQueries, 0);
+
+		start = std::chrono::steady_clock::now();
+
+		for (int i = 0; i < kBoxQueries; ++i)
+		{
+			int& nCount = boxCounts[i];
+			grid.QueryBox(queries[i], queries[i] + exVector2(kQuerySize, kQuerySize), [&nCount](int) { ++nCount; });
+		}
+
+		fBoxTime += Milliseconds(start);
+
+		start = std::chrono::steady_clock::now();
+
+		for (int i = 0; i < kRadiusQueries; ++i)
+		{
+			grid.QueryRadius(queries[i], kQuerySize * 0.5f, [&nFound](int) { ++nFound; });
+		}
+
+		fRadiusTime += Milliseconds(start);
+
+		start = std::chrono::steady_clock::now();
+
+		for (int i = 0; i < kRayQueries; ++i)
+		{
+			const float fAngle = RandomFloat(0.0f, 6.2831853f);
+			grid.QueryRay(queries[i], exVector2(cosf(fAngle), sinf(fAngle)), kRayLength, [&nFound](int, float) { ++nFound; });
+		}
+
+		fRayTime += Milliseconds(start);
+
+		// What the box queries cost without the grid, once is enough to compare
+		if (nFrame == 0)
+		{
+			start = std::chrono::steady_clock::now();
+
+			for (int i = 0; i < kBoxQueries; ++i)
+			{
+				const exVector2 v2Min = queries[i];
+				const exVector2 v2Max = queries[i] + exVector2(kQuerySize, kQuerySize);
+				int nCount = 0;
+
+				for (int j = 0; j < nObjects; ++j)
+				{
+					if (maxs[j].x >= v2Min.x && mins[j].x <= v2Max.x && maxs[j].y >= v2Min.y && mins[j].y <= v2Max.y)
+					{
+						++nCount;
+					}
+				}
+
+				nMismatches += (nCount != boxCounts[i]) ? 1 : 0;
+			}
+
+			fBruteForceTime = Milliseconds(start);
+		}
+
+		for (int nCount : boxCounts)
+		{
+			nFound += nCount;
+		}
+	}
+
+	printf("%d objects, %d frames, %.0f world, %.0f cells\n", nObjects, nFrames, kWorldSize, kCellSize);
+	printf("Insert all          %8.3f ms\n", fInsertTime);
+	printf("Update all          %8.3f ms per frame\n", fUpdateTime / nFrames);
+	printf("%d box queries    %8.3f ms per frame (testing every object %.3f ms)\n", kBoxQueries, fBoxTime / nFrames, fBruteForceTime);
+	printf("%d radius queries %8.3f ms per frame\n", kRadiusQueries, fRadiusTime / nFrames);
+	printf("%d ray queries     %8.3f ms per frame\n", kRayQueries, fRayTime / nFrames);
+	printf("%lld objects found, %d box queries disagreeing with testing every object\n", nFound, nMismatches);
+
+	return (nMismatches == 0) ? 0 : 1;
+}
@@ -0,0 +1,211 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "EngineTypes.h"
+#include "EngineInterface.h"
+#include "RenderCommandBuffer.h"
+
+// Records random draws, culls them with RenderCommandBuffer::CullToView and checks the survivors against testing every command
+// on its own, the way the buffer culled before its bounds were tested four at a time
+// CullCheck [trials]
+
+const int kDefaultTrialCount = 2000;
+
+// Up to this many commands a trial, small counts go through the scalar tail of the batched test only
+const int kMaxCommands = 300;
+
+// Coordinates are whole numbers around the viewport, so plenty of commands touch the view's edges exactly
+const int kCoordinateRange = 1600;
+
+static int RandomInt(int nMin, int nMax)
+{
+	return nMin + rand() % (nMax - nMin + 1);
+}
+
+static exVector2 RandomPoint()
+{
+	return exVector2((float)RandomInt(-kCoordinateRange / 2, kCoordinateRange), (float)RandomInt(-kCoordinateRange / 2, kCoordinateRange));
+}
+
+// The command's number goes in its color, which culling and sorting carry along untouched
+static exColor MakeIDColor(int nID)
+{
+	exColor color;
+	color.SetColor((unsigned char)(nID & 0xFF), (unsigned char)((nID >> 8) & 0xFF), (unsigned char)((nID >> 16) & 0xFF));
+
+	return color;
+}
+
+static int GetID(const RenderCommand& command)
+{
+	return command.mColor.mColor[0] | (command.mColor.mColor[1] << 8) | (command.mColor.mColor[2] << 16);
+}
+
+static void AddRandomCommand(RenderCommandBuffer& buffer, int nID)
+{
+	const exColor color = MakeIDColor(nID);
+	const int nLayer = RandomInt(0, 3);
+	const float fRadius = (float)RandomInt(0, 200);
+	const float fWidth = (float)RandomInt(0, 8);
+
+	switch (RandomInt(0, 5))
+	{
+	case 0:
+		buffer.AddBox(RandomPoint(), RandomPoint(), color, nLayer);
+		break;
+	case 1:
+		buffer.AddCircle(RandomPoint(), fRadius, color, nLayer);
+		break;
+	case 2:
+		buffer.AddLine(RandomPoint(), RandomPoint(), fWidth, color, nLayer);
+		break;
+	case 3:
+		buffer.AddLineBox(RandomPoint(), RandomPoint(), fWidth, color, nLayer);
+		break;
+	case 4:
+		buffer.AddLineCircle(RandomPoint(), fRadius, fWidth, color, nLayer);
+		break;
+	default:
+		{
+			char szText[16];
+			snprintf(szText, sizeof(szText), "%d", nID);
+			buffer.AddText(0, RandomPoint(), szText, color, nLayer);
+		}
+		break;
+	}
+}
+
+// The per-command test CullToView replaced
+static bool IsVisible(const RenderCommand& command, const exVector2& v2CameraPosition, float fCameraZoom)
+{
+	if (command.mType == PRIMITIVE_TYPE::TEXT)
+	{
+		return true;
+	}
+
+	const float fHalfWidth = kViewportWidth / (2.0f * fCameraZoom);
+	const float fHalfHeight = kViewportHeight / (2.0f * fCameraZoom);
+	const float fViewMinX = v2CameraPosition.x - fHalfWidth;
+	const float fViewMinY = v2CameraPosition.y - fHalfHeight;
+	const float fViewMaxX = v2CameraPosition.x + fHalfWidth;
+	const float fViewMaxY = v2CameraPosition.y + fHalfHeight;
+
+	const float fExtent = command.mRadius + command.mWidth * 0.5f;
+	const float fMinX = ((command.mP1.x < command.mP2.x) ? command.mP1.x : command.mP2.x) - fExtent;
+	const float fMinY = ((command.mP1.y < command.mP2.y) ? command.mP1.y : command.mP2.y) - fExtent;
+	const float fMaxX = ((command.mP1.x > command.mP2.x) ? command.mP1.x : command.mP2.x) + fExtent;
+	const float fMaxY = ((command.mP1.y > command.mP2.y) ? command.mP1.y : command.mP2.y) + fExtent;
+
+	return fMaxX >= fViewMinX && fMinX <= fViewMaxX && fMaxY >= fViewMinY && fMinY <= fViewMaxY;
+}
+
+int main(int argc, char** argv)
+{
+	const int nTrials = (argc > 1) ? atoi(argv[1]) : kDefaultTrialCount;
+
+	if (nTrials < 1)
+	{
+		fprintf(stderr, "usage: %s [trials >= 1]\n", argv[0]);
+		return 1;
+	}
+
+	srand(1);
+
+	const float zooms[] = { 0.25f, 0.5f, 1.0f, 2.0f, 3.0f };
+
+	RenderCommandBuffer buffer;
+	RenderCommandBuffer otherBuffer;
+	std::vector<bool> expected;
+	std::vector<bool> found;
+	long long nTotalCommands = 0;
+	long long nTotalCulled = 0;
+
+	for (int nTrial = 0; nTrial < nTrials; ++nTrial)
+	{
+		buffer.Clear();
+		otherBuffer.Clear();
+
+		// Some of the draws come from another thread's buffer, the way CommandRecorder merges them
+		const int nCommands = RandomInt(0, kMaxCommands);
+		const int nOwnCommands = RandomInt(0, nCommands);
+
+		for (int i = 0; i < nCommands; ++i)
+		{
+			AddRandomCommand((i < nOwnCommands) ? buffer : otherBuffer, i);
+		}
+
+		buffer.Append(otherBuffer);
+
+		const exVector2 v2CameraPosition((float)RandomInt(0, kViewportWidth), (float)RandomInt(0, kViewportHeight));
+		const float fCameraZoom = zooms[RandomInt(0, 4)];
+
+		// What the commands look like once recorded, read back before culling
+		buffer.Sort();
+
+		expected.assign(nCommands, false);
+		int nExpectedCulled = 0;
+
+		for (int i = 0; i < buffer.GetCommandCount(); ++i)
+		{
+			const RenderCommand& command = buffer.GetSortedCommand(i);
+			expected[GetID(command)] = IsVisible(command, v2CameraPosition, fCameraZoom);
+			nExpectedCulled += expected[GetID(command)] ? 0 : 1;
+		}
+
+		const int nCulled = buffer.CullToView(v2CameraPosition, fCameraZoom);
+
+		if (nCulled != nExpectedCulled || buffer.GetCommandCount() != nCommands - nCulled)
+		{
+			fprintf(stderr, "trial %d: culled %d commands of %d, expected %d\n", nTrial, nCulled, nCommands, nExpectedCulled);
+			return 1;
+		}
+
+		buffer.Sort();
+
+		found.assign(nCommands, false);
+
+		for (int i = 0; i < buffer.GetCommandCount(); ++i)
+		{
+			const RenderCommand& command = buffer.GetSortedCommand(i);
+			const int nID = GetID(command);
+
+			if (nID >= nCommands || !expected[nID] || found[nID])
+			{
+				fprintf(stderr, "trial %d: command %d survived culling but shouldn't have, or twice\n", nTrial, nID);
+				return 1;
+			}
+
+			found[nID] = true;
+
+			// Compacting has to keep the recording order, which is what breaks ties between equal keys
+			if (i > 0)
+			{
+				const RenderCommand& previous = buffer.GetSortedCommand(i - 1);
+
+				if ((previous.mKey >> 32) == (command.mKey >> 32) && GetID(previous) > nID)
+				{
+					fprintf(stderr, "trial %d: commands %d and %d came out of culling in the wrong order\n", nTrial, GetID(previous), nID);
+					return 1;
+				}
+			}
+
+			// And each text has to stay with its command
+			char szText[16];
+			snprintf(szText, sizeof(szText), "%d", nID);
+
+			if (command.mType == PRIMITIVE_TYPE::TEXT && strcmp(buffer.GetText(command), szText) != 0)
+			{
+				fprintf(stderr, "trial %d: text command %d reads \"%s\"\n", nTrial, nID, buffer.GetText(command));
+				return 1;
+			}
+		}
+
+		nTotalCommands += nCommands;
+		nTotalCulled += nCulled;
+	}
+
+	printf("%d trials, %lld commands, %lld culled, all agree with the per-command test\n", nTrials, nTotalCommands, nTotalCulled);
+
+	return 0;
+}
@@ -0,0 +1,523 @@
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+#include "EntityWorld.h"
+#include "JobSystem.h"
+#include "SystemScheduler.h"
+
+// Creates, changes and destroys random entities in an EntityWorld and checks it against a plain array of entities after every few
+// changes, through lookups, every kind of query and systems run by a SystemScheduler
+// Build with ENGINEH_ENABLE_SANITIZERS to have the chunk and archetype moves checked for bad accesses as well
+// EntityCheck [trials]
+
+const int kDefaultTrialCount = 200;
+
+const int kBatchesPerTrial = 60;
+const int kMaxChangesPerBatch = 60;
+
+// Workers for the parallel queries and the systems
+const int kWorkerThreads = 3;
+
+// Components of every size, so archetypes end up with very different numbers of entities per chunk
+struct CheckPosition
+{
+	static const int kIndex = 0;
+
+	float x;
+	float y;
+
+	static CheckPosition Make(int nSeed) { return { (float)(nSeed % 1000), (float)(nSeed % 777) }; }
+	bool operator==(const CheckPosition& other) const { return x == other.x && y == other.y; }
+};
+
+struct CheckHealth
+{
+	static const int kIndex = 1;
+
+	int mHealth;
+	int mArmor;
+
+	static CheckHealth Make(int nSeed) { return { nSeed % 100, nSeed % 13 }; }
+	bool operator==(const CheckHealth& other) const { return mHealth == other.mHealth && mArmor == other.mArmor; }
+};
+
+// Big and over-aligned, a chunk only fits about 16 of them so archetypes with it quickly need several chunks
+struct alignas(32) CheckPayload
+{
+	static const int kIndex = 2;
+
+	uint32_t mWords[248];
+
+	static CheckPayload Make(int nSeed)
+	{
+		CheckPayload payload;
+
+		for (int i = 0; i < 248; ++i)
+		{
+			payload.mWords[i] = (uint32_t)nSeed * 2654435761u + (uint32_t)i;
+		}
+
+		return payload;
+	}
+
+	bool operator==(const CheckPayload& other) const
+	{
+		return memcmp(mWords, other.mWords, sizeof(mWords)) == 0;
+	}
+};
+
+struct CheckTag
+{
+	static const int kIndex = 3;
+
+	unsigned char mValue;
+
+	static CheckTag Make(int nSeed) { return { (unsigned char)nSeed }; }
+	bool operator==(const CheckTag& other) const { return mValue == other.mValue; }
+};
+
+// What an entity should look like, a bit per component type it has
+struct ModelEntity
+{
+	Entity mEntity;
+	bool mAlive;
+	unsigned int mMask;
+	std::tuple<CheckPosition, CheckHealth, CheckPayload, CheckTag> mValues;
+};
+
+static int RandomInt(int nMin, int nMax)
+{
+	return nMin + rand() % (nMax - nMin + 1);
+}
+
+template <typename T>
+static bool Has(const ModelEntity& model)
+{
+	return (model.mMask & (1u << T::kIndex)) != 0;
+}
+
+template <typename T>
+static void AddComponent(EntityWorld& world, ModelEntity& model)
+{
+	const T component = T::Make(rand());
+
+	world.AddComponent(model.mEntity, component);
+
+	std::get<T>(model.mValues) = component;
+	model.mMask |= 1u << T::kIndex;
+}
+
+template <typename T>
+static void RemoveComponent(EntityWorld& world, ModelEntity& model)
+{
+	world.RemoveComponent<T>(model.mEntity);
+
+	model.mMask &= ~(1u << T::kIndex);
+}
+
+// Changes the component in place, the way systems do
+template <typename T>
+static void WriteComponent(EntityWorld& world, ModelEntity& model)
+{
+	T* pComponent = world.GetComponent<T>(model.mEntity);
+
+	if (pComponent != nullptr)
+	{
+		*pComponent = T::Make(rand());
+		std::get<T>(model.mValues) = *pComponent;
+	}
+}
+
+template <typename T>
+static bool CheckComponent(EntityWorld& world, const ModelEntity& model, int nTrial, const char* szName)
+{
+	T* pComponent = world.GetComponent<T>(model.mEntity);
+	const bool bExpected = model.mAlive && Has<T>(model);
+
+	if (world.HasComponent<T>(model.mEntity) != bExpected || (pComponent != nullptr) != bExpected)
+	{
+		fprintf(stderr, "trial %d: entity %u.%u %s %s\n", nTrial, model.mEntity.mIndex, model.mEntity.mGeneration,
+			bExpected ? "lost its" : "has a", szName);
+		return false;
+	}
+
+	if (pComponent != nullptr && ((uintptr_t)pComponent % alignof(T) != 0 || !(*pComponent == std::get<T>(model.mValues))))
+	{
+		fprintf(stderr, "trial %d: entity %u.%u has the wrong %s\n", nTrial, model.mEntity.mIndex, model.mEntity.mGeneration, szName);
+		return false;
+	}
+
+	return true;
+}
+
+static ModelEntity CreateEntity(EntityWorld& world)
+{
+	ModelEntity model;
+	model.mAlive = true;
+	model.mMask = 0;
+
+	CheckPosition& position = std::get<CheckPosition>(model.mValues);
+	CheckHealth& health = std::get<CheckHealth>(model.mValues);
+	CheckPayload& payload = std::get<CheckPayload>(model.mValues);
+	CheckTag& tag = std::get<CheckTag>(model.mValues);
+
+	position = CheckPosition::Make(rand());
+	health = CheckHealth::Make(rand());
+	payload = CheckPayload::Make(rand());
+	tag = CheckTag::Make(rand());
+
+	switch (RandomInt(0, 6))
+	{
+	case 0:
+		model.mEntity = world.CreateEntity();
+		break;
+	case 1:
+		model.mEntity = world.CreateEntity(position);
+		model.mMask = 0x1;
+		break;
+	case 2:
+		model.mEntity = world.CreateEntity(position, health);
+		model.mMask = 0x3;
+		break;
+	case 3:
+		model.mEntity = world.CreateEntity(health, payload);
+		model.mMask = 0x6;
+		break;
+	case 4:
+		model.mEntity = world.CreateEntity(tag, payload, health, position);
+		model.mMask = 0xF;
+		break;
+	case 5:
+		model.mEntity = world.CreateEntity(tag);
+		model.mMask = 0x8;
+		break;
+	default:
+		model.mEntity = world.CreateEntity(payload, tag);
+		model.mMask = 0xC;
+		break;
+	}
+
+	return model;
+}
+
+// Makes a random change to a random entity
+static void ChangeEntity(EntityWorld& world, std::vector<ModelEntity>& models, std::vector<int>& alive)
+{
+	// Creating more than destroying, so the world keeps growing over a trial
+	const int nChange = RandomInt(0, 9);
+
+	if (alive.empty() || nChange < 3)
+	{
+		alive.push_back((int)models.size());
+		models.push_back(CreateEntity(world));
+		return;
+	}
+
+	const int nPick = RandomInt(0, (int)alive.size() - 1);
+	ModelEntity& model = models[alive[nPick]];
+
+	switch (nChange)
+	{
+	case 3:
+		world.DestroyEntity(model.mEntity);
+		model.mAlive = false;
+
+		alive[nPick] = alive.back();
+		alive.pop_back();
+		break;
+	case 4:
+	case 5:
+		switch (RandomInt(0, 3))
+		{
+		case 0: AddComponent<CheckPosition>(world, model); break;
+		case 1: AddComponent<CheckHealth>(world, model); break;
+		case 2: AddComponent<CheckPayload>(world, model); break;
+		default: AddComponent<CheckTag>(world, model); break;
+		}
+		break;
+	case 6:
+	case 7:
+		switch (RandomInt(0, 3))
+		{
+		case 0: RemoveComponent<CheckPosition>(world, model); break;
+		case 1: RemoveComponent<CheckHealth>(world, model); break;
+		case 2: RemoveComponent<CheckPayload>(world, model); break;
+		default: RemoveComponent<CheckTag>(world, model); break;
+		}
+		break;
+	case 8:
+		switch (RandomInt(0, 3))
+		{
+		case 0: WriteComponent<CheckPosition>(world, model); break;
+		case 1: WriteComponent<CheckHealth>(world, model); break;
+		case 2: WriteComponent<CheckPayload>(world, model); break;
+		default: WriteComponent<CheckTag>(world, model); break;
+		}
+		break;
+	default:
+		// Handles of destroyed entities have to stay harmless, even once their index is in use again
+		for (const ModelEntity& other : models)
+		{
+			if (!other.mAlive)
+			{
+				world.DestroyEntity(other.mEntity);
+				world.AddComponent(other.mEntity, CheckTag::Make(0));
+				world.RemoveComponent<CheckPosition>(other.mEntity);
+				break;
+			}
+		}
+		break;
+	}
+}
+
+static bool CheckWorld(EntityWorld& world, JobSystem& jobSystem, const std::vector<ModelEntity>& models, int nAlive, int nTrial)
+{
+	if (world.GetEntityCount() != nAlive)
+	{
+		fprintf(stderr, "trial %d: the world has %d entities, expected %d\n", nTrial, world.GetEntityCount(), nAlive);
+		return false;
+	}
+
+	// Every entity on its own, the destroyed ones included
+	std::unordered_map<uint32_t, int> modelByIndex;
+
+	for (int i = 0; i < (int)models.size(); ++i)
+	{
+		const ModelEntity& model = models[i];
+
+		if (world.IsAlive(model.mEntity) != model.mAlive)
+		{
+			fprintf(stderr, "trial %d: entity %u.%u is %s\n", nTrial, model.mEntity.mIndex, model.mEntity.mGeneration, model.mAlive ? "gone" : "still alive");
+			return false;
+		}
+
+		if (!CheckComponent<CheckPosition>(world, model, nTrial, "position") || !CheckComponent<CheckHealth>(world, model, nTrial, "health") ||
+			!CheckComponent<CheckPayload>(world, model, nTrial, "payload") || !CheckComponent<CheckTag>(world, model, nTrial, "tag"))
+		{
+			return false;
+		}
+
+		if (model.mAlive)
+		{
+			modelByIndex[model.mEntity.mIndex] = i;
+		}
+	}
+
+	// A query has to hand out every entity with the components once, with their values, in arrays as aligned as their type
+	std::vector<int> seen(models.size(), 0);
+	int nExpected = 0;
+	bool bAgrees = true;
+
+	for (const ModelEntity& model : models)
+	{
+		nExpected += (model.mAlive && Has<CheckHealth>(model) && Has<CheckPayload>(model)) ? 1 : 0;
+	}
+
+	world.ForEachChunk<const CheckHealth, const CheckPayload>([&](int nCount, const Entity* pEntities, const CheckHealth* pHealths, const CheckPayload* pPayloads)
+	{
+		bAgrees = bAgrees && nCount > 0 && (uintptr_t)pPayloads % alignof(CheckPayload) == 0;
+
+		for (int i = 0; i < nCount && bAgrees; ++i)
+		{
+			const std::unordered_map<uint32_t, int>::const_iterator found = modelByIndex.find(pEntities[i].mIndex);
+
+			if (found == modelByIndex.end() || models[found->second].mEntity != pEntities[i])
+			{
+				bAgrees = false;
+				break;
+			}
+
+			const ModelEntity& model = models[found->second];
+
+			bAgrees = ++seen[found->second] == 1 && Has<CheckHealth>(model) && Has<CheckPayload>(model) &&
+				pHealths[i] == std::get<CheckHealth>(model.mValues) && pPayloads[i] == std::get<CheckPayload>(model.mValues);
+		}
+	});
+
+	int nSeen = 0;
+
+	for (int nCount : seen)
+	{
+		nSeen += nCount;
+	}
+
+	if (!bAgrees || nSeen != nExpected)
+	{
+		fprintf(stderr, "trial %d: ForEachChunk went over %d entities with health and payload, expected %d\n", nTrial, nSeen, nExpected);
+		return false;
+	}
+
+	// The same over the job system, counting every entity's visits from whichever thread gets its chunk
+	std::vector<std::atomic<int>> visits(models.size());
+
+	for (std::atomic<int>& nVisits : visits)
+	{
+		nVisits = 0;
+	}
+
+	world.ParallelForEachChunk<const CheckTag>(jobSystem, [&](int nCount, const Entity* pEntities, const CheckTag* pTags)
+	{
+		for (int i = 0; i < nCount; ++i)
+		{
+			const std::unordered_map<uint32_t, int>::const_iterator found = modelByIndex.find(pEntities[i].mIndex);
+
+			if (found != modelByIndex.end() && pTags[i] == std::get<CheckTag>(models[found->second].mValues))
+			{
+				++visits[found->second];
+			}
+		}
+	});
+
+	for (int i = 0; i < (int)models.size(); ++i)
+	{
+		const int nExpectedVisits = (models[i].mAlive && Has<CheckTag>(models[i])) ? 1 : 0;
+
+		if (visits[i] != nExpectedVisits)
+		{
+			fprintf(stderr, "trial %d: ParallelForEachChunk visited entity %u.%u %d times, expected %d\n", nTrial,
+				models[i].mEntity.mIndex, models[i].mEntity.mGeneration, visits[i].load(), nExpectedVisits);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Systems that each change a component the way the model does below, Heal writes what Move reads so it has to run after it
+static void AddSystems(SystemScheduler& scheduler, EntityWorld& world, JobSystem& jobSystem)
+{
+	const int nMove = scheduler.AddSystem("Move", [&world, &jobSystem](float fDeltaT)
+	{
+		world.ParallelForEachChunk<CheckPosition, const CheckHealth>(jobSystem, [](int nCount, const Entity*, CheckPosition* pPositions, const CheckHealth* pHealths)
+		{
+			for (int i = 0; i < nCount; ++i)
+			{
+				pPositions[i].x += (float)pHealths[i].mHealth;
+			}
+		});
+	});
+
+	scheduler.AddWrite<CheckPosition>(nMove);
+	scheduler.AddRead<CheckHealth>(nMove);
+
+	const int nHeal = scheduler.AddSystem("Heal", [&world](float fDeltaT)
+	{
+		world.ForEach<CheckHealth>([](CheckHealth& health)
+		{
+			health.mHealth = (health.mHealth + 1) % 100;
+		});
+	});
+
+	scheduler.AddWrite<CheckHealth>(nHeal);
+
+	const int nFlip = scheduler.AddSystem("Flip", [&world, &jobSystem](float fDeltaT)
+	{
+		world.ParallelForEachChunk<CheckTag>(jobSystem, [](int nCount, const Entity*, CheckTag* pTags)
+		{
+			for (int i = 0; i < nCount; ++i)
+			{
+				pTags[i].mValue ^= 0x5A;
+			}
+		});
+	});
+
+	scheduler.AddWrite<CheckTag>(nFlip);
+}
+
+static void RunSystemsOnModel(std::vector<ModelEntity>& models)
+{
+	for (ModelEntity& model : models)
+	{
+		if (!model.mAlive)
+		{
+			continue;
+		}
+
+		CheckPosition& position = std::get<CheckPosition>(model.mValues);
+		CheckHealth& health = std::get<CheckHealth>(model.mValues);
+		CheckTag& tag = std::get<CheckTag>(model.mValues);
+
+		if (Has<CheckPosition>(model) && Has<CheckHealth>(model))
+		{
+			position.x += (float)health.mHealth;
+		}
+
+		if (Has<CheckHealth>(model))
+		{
+			health.mHealth = (health.mHealth + 1) % 100;
+		}
+
+		if (Has<CheckTag>(model))
+		{
+			tag.mValue ^= 0x5A;
+		}
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const int nTrials = (argc > 1) ? atoi(argv[1]) : kDefaultTrialCount;
+
+	if (nTrials < 1)
+	{
+		fprintf(stderr, "usage: %s [trials >= 1]\n", argv[0]);
+		return 1;
+	}
+
+	srand(1);
+
+	JobSystem jobSystem;
+	jobSystem.Initialize(kWorkerThreads);
+
+	long long nChanges = 0;
+	int nMostEntities = 0;
+
+	for (int nTrial = 0; nTrial < nTrials; ++nTrial)
+	{
+		EntityWorld world;
+		SystemScheduler scheduler;
+		AddSystems(scheduler, world, jobSystem);
+
+		std::vector<ModelEntity> models;
+		std::vector<int> alive;
+
+		for (int nBatch = 0; nBatch < kBatchesPerTrial; ++nBatch)
+		{
+			const int nBatchChanges = RandomInt(1, kMaxChangesPerBatch);
+
+			for (int i = 0; i < nBatchChanges; ++i)
+			{
+				ChangeEntity(world, models, alive);
+			}
+
+			nChanges += nBatchChanges;
+			nMostEntities = ((int)alive.size() > nMostEntities) ? (int)alive.size() : nMostEntities;
+
+			if (!CheckWorld(world, jobSystem, models, (int)alive.size(), nTrial))
+			{
+				return 1;
+			}
+
+			if (nBatch % 3 == 0)
+			{
+				scheduler.Run(jobSystem, 1.0f);
+				RunSystemsOnModel(models);
+
+				if (!CheckWorld(world, jobSystem, models, (int)alive.size(), nTrial))
+				{
+					fprintf(stderr, "trial %d: the systems didn't change the world like the model\n", nTrial);
+					return 1;
+				}
+			}
+		}
+	}
+
+	printf("%d trials, %lld changes, up to %d entities, the world always agrees with the model\n", nTrials, nChanges, nMostEntities);
+
+	return 0;
+}
@@ -0,0 +1,430 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "EngineTypes.h"
+#include "SpatialGrid.h"
+
+// Inserts, moves and removes random objects in a SpatialGrid, one at a time and in bulk, and checks every kind of query
+// against testing every object that is still around
+// SpatialCheck [trials]
+
+const int kDefaultTrialCount = 200;
+
+// Changes made to the grid in a trial, with queries after every few of them
+const int kStepsPerTrial = 60;
+const int kQueriesPerStep = 10;
+const int kMaxBulkCount = 40;
+
+const float kCellSize = 16.0f;
+const float kWorldSize = 600.0f;
+
+// Objects the grid should hold, indexed by ID like the grid's own arrays
+struct ModelObject
+{
+	bool mAlive;
+	exVector2 mMin;
+	exVector2 mMax;
+};
+
+static int RandomInt(int nMin, int nMax)
+{
+	return nMin + rand() % (nMax - nMin + 1);
+}
+
+static float RandomFloat(float fMin, float fMax)
+{
+	return fMin + (fMax - fMin) * (rand() / (float)RAND_MAX);
+}
+
+// Half the values are snapped to quarter cells, so boxes and queries often start and end exactly on the cell edges or on each other
+static float Snap(float fValue)
+{
+	return (rand() % 2 == 0) ? floorf(fValue / (kCellSize * 0.25f)) * (kCellSize * 0.25f) : fValue;
+}
+
+static float RandomCoordinate()
+{
+	return Snap(RandomFloat(-kWorldSize, kWorldSize));
+}
+
+// Mostly objects around the cell size, now and then one spanning many cells or none at all
+static void RandomBox(exVector2& v2Min, exVector2& v2Max)
+{
+	const int nKind = RandomInt(0, 9);
+	const float fMaxHalfSize = (nKind == 0) ? kCellSize * 20.0f : ((nKind == 1) ? 0.0f : kCellSize);
+	const exVector2 v2Center(RandomCoordinate(), RandomCoordinate());
+	const exVector2 v2HalfSize(Snap(RandomFloat(0.0f, fMaxHalfSize)), Snap(RandomFloat(0.0f, fMaxHalfSize)));
+
+	v2Min = v2Center - v2HalfSize;
+	v2Max = v2Center + v2HalfSize;
+}
+
+// Moved a little most of the time, which often keeps an object in the same cells, or anywhere else
+static void MoveBox(exVector2& v2Min, exVector2& v2Max)
+{
+	if (RandomInt(0, 3) == 0)
+	{
+		RandomBox(v2Min, v2Max);
+		return;
+	}
+
+	const exVector2 v2Offset(RandomFloat(-kCellSize, kCellSize), RandomFloat(-kCellSize, kCellSize));
+	v2Min += v2Offset;
+	v2Max += v2Offset;
+}
+
+static int PickAlive(const std::vector<ModelObject>& model, int nAlive)
+{
+	int nPick = RandomInt(0, nAlive - 1);
+
+	for (int i = 0; i < (int)model.size(); ++i)
+	{
+		if (model[i].mAlive && nPick-- == 0)
+		{
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+// The same slab test as the grid's, which reports objects from the cells it walks instead of testing them all
+static bool IntersectRay(const ModelObject& object, const exVector2& v2Origin, const exVector2& v2Direction, float fMaxDistance, float& fDistance)
+{
+	const exVector2 v2Step = v2Direction / v2Direction.Magnitude();
+	float fEnter = 0.0f;
+	float fExit = fMaxDistance;
+
+	const float* pOrigin = &v2Origin.x;
+	const float* pStep = &v2Step.x;
+	const float* pMin = &object.mMin.x;
+	const float* pMax = &object.mMax.x;
+
+	for (int nAxis = 0; nAxis < 2; ++nAxis)
+	{
+		if (pStep[nAxis] != 0.0f)
+		{
+			const float fInverse = 1.0f / pStep[nAxis];
+			const float fT1 = (pMin[nAxis] - pOrigin[nAxis]) * fInverse;
+			const float fT2 = (pMax[nAxis] - pOrigin[nAxis]) * fInverse;
+			fEnter = fmaxf(fEnter, fminf(fT1, fT2));
+			fExit = fminf(fExit, fmaxf(fT1, fT2));
+		}
+		else if (pOrigin[nAxis] < pMin[nAxis] || pOrigin[nAxis] > pMax[nAxis])
+		{
+			return false;
+		}
+	}
+
+	fDistance = fEnter;
+	return fEnter <= fExit;
+}
+
+// Compares what a query found with what it should have, nothing missing, nothing extra and nothing twice
+static bool CompareFound(const char* szQuery, int nTrial, const std::vector<bool>& expected, std::vector<int>& found)
+{
+	std::vector<int> counts(expected.size(), 0);
+
+	for (int nID : found)
+	{
+		if (nID < 0 || nID >= (int)expected.size())
+		{
+			fprintf(stderr, "trial %d: %s query found unknown object %d\n", nTrial, szQuery, nID);
+			return false;
+		}
+
+		++counts[nID];
+	}
+
+	for (int i = 0; i < (int)expected.size(); ++i)
+	{
+		if (counts[i] != (expected[i] ? 1 : 0))
+		{
+			fprintf(stderr, "trial %d: %s query found object %d %d times, expected %d\n", nTrial, szQuery, i, counts[i], expected[i] ? 1 : 0);
+			return false;
+		}
+	}
+
+	found.clear();
+	return true;
+}
+
+static bool CheckQueries(const SpatialGrid& grid, const std::vector<ModelObject>& model, int nTrial)
+{
+	std::vector<bool> expected(model.size(), false);
+	std::vector<int> found;
+
+	for (int nQuery = 0; nQuery < kQueriesPerStep; ++nQuery)
+	{
+		// Boxes of every size, a few of them bigger than the whole world
+		exVector2 v2Min;
+		exVector2 v2Max;
+		RandomBox(v2Min, v2Max);
+
+		if (nQuery == 0)
+		{
+			v2Min = exVector2(-kWorldSize * 4.0f, -kWorldSize * 4.0f);
+			v2Max = exVector2(kWorldSize * 4.0f, kWorldSize * 4.0f);
+		}
+
+		for (int i = 0; i < (int)model.size(); ++i)
+		{
+			const ModelObject& object = model[i];
+			expected[i] = object.mAlive && object.mMax.x >= v2Min.x && object.mMin.x <= v2Max.x && object.mMax.y >= v2Min.y && object.mMin.y <= v2Max.y;
+		}
+
+		grid.QueryBox(v2Min, v2Max, [&found](int nID) { found.push_back(nID); });
+
+		if (!CompareFound("box", nTrial, expected, found))
+		{
+			return false;
+		}
+
+		const exVector2 v2Center(RandomCoordinate(), RandomCoordinate());
+		const float fRadius = RandomFloat(0.0f, kCellSize * 6.0f);
+
+		for (int i = 0; i < (int)model.size(); ++i)
+		{
+			const ModelObject& object = model[i];
+			const float fDX = v2Center.x - fminf(fmaxf(v2Center.x, object.mMin.x), object.mMax.x);
+			const float fDY = v2Center.y - fminf(fmaxf(v2Center.y, object.mMin.y), object.mMax.y);
+			expected[i] = object.mAlive && fDX * fDX + fDY * fDY <= fRadius * fRadius;
+		}
+
+		grid.QueryRadius(v2Center, fRadius, [&found](int nID) { found.push_back(nID); });
+
+		if (!CompareFound("radius", nTrial, expected, found))
+		{
+			return false;
+		}
+
+		// Every direction, the axis aligned ones included since they take their own path through the slab test
+		const exVector2 v2Origin(RandomCoordinate(), RandomCoordinate());
+		const float fMaxDistance = RandomFloat(0.0f, kWorldSize);
+		const float fAngle = RandomFloat(0.0f, 6.2831853f);
+		exVector2 v2Direction(cosf(fAngle), sinf(fAngle));
+
+		if (nQuery % 4 == 1)
+		{
+			v2Direction = (nQuery % 8 == 1) ? exVector2(RandomFloat(-2.0f, 2.0f), 0.0f) : exVector2(0.0f, RandomFloat(-2.0f, 2.0f));
+		}
+
+		if (v2Direction.Magnitude() <= 0.0f)
+		{
+			continue;
+		}
+
+		std::vector<float> distances(model.size(), 0.0f);
+
+		for (int i = 0; i < (int)model.size(); ++i)
+		{
+			expected[i] = model[i].mAlive && IntersectRay(model[i], v2Origin, v2Direction, fMaxDistance, distances[i]);
+		}
+
+		bool bDistancesAgree = true;
+
+		grid.QueryRay(v2Origin, v2Direction, fMaxDistance, [&](int nID, float fDistance)
+		{
+			found.push_back(nID);
+
+			if (nID >= 0 && nID < (int)model.size() && fabsf(fDistance - distances[nID]) > 1.0e-3f)
+			{
+				fprintf(stderr, "trial %d: ray query found object %d at %f, expected %f\n", nTrial, nID, fDistance, distances[nID]);
+				bDistancesAgree = false;
+			}
+		});
+
+		if (!bDistancesAgree || !CompareFound("ray", nTrial, expected, found))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	const int nTrials = (argc > 1) ? atoi(argv[1]) : kDefaultTrialCount;
+
+	if (nTrials < 1)
+	{
+		fprintf(stderr, "usage: %s [trials >= 1]\n", argv[0]);
+		return 1;
+	}
+
+	srand(1);
+
+	SpatialGrid grid;
+	std::vector<ModelObject> model;
+	std::vector<exVector2> mins;
+	std::vector<exVector2> maxs;
+	std::vector<int> ids;
+	long long nOperations = 0;
+
+	for (int nTrial = 0; nTrial < nTrials; ++nTrial)
+	{
+		// Clearing keeps the grid, and so the IDs it hands out, while initializing starts over
+		if (nTrial % 4 == 3)
+		{
+			grid.Clear();
+		}
+		else
+		{
+			grid.Initialize(kCellSize);
+		}
+
+		model.clear();
+		int nAlive = 0;
+
+		for (int nStep = 0; nStep < kStepsPerTrial; ++nStep)
+		{
+			const int nOperation = (nAlive == 0) ? RandomInt(0, 1) : RandomInt(0, 5);
+			const int nCount = RandomInt(1, kMaxBulkCount);
+
+			mins.clear();
+			maxs.clear();
+			ids.clear();
+
+			switch (nOperation)
+			{
+			case 0:
+			case 1:
+				// Inserting, one by one or in bulk
+				for (int i = 0; i < nCount; ++i)
+				{
+					exVector2 v2Min;
+					exVector2 v2Max;
+					RandomBox(v2Min, v2Max);
+
+					mins.push_back(v2Min);
+					maxs.push_back(v2Max);
+				}
+
+				ids.resize(nCount);
+
+				if (nOperation == 0)
+				{
+					grid.InsertMany(mins.data(), maxs.data(), nCount, ids.data());
+				}
+				else
+				{
+					for (int i = 0; i < nCount; ++i)
+					{
+						ids[i] = grid.Insert(mins[i], maxs[i]);
+					}
+				}
+
+				for (int i = 0; i < nCount; ++i)
+				{
+					if (ids[i] < (int)model.size() && (ids[i] < 0 || model[ids[i]].mAlive))
+					{
+						fprintf(stderr, "trial %d: insert returned ID %d, which is in use\n", nTrial, ids[i]);
+						return 1;
+					}
+
+					if (ids[i] >= (int)model.size())
+					{
+						model.resize(ids[i] + 1, { false, exVector2(0.0f, 0.0f), exVector2(0.0f, 0.0f) });
+					}
+
+					model[ids[i]] = { true, mins[i], maxs[i] };
+				}
+
+				nAlive += nCount;
+				break;
+
+			case 2:
+			case 3:
+				// Moving, every object at most once in a bulk update
+				for (int i = 0; i < nCount && i < nAlive; ++i)
+				{
+					const int nID = PickAlive(model, nAlive);
+					bool bPicked = false;
+
+					for (int nOther : ids)
+					{
+						bPicked = bPicked || nOther == nID;
+					}
+
+					if (bPicked)
+					{
+						continue;
+					}
+
+					exVector2 v2Min = model[nID].mMin;
+					exVector2 v2Max = model[nID].mMax;
+					MoveBox(v2Min, v2Max);
+
+					ids.push_back(nID);
+					mins.push_back(v2Min);
+					maxs.push_back(v2Max);
+				}
+
+				if (nOperation == 2)
+				{
+					grid.UpdateMany(ids.data(), mins.data(), maxs.data(), (int)ids.size());
+				}
+				else
+				{
+					for (int i = 0; i < (int)ids.size(); ++i)
+					{
+						grid.Update(ids[i], mins[i], maxs[i]);
+					}
+				}
+
+				for (int i = 0; i < (int)ids.size(); ++i)
+				{
+					model[ids[i]].mMin = mins[i];
+					model[ids[i]].mMax = maxs[i];
+				}
+
+				break;
+
+			default:
+				// Removing, in bulk or one by one, mostly fewer than were inserted so the grid fills up over the trial
+				for (int i = 0; i < nCount / 2 + 1 && nAlive > 0; ++i)
+				{
+					const int nID = PickAlive(model, nAlive);
+
+					model[nID].mAlive = false;
+					--nAlive;
+
+					ids.push_back(nID);
+				}
+
+				if (nOperation == 4)
+				{
+					grid.RemoveMany(ids.data(), (int)ids.size());
+				}
+				else
+				{
+					for (int nID : ids)
+					{
+						grid.Remove(nID);
+					}
+				}
+
+				break;
+			}
+
+			++nOperations;
+
+			if (grid.GetCount() != nAlive)
+			{
+				fprintf(stderr, "trial %d: the grid holds %d objects, expected %d\n", nTrial, grid.GetCount(), nAlive);
+				return 1;
+			}
+
+			if (!CheckQueries(grid, model, nTrial))
+			{
+				return 1;
+			}
+		}
+	}
+
+	printf("%d trials, %lld changes, every box, radius and ray query agrees with testing every object\n", nTrials, nOperations);
+
+	return 0;
+}
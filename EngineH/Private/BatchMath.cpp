@@ -0,0 +1,350 @@
+#include "BatchMath.h"
+
+// SSE2 is always there on x64, NEON on AArch64, which also has the vector square root and divide the kernels need
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MATH_SSE 1
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define MATH_NEON 1
+#include <arm_neon.h>
+#endif
+
+void BatchMath::MultiplyMatrix(exMatrix4* pOut, const exMatrix4& a, const exMatrix4& b)
+{
+	const float* pA = a.ToFloatPtr();
+	const float* pB = b.ToFloatPtr();
+
+	// Every row of the result is the rows of b weighted by the same row of a, all of it is read before anything is written
+#if defined(MATH_SSE)
+	const __m128 b0 = _mm_loadu_ps(pB);
+	const __m128 b1 = _mm_loadu_ps(pB + 4);
+	const __m128 b2 = _mm_loadu_ps(pB + 8);
+	const __m128 b3 = _mm_loadu_ps(pB + 12);
+
+	__m128 rows[4];
+
+	for (int i = 0; i < 4; ++i)
+	{
+		const __m128 r01 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(pA[i * 4]), b0), _mm_mul_ps(_mm_set1_ps(pA[i * 4 + 1]), b1));
+		const __m128 r23 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(pA[i * 4 + 2]), b2), _mm_mul_ps(_mm_set1_ps(pA[i * 4 + 3]), b3));
+		rows[i] = _mm_add_ps(r01, r23);
+	}
+
+	float* pResult = pOut->ToFloatPtr();
+
+	for (int i = 0; i < 4; ++i)
+	{
+		_mm_storeu_ps(pResult + i * 4, rows[i]);
+	}
+#elif defined(MATH_NEON)
+	const float32x4_t b0 = vld1q_f32(pB);
+	const float32x4_t b1 = vld1q_f32(pB + 4);
+	const float32x4_t b2 = vld1q_f32(pB + 8);
+	const float32x4_t b3 = vld1q_f32(pB + 12);
+
+	float32x4_t rows[4];
+
+	for (int i = 0; i < 4; ++i)
+	{
+		float32x4_t row = vmulq_n_f32(b0, pA[i * 4]);
+		row = vfmaq_n_f32(row, b1, pA[i * 4 + 1]);
+		row = vfmaq_n_f32(row, b2, pA[i * 4 + 2]);
+		rows[i] = vfmaq_n_f32(row, b3, pA[i * 4 + 3]);
+	}
+
+	float* pResult = pOut->ToFloatPtr();
+
+	for (int i = 0; i < 4; ++i)
+	{
+		vst1q_f32(pResult + i * 4, rows[i]);
+	}
+#else
+	float result[16];
+
+	for (int i = 0; i < 4; ++i)
+	{
+		for (int j = 0; j < 4; ++j)
+		{
+			result[i * 4 + j] = pA[i * 4] * pB[j] + pA[i * 4 + 1] * pB[4 + j] + pA[i * 4 + 2] * pB[8 + j] + pA[i * 4 + 3] * pB[12 + j];
+		}
+	}
+
+	float* pResult = pOut->ToFloatPtr();
+
+	for (int i = 0; i < 16; ++i)
+	{
+		pResult[i] = result[i];
+	}
+#endif
+}
+
+exMatrix4 exMatrix4::operator* (const exMatrix4& other) const
+{
+	exMatrix4 result;
+	BatchMath::MultiplyMatrix(&result, *this, other);
+	return result;
+}
+
+void BatchMath::TransformPoints(const exMatrix4& matrix, const float* pX, const float* pY, float* pOutX, float* pOutY, int nCount)
+{
+	int i = 0;
+
+	// With z = 0 and w = 1 only the first two columns of the first, second and fourth rows matter
+#if defined(MATH_SSE)
+	const __m128 m11 = _mm_set1_ps(matrix.m11);
+	const __m128 m12 = _mm_set1_ps(matrix.m12);
+	const __m128 m21 = _mm_set1_ps(matrix.m21);
+	const __m128 m22 = _mm_set1_ps(matrix.m22);
+	const __m128 m41 = _mm_set1_ps(matrix.m41);
+	const __m128 m42 = _mm_set1_ps(matrix.m42);
+
+	for (; i + 4 <= nCount; i += 4)
+	{
+		const __m128 x = _mm_loadu_ps(pX + i);
+		const __m128 y = _mm_loadu_ps(pY + i);
+
+		_mm_storeu_ps(pOutX + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m11), _mm_mul_ps(y, m21)), m41));
+		_mm_storeu_ps(pOutY + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m12), _mm_mul_ps(y, m22)), m42));
+	}
+#elif defined(MATH_NEON)
+	const float32x4_t m41 = vdupq_n_f32(matrix.m41);
+	const float32x4_t m42 = vdupq_n_f32(matrix.m42);
+
+	for (; i + 4 <= nCount; i += 4)
+	{
+		const float32x4_t x = vld1q_f32(pX + i);
+		const float32x4_t y = vld1q_f32(pY + i);
+
+		vst1q_f32(pOutX + i, vfmaq_n_f32(vfmaq_n_f32(m41, x, matrix.m11), y, matrix.m21));
+		vst1q_f32(pOutY + i, vfmaq_n_f32(vfmaq_n_f32(m42, x, matrix.m12), y, matrix.m22));
+	}
+#endif
+
+	for (; i < nCount; ++i)
+	{
+		const float x = pX[i];
+		const float y = pY[i];
+
+		pOutX[i] = x * matrix.m11 + y * matrix.m21 + matrix.m41;
+		pOutY[i] = x * matrix.m12 + y * matrix.m22 + matrix.m42;
+	}
+}
+
+void BatchMath::NormalizeVectors(float* pX, float* pY, int nCount)
+{
+	int i = 0;
+
+	// A true square root and divide rather than the reciprocal estimates, so the results are as accurate as exVector2::Normalize
+#if defined(MATH_SSE)
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+
+	for (; i + 4 <= nCount; i += 4)
+	{
+		const __m128 x = _mm_loadu_ps(pX + i);
+		const __m128 y = _mm_loadu_ps(pY + i);
+		const __m128 squaredLength = _mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y));
+
+		// Zero lengths divide into infinities and NaNs, the mask turns them back into zeros
+		const __m128 nonZero = _mm_cmpgt_ps(squaredLength, zero);
+		const __m128 inverseLength = _mm_div_ps(one, _mm_sqrt_ps(squaredLength));
+
+		_mm_storeu_ps(pX + i, _mm_and_ps(nonZero, _mm_mul_ps(x, inverseLength)));
+		_mm_storeu_ps(pY + i, _mm_and_ps(nonZero, _mm_mul_ps(y, inverseLength)));
+	}
+#elif defined(MATH_NEON)
+	const float32x4_t zero = vdupq_n_f32(0.0f);
+
+	for (; i + 4 <= nCount; i += 4)
+	{
+		const float32x4_t x = vld1q_f32(pX + i);
+		const float32x4_t y = vld1q_f32(pY + i);
+		const float32x4_t squaredLength = vfmaq_f32(vmulq_f32(x, x), y, y);
+
+		const uint32x4_t nonZero = vcgtq_f32(squaredLength, zero);
+		const float32x4_t length = vsqrtq_f32(squaredLength);
+
+		vst1q_f32(pX + i, vreinterpretq_f32_u32(vandq_u32(nonZero, vreinterpretq_u32_f32(vdivq_f32(x, length)))));
+		vst1q_f32(pY + i, vreinterpretq_f32_u32(vandq_u32(nonZero, vreinterpretq_u32_f32(vdivq_f32(y, length)))));
+	}
+#endif
+
+	for (; i < nCount; ++i)
+	{
+		const float fSquaredLength = pX[i] * pX[i] + pY[i] * pY[i];
+
+		if (fSquaredLength > 0.0f)
+		{
+			const float fInverseLength = 1.0f / sqrtf(fSquaredLength);
+			pX[i] *= fInverseLength;
+			pY[i] *= fInverseLength;
+		}
+		else
+		{
+			pX[i] = 0.0f;
+			pY[i] = 0.0f;
+		}
+	}
+}
+
+void BatchMath::ComputeBounds(const float* pX, const float* pY, int nCount, exVector2& v2Min, exVector2& v2Max)
+{
+	float fMinX = pX[0];
+	float fMinY = pY[0];
+	float fMaxX = pX[0];
+	float fMaxY = pY[0];
+
+	int i = 0;
+
+#if defined(MATH_SSE)
+	if (nCount >= 4)
+	{
+		__m128 minX = _mm_loadu_ps(pX);
+		__m128 minY = _mm_loadu_ps(pY);
+		__m128 maxX = minX;
+		__m128 maxY = minY;
+
+		for (i = 4; i + 4 <= nCount; i += 4)
+		{
+			const __m128 x = _mm_loadu_ps(pX + i);
+			const __m128 y = _mm_loadu_ps(pY + i);
+
+			minX = _mm_min_ps(minX, x);
+			minY = _mm_min_ps(minY, y);
+			maxX = _mm_max_ps(maxX, x);
+			maxY = _mm_max_ps(maxY, y);
+		}
+
+		// Folding the four lanes into one, twice swapping halves
+		minX = _mm_min_ps(minX, _mm_shuffle_ps(minX, minX, _MM_SHUFFLE(2, 3, 0, 1)));
+		minY = _mm_min_ps(minY, _mm_shuffle_ps(minY, minY, _MM_SHUFFLE(2, 3, 0, 1)));
+		maxX = _mm_max_ps(maxX, _mm_shuffle_ps(maxX, maxX, _MM_SHUFFLE(2, 3, 0, 1)));
+		maxY = _mm_max_ps(maxY, _mm_shuffle_ps(maxY, maxY, _MM_SHUFFLE(2, 3, 0, 1)));
+		minX = _mm_min_ps(minX, _mm_shuffle_ps(minX, minX, _MM_SHUFFLE(1, 0, 3, 2)));
+		minY = _mm_min_ps(minY, _mm_shuffle_ps(minY, minY, _MM_SHUFFLE(1, 0, 3, 2)));
+		maxX = _mm_max_ps(maxX, _mm_shuffle_ps(maxX, maxX, _MM_SHUFFLE(1, 0, 3, 2)));
+		maxY = _mm_max_ps(maxY, _mm_shuffle_ps(maxY, maxY, _MM_SHUFFLE(1, 0, 3, 2)));
+
+		fMinX = _mm_cvtss_f32(minX);
+		fMinY = _mm_cvtss_f32(minY);
+		fMaxX = _mm_cvtss_f32(maxX);
+		fMaxY = _mm_cvtss_f32(maxY);
+	}
+#elif defined(MATH_NEON)
+	if (nCount >= 4)
+	{
+		float32x4_t minX = vld1q_f32(pX);
+		float32x4_t minY = vld1q_f32(pY);
+		float32x4_t maxX = minX;
+		float32x4_t maxY = minY;
+
+		for (i = 4; i + 4 <= nCount; i += 4)
+		{
+			const float32x4_t x = vld1q_f32(pX + i);
+			const float32x4_t y = vld1q_f32(pY + i);
+
+			minX = vminq_f32(minX, x);
+			minY = vminq_f32(minY, y);
+			maxX = vmaxq_f32(maxX, x);
+			maxY = vmaxq_f32(maxY, y);
+		}
+
+		fMinX = vminvq_f32(minX);
+		fMinY = vminvq_f32(minY);
+		fMaxX = vmaxvq_f32(maxX);
+		fMaxY = vmaxvq_f32(maxY);
+	}
+#endif
+
+	for (; i < nCount; ++i)
+	{
+		fMinX = (pX[i] < fMinX) ? pX[i] : fMinX;
+		fMinY = (pY[i] < fMinY) ? pY[i] : fMinY;
+		fMaxX = (pX[i] > fMaxX) ? pX[i] : fMaxX;
+		fMaxY = (pY[i] > fMaxY) ? pY[i] : fMaxY;
+	}
+
+	v2Min = exVector2(fMinX, fMinY);
+	v2Max = exVector2(fMaxX, fMaxY);
+}
+
+int BatchMath::FindOverlappingBounds(const float* pMinX, const float* pMinY, const float* pMaxX, const float* pMaxY, int nCount,
+	const exVector2& v2RectMin, const exVector2& v2RectMax, uint32_t* pIndices)
+{
+	int nFound = 0;
+	int i = 0;
+
+	// Every lane's index is written and the count only moves past the ones that overlap, so there is no branch per box
+#if defined(MATH_SSE)
+	const __m128 rectMinX = _mm_set1_ps(v2RectMin.x);
+	const __m128 rectMinY = _mm_set1_ps(v2RectMin.y);
+	const __m128 rectMaxX = _mm_set1_ps(v2RectMax.x);
+	const __m128 rectMaxY = _mm_set1_ps(v2RectMax.y);
+
+	for (; i + 4 <= nCount; i += 4)
+	{
+		const __m128 overlapX = _mm_and_ps(_mm_cmpge_ps(_mm_loadu_ps(pMaxX + i), rectMinX), _mm_cmple_ps(_mm_loadu_ps(pMinX + i), rectMaxX));
+		const __m128 overlapY = _mm_and_ps(_mm_cmpge_ps(_mm_loadu_ps(pMaxY + i), rectMinY), _mm_cmple_ps(_mm_loadu_ps(pMinY + i), rectMaxY));
+		const int nMask = _mm_movemask_ps(_mm_and_ps(overlapX, overlapY));
+
+		// Nothing to write for the common case of a whole group off screen
+		if (nMask == 0)
+		{
+			continue;
+		}
+
+		for (int nLane = 0; nLane < 4; ++nLane)
+		{
+			pIndices[nFound] = (uint32_t)(i + nLane);
+			nFound += (nMask >> nLane) & 1;
+		}
+	}
+#elif defined(MATH_NEON)
+	const float32x4_t rectMinX = vdupq_n_f32(v2RectMin.x);
+	const float32x4_t rectMinY = vdupq_n_f32(v2RectMin.y);
+	const float32x4_t rectMaxX = vdupq_n_f32(v2RectMax.x);
+	const float32x4_t rectMaxY = vdupq_n_f32(v2RectMax.y);
+
+	for (; i + 4 <= nCount; i += 4)
+	{
+		const uint32x4_t overlapX = vandq_u32(vcgeq_f32(vld1q_f32(pMaxX + i), rectMinX), vcleq_f32(vld1q_f32(pMinX + i), rectMaxX));
+		const uint32x4_t overlapY = vandq_u32(vcgeq_f32(vld1q_f32(pMaxY + i), rectMinY), vcleq_f32(vld1q_f32(pMinY + i), rectMaxY));
+		const uint32x4_t overlap = vandq_u32(overlapX, overlapY);
+
+		if (vmaxvq_u32(overlap) == 0)
+		{
+			continue;
+		}
+
+		uint32_t lanes[4];
+		vst1q_u32(lanes, vshrq_n_u32(overlap, 31));
+
+		for (int nLane = 0; nLane < 4; ++nLane)
+		{
+			pIndices[nFound] = (uint32_t)(i + nLane);
+			nFound += (int)lanes[nLane];
+		}
+	}
+#endif
+
+	for (; i < nCount; ++i)
+	{
+		const bool bOverlap = pMaxX[i] >= v2RectMin.x && pMinX[i] <= v2RectMax.x && pMaxY[i] >= v2RectMin.y && pMinY[i] <= v2RectMax.y;
+
+		pIndices[nFound] = (uint32_t)i;
+		nFound += bOverlap ? 1 : 0;
+	}
+
+	return nFound;
+}
+
+const char* BatchMath::GetInstructionSet()
+{
+#if defined(MATH_SSE)
+	return "SSE2";
+#elif defined(MATH_NEON)
+	return "NEON";
+#else
+	return "scalar";
+#endif
+}
@@ -0,0 +1,100 @@
+#include "CommandRecorder.h"
+#include <atomic>
+
+// The recorder a thread last drew through, and its buffer there
+struct CommandRecorderCache
+{
+	uint64_t mRecorderID;
+	RenderCommandBuffer* mBuffer;
+};
+
+static thread_local CommandRecorderCache tRecorderCache = { 0, nullptr };
+
+static std::atomic<uint64_t> gNextRecorderID(1);
+
+CommandRecorder::CommandRecorder()
+{
+	mID = gNextRecorderID++;
+}
+
+CommandRecorder::~CommandRecorder()
+{
+
+}
+
+RenderCommandBuffer& CommandRecorder::GetThreadBuffer()
+{
+	if (tRecorderCache.mRecorderID == mID)
+	{
+		return *tRecorderCache.mBuffer;
+	}
+
+	return RegisterThread();
+}
+
+RenderCommandBuffer& CommandRecorder::RegisterThread()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	const std::thread::id thread = std::this_thread::get_id();
+	RenderCommandBuffer* pBuffer = nullptr;
+
+	// The thread may have drawn through another recorder since it last drew through this one
+	for (ThreadBuffer& threadBuffer : mThreadBuffers)
+	{
+		if (threadBuffer.mThread == thread)
+		{
+			pBuffer = threadBuffer.mBuffer.get();
+			break;
+		}
+	}
+
+	if (pBuffer == nullptr)
+	{
+		ThreadBuffer threadBuffer;
+		threadBuffer.mThread = thread;
+		threadBuffer.mBuffer.reset(new RenderCommandBuffer());
+
+		pBuffer = threadBuffer.mBuffer.get();
+		mThreadBuffers.push_back(std::move(threadBuffer));
+	}
+
+	tRecorderCache.mRecorderID = mID;
+	tRecorderCache.mBuffer = pBuffer;
+
+	return *pBuffer;
+}
+
+void CommandRecorder::MergeInto(RenderCommandBuffer& target)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	for (ThreadBuffer& threadBuffer : mThreadBuffers)
+	{
+		RenderCommandBuffer& buffer = *threadBuffer.mBuffer;
+
+		if (buffer.GetCommandCount() == 0)
+		{
+			continue;
+		}
+
+		// Usually a single thread drew everything, taking its commands as they are instead of copying them
+		if (target.GetCommandCount() == 0)
+		{
+			target.Swap(buffer);
+		}
+		else
+		{
+			target.Append(buffer);
+		}
+
+		buffer.Clear();
+	}
+}
+
+int CommandRecorder::GetThreadCount() const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	return (int)mThreadBuffers.size();
+}
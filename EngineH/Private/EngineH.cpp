@@ -1,21 +1,80 @@
 #include "EngineH.h"
 #include "SDL.h"
 #include "GLEW.h"
-#include "Output.h"
+#include "Logger.h"
+#include "Profiler.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+// Bytes of instance data each frame in flight can stream before the stream has to grow, enough for ~170k shapes
+const size_t kInstanceStreamRegionSize = 4 * 1024 * 1024;
+
+// Bytes of tessellated line vertices each frame in flight can stream before the stream has to grow
+const size_t kVertexStreamRegionSize = 1024 * 1024;
+
+// The viewport never changes size, so neither does the projection
+constexpr exMatrix4 kProjection = exMatrix4::exOrthographicProjectionMatrix((float)kViewportWidth, (float)kViewportHeight, -100.0f, 100.0f);
 
 GraphicsContext EngineH::gc;
 
+// The pass a draw of the program is timed under
+static GPU_PASS GetGpuPass(SHADER_PROGRAM eProgram)
+{
+	switch (eProgram)
+	{
+	case SHADER_PROGRAM::BOX:
+		return GPU_PASS::BOX;
+	case SHADER_PROGRAM::CIRCLE:
+		return GPU_PASS::CIRCLE;
+	case SHADER_PROGRAM::LINE:
+		return GPU_PASS::LINE;
+	default:
+		return GPU_PASS::TEXT;
+	}
+}
+
 EngineH::EngineH()
 {
 
 	mWindow = nullptr;
 	mGLContext = nullptr;
 	mGame = nullptr;
+
+	// The default camera shows the viewport exactly as it is laid out in world space
+	mCameraPosition = exVector2(kViewportWidth / 2.0f, kViewportHeight / 2.0f);
+	mCameraZoom = 1.0f;
+
+	mLineWidth = 1.0f;
+
+	// Started right away, games can use it as soon as they are initialized
+	mJobSystem.Initialize();
+
+	mFramePacing = FRAME_PACING::VSYNC;
+	mTargetFrameRate = 60.0f;
+
+	mRecordingFrame = 0;
+	mSubmittedFrames = 0;
+	mDrawnFrames = 0;
+	mRenderThreadEnabled = true;
+	mRenderThreadRunning = false;
+	mRenderThreadFailed = false;
+	mRenderThreadShutdown = false;
+	mFramesInFlight = 1;
+	mSwapIntervalDirty = false;
+
+	mFrameDeltaT = 0.0f;
+	mSubmitTime = 0.0f;
+	mFontCount = 0;
+
+	mFrameCount = 0;
+	mOnFrameTime = 0.0f;
 }
 
 EngineH::~EngineH()
 {
-
+	StopRenderThread();
 }
 
 int EngineH::Initialize()
@@ -32,7 +91,7 @@ int EngineH::Initialize()
 
 	//exAssert(mWindow != nullptr);
 
-	SDL_GLContext glcontext = SDL_GL_CreateContext(mWindow);
+	mGLContext = SDL_GL_CreateContext(mWindow);
 
 	glewExperimental = GL_TRUE;
 	GLenum res = glewInit();
@@ -46,14 +105,19 @@ int EngineH::Initialize()
 		//exAssert(false);
 	}
 
-	// this makes our buffer swap synchronized with the monitor's vertical refresh
-	SDL_GL_SetSwapInterval(1);
+	if (!gc.mGpuTimer.Initialize())
+	{
+		LOG_WARNING("No timer queries on this context, GPU timings are off\n");
+	}
+
+	mFrameScheduler.Initialize(&SDL_GetPerformanceCounter, SDL_GetPerformanceFrequency());
+	ApplyFramePacing();
 
 	return 0;
 }
 
-
-const float MS2SEC = (1/1000.0f);
+// Seconds between the frame timings written to the console
+const float kFrameTimingReportInterval = 5.0f;
 
 void EngineH::Run(exGameInterface* pGame)
 {
@@ -63,51 +127,338 @@ void EngineH::Run(exGameInterface* pGame)
 	Initialize();
 	InitializeShaders();
 
-	const float fRateRequired = (1 / 60.0f);			// 60 FPS
+	for (int nSlot = 0; nSlot < kMaxFramesInFlight + 1; ++nSlot)
+	{
+		BuildFrameGraph(nSlot);
+	}
+
+	if (mRenderThreadEnabled && !StartRenderThread())
+	{
+		LOG_WARNING("Could not hand the GL context to a render thread, rendering on the game thread\n");
+	}
+
+	float fTimeSinceReport = 0.0f;
 
-	unsigned int uLastTicks = SDL_GetTicks();
+	Profiler::SetThreadName("Main");
 
 	while (1)
 	{
-		unsigned int uNowTicks = SDL_GetTicks();
-		unsigned int uFrameTicks = uNowTicks - uLastTicks;
+		PROFILE_SCOPE("Frame");
+
+		// The first frame has nothing to measure against and gets no time at all
+		const float fDeltaT = mFrameScheduler.BeginFrame();
+
+		OnFrame(fDeltaT);
 
-		float fDeltaT = uFrameTicks * MS2SEC;
+		// Waits out the rest of the frame with a fixed cap, vsync waits in the buffer swap instead
+		mFrameScheduler.EndFrame();
 
-		if (fDeltaT < fRateRequired)
+		fTimeSinceReport += fDeltaT;
+
+		if (fTimeSinceReport >= kFrameTimingReportInterval)
 		{
-			// maybe sleep?
+			const FrameTimings timings = mFrameScheduler.GetTimings();
+			LOG_INFO("Frame time %.2f ms (min %.2f, max %.2f, jitter %.3f) over %d frames\n",
+				timings.mAverage, timings.mMin, timings.mMax, timings.mJitter, timings.mFrameCount);
 
-			continue;
-		}
+			char szReport[128];
+			std::string stages("Stages");
 
-		OnFrame(fDeltaT);
+			for (const StageTiming& timing : GetStageTimings())
+			{
+				snprintf(szReport, sizeof(szReport), " %s %.3f ms", timing.mName, timing.mMilliseconds);
+				stages += szReport;
+			}
+
+			LOG_INFO("%s\n", stages);
+
+			const GpuTimings gpuTimings = GetGpuTimings();
 
-		uLastTicks = uNowTicks;
+			if (gpuTimings.mSupported)
+			{
+				std::string passes("Passes (CPU/GPU)");
+
+				for (int nPass = 0; nPass < (int)GPU_PASS::COUNT; ++nPass)
+				{
+					snprintf(szReport, sizeof(szReport), " %s %.3f/%.3f ms", GpuTimer::GetPassName((GPU_PASS)nPass),
+						gpuTimings.mPasses[nPass].mCpuMilliseconds, gpuTimings.mPasses[nPass].mGpuMilliseconds);
+					passes += szReport;
+				}
+
+				// The swap blocks on vsync on the CPU and waits for the display on the GPU, so only the draws say where the frame is bound
+				const GpuPassTiming& swap = gpuTimings.mPasses[(int)GPU_PASS::SWAP];
+				const float fCpuDraw = gpuTimings.mCpuMilliseconds - swap.mCpuMilliseconds;
+				const float fGpuDraw = gpuTimings.mGpuMilliseconds - swap.mGpuMilliseconds;
+
+				LOG_INFO("%s, %d batches, %s bound\n", passes, (int)gpuTimings.mBatches.size(), (fGpuDraw > fCpuDraw) ? "GPU" : "CPU");
+			}
+
+			fTimeSinceReport = 0.0f;
+		}
 	}
 }
 
 void EngineH::OnFrame(float fDeltaT)
 {
-	ConsumeEvents();
+	PROFILE_FUNCTION();
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	mFrameDeltaT = fDeltaT;
+
+	// Events, the game and merging its draws run here, cull and sort carry on as jobs while the next frame starts
+	mFrameGraphs[mRecordingFrame].Execute(mJobSystem);
+
+	// Everything the game drew has only been recorded so far, submitting it all at once
+	if (mRenderThreadRunning)
+	{
+		SubmitFrame();
+	}
+	else
+	{
+		mFrameGraphs[mRecordingFrame].Wait(mJobSystem);
+		DrawFrame(gc.mFrames[mRecordingFrame]);
+	}
+
+	mOnFrameTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+	++mFrameCount;
+
+	if (mStatsWriter.IsOpen())
+	{
+		mStatsWriter.Write(GetRenderStats());
+	}
+}
+
+void EngineH::BuildFrameGraph(int nSlot)
+{
+	FrameGraph& graph = mFrameGraphs[nSlot];
+	RenderFrame& frame = gc.mFrames[nSlot];
+
+	// The game and the engine's recorders are there once, every slot has its own frame
+	const int nGame = graph.AddResource("game", true);
+	const int nRecorders = graph.AddResource("command recorders", true);
+	const int nFrame = graph.AddResource("frame", false);
+	const int nBatch = graph.AddResource("frame batch", false);
+
+	// SDL only hands out events on the thread that created the window
+	const int nEvents = graph.AddStage("Events", STAGE_THREAD::MAIN, [this]()
+	{
+		ConsumeEvents();
+	});
+
+	const int nUpdate = graph.AddStage("Update", STAGE_THREAD::MAIN, [this, &frame]()
+	{
+		// Getting clear color from the game, the frame is cleared to it when it is drawn
+		mGame->GetClearColor(frame.mClearColor);
+
+		// Running the game, once or at its fixed step, and letting it draw
+		mFixedTimestep.RunFrame(mGame, mFrameDeltaT);
+
+		// The camera the frame is drawn with is wherever the game left it
+		frame.mCameraPosition = mCameraPosition;
+		frame.mCameraZoom = mCameraZoom;
+	});
+
+	// Gathering what every thread drew into the frame, before the next frame's update draws into the recorders again
+	const int nMerge = graph.AddStage("Merge", STAGE_THREAD::MAIN, [this, &frame]()
+	{
+		mCommandRecorder.MergeInto(frame.mCommandBuffer);
+	});
+
+	const int nCull = graph.AddStage("Cull", STAGE_THREAD::ANY, [&frame]()
+	{
+		frame.mCulledCommands = frame.mCommandBuffer.CullToView(frame.mCameraPosition, frame.mCameraZoom);
+	});
+
+	const int nSort = graph.AddStage("Sort", STAGE_THREAD::ANY, [this, &frame]()
+	{
+		// The game thread may be loading a font into the atlas right now, which is why the fonts aren't a graph resource
+		std::lock_guard<std::mutex> lock(mFontMutex);
+
+		// Sorting and batching everything that was recorded, the same way every engine does
+		frame.mFrameBatcher.Build(frame.mCommandBuffer, gc.mFonts, gc.mGlyphAtlas.GetPageCount(), frame.mCameraZoom);
+	});
+
+	graph.AddDependency(nUpdate, nEvents);
+	graph.AddDependency(nMerge, nUpdate);
+	graph.AddDependency(nCull, nMerge);
+	graph.AddDependency(nSort, nCull);
+
+	graph.AddAccess(nEvents, nGame, RESOURCE_ACCESS::WRITE);
+	graph.AddAccess(nUpdate, nGame, RESOURCE_ACCESS::WRITE);
+	graph.AddAccess(nUpdate, nRecorders, RESOURCE_ACCESS::WRITE);
+	graph.AddAccess(nUpdate, nFrame, RESOURCE_ACCESS::WRITE);
+	graph.AddAccess(nMerge, nRecorders, RESOURCE_ACCESS::WRITE);
+	graph.AddAccess(nMerge, nFrame, RESOURCE_ACCESS::WRITE);
+	graph.AddAccess(nCull, nFrame, RESOURCE_ACCESS::WRITE);
+	graph.AddAccess(nSort, nFrame, RESOURCE_ACCESS::WRITE);
+	graph.AddAccess(nSort, nBatch, RESOURCE_ACCESS::WRITE);
+
+	graph.Validate();
+}
+
+void EngineH::DrawFrame(RenderFrame& frame)
+{
+	PROFILE_FUNCTION();
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	// The flush clears the frame's commands, so they are counted first
+	mDrawStats = RenderStats();
+	mDrawStats.mCommands = frame.mCommandBuffer.GetCommandCount();
+	mDrawStats.mCulledCommands = frame.mCulledCommands;
 
-	// Getting clear color from the game and clearing all existing renders
-	exColor clearColor;
-	mGame->GetClearColor(clearColor);
-	
 	// Normalizing Colors
 	exColorF clearColorF;
-	exColorF::ToColorF(clearColor, clearColorF);
+	exColorF::ToColorF(frame.mClearColor, clearColorF);
 
 	glClearColor(clearColorF.mColor[0], clearColorF.mColor[1], clearColorF.mColor[2], 1.0f);
+	gc.mGpuTimer.BeginFrame();
+
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	gc.mGpuTimer.Mark(GPU_PASS::CLEAR);
+
+	FlushBatches(frame);
+	gc.mInstanceStream.EndFrame();
+	gc.mVertexStream.EndFrame();
+	gc.mStateCache.EndFrame();
 
-	// Running the game
-	mGame->Run(fDeltaT);
+	{
+		PROFILE_SCOPE("SwapWindow");
+		SDL_GL_SwapWindow(mWindow);
+	}
+
+	gc.mGpuTimer.Mark(GPU_PASS::SWAP);
+	gc.mGpuTimer.EndFrame();
 
-	SDL_GL_SwapWindow(mWindow);
+	mDrawStats.mUploadedBytes += GetStreamedBytesLastFrame();
+	mDrawStats.mProgramBinds = gc.mStateCache.GetProgramBindsLastFrame();
+	mDrawStats.mVertexArrayBinds = gc.mStateCache.GetVertexArrayBindsLastFrame();
+	mDrawStats.mStateChanges = gc.mStateCache.GetStateChangesLastFrame();
+	mDrawStats.mElidedStateChanges = gc.mStateCache.GetElidedStateChangesLastFrame();
+
+	{
+		std::lock_guard<std::mutex> lock(mStatsMutex);
+		mDrawnStats = mDrawStats;
+	}
+
+	mSubmitTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
 }
 
+void EngineH::SubmitFrame()
+{
+	PROFILE_FUNCTION();
+
+	std::unique_lock<std::mutex> lock(mRenderMutex);
+
+	++mSubmittedFrames;
+	mFrameSubmitted.notify_one();
+
+	// The next frame's slot is free once the render thread is at most mFramesInFlight frames behind, the one it is drawing included
+	mFrameDrawn.wait(lock, [this] { return mSubmittedFrames - mDrawnFrames <= (uint64_t)mFramesInFlight; });
+
+	mRecordingFrame = (int)(mSubmittedFrames % (mFramesInFlight + 1));
+}
+
+bool EngineH::StartRenderThread()
+{
+	// A context can only be current on one thread at a time
+	SDL_GL_MakeCurrent(mWindow, nullptr);
+
+	mRenderThreadShutdown = false;
+	mRenderThreadFailed = false;
+	mRenderThread = std::thread(&EngineH::RenderThreadLoop, this);
+
+	std::unique_lock<std::mutex> lock(mRenderMutex);
+	mFrameDrawn.wait(lock, [this] { return mRenderThreadRunning || mRenderThreadFailed; });
+
+	if (mRenderThreadFailed)
+	{
+		lock.unlock();
+		mRenderThread.join();
+
+		SDL_GL_MakeCurrent(mWindow, mGLContext);
+		return false;
+	}
+
+	return true;
+}
+
+void EngineH::StopRenderThread()
+{
+	if (!mRenderThread.joinable())
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mRenderMutex);
+		mRenderThreadShutdown = true;
+		mFrameSubmitted.notify_one();
+	}
+
+	mRenderThread.join();
+	mRenderThreadRunning = false;
+
+	SDL_GL_MakeCurrent(mWindow, mGLContext);
+}
+
+void EngineH::RenderThreadLoop()
+{
+	Profiler::SetThreadName("Render");
+
+	const bool bHasContext = (SDL_GL_MakeCurrent(mWindow, mGLContext) == 0);
+
+	{
+		std::lock_guard<std::mutex> lock(mRenderMutex);
+		mRenderThreadRunning = bHasContext;
+		mRenderThreadFailed = !bHasContext;
+		mFrameDrawn.notify_all();
+	}
+
+	if (!bHasContext)
+	{
+		return;
+	}
+
+	while (true)
+	{
+		std::unique_lock<std::mutex> lock(mRenderMutex);
+		mFrameSubmitted.wait(lock, [this] { return mDrawnFrames < mSubmittedFrames || mRenderThreadShutdown; });
+
+		if (mRenderThreadShutdown)
+		{
+			break;
+		}
+
+		RenderFrame& frame = gc.mFrames[mDrawnFrames % (mFramesInFlight + 1)];
+		lock.unlock();
+
+		if (mSwapIntervalDirty.exchange(false))
+		{
+			ApplySwapInterval();
+		}
+
+		// The frame's cull and sort may still be running as jobs, left to the workers so the game's jobs never hold up drawing
+		{
+			PROFILE_SCOPE("WaitForFrameGraph");
+			mFrameGraphs[mDrawnFrames % (mFramesInFlight + 1)].WaitWithoutRunning(mJobSystem);
+		}
+
+		DrawFrame(frame);
+
+		lock.lock();
+		++mDrawnFrames;
+		mFrameDrawn.notify_one();
+	}
+
+	SDL_GL_MakeCurrent(mWindow, nullptr);
+}
+
+// The key writing the profiler's trace, and where to
+const SDL_Keycode kProfilerHotkey = SDLK_F9;
+const char* const kProfilerTraceFile = "EngineH.trace.json";
+
 void EngineH::ConsumeEvents()
 {
 	SDL_PumpEvents();
@@ -118,9 +469,19 @@ void EngineH::ConsumeEvents()
 	{
 		if (event.type == SDL_QUIT)
 		{
+			// The render thread and the jobs would still be drawing from the context and the frames while exit tears them down
+			StopRenderThread();
+			mJobSystem.Shutdown();
 			exit(0);
 		}
 
+		// Writing out what the profiler recorded, the game still gets the key
+		if (event.type == SDL_KEYDOWN && event.key.keysym.sym == kProfilerHotkey && event.key.repeat == 0)
+		{
+			const bool bWritten = Profiler::WriteChromeTrace(kProfilerTraceFile);
+			LOG_INFO("%s %s\n", bWritten ? "Wrote" : "Could not write", kProfilerTraceFile);
+		}
+
 		mGame->OnEvent(&event);
 	}
 
@@ -131,44 +492,62 @@ void EngineH::InitializeShaders()
 {
 	InitializeSquareShaders();
 	InitializeCircleShaders();
+	InitializeLineShaders();
+	InitializeTextShaders();
+	InitializeBatchBuffers();
+	InitializeCamera();
+
+	// Printing the first error detected in the OpenGL code
+	const GLenum eError = glGetError();
 
-	// Printing the number of errors detected in the OpenGL code
-	Console::LogOpenGL(glGetError());
+	if (eError != GL_NO_ERROR)
+	{
+		LOG_SEVERE("OpenGL Error Code - %u\n", eError);
+	}
 }
 
 void EngineH::InitializeSquareShaders()
 {
 	// Testing Depth
-	glEnable(GL_DEPTH_TEST);
+	gc.mStateCache.SetCapability(GL_DEPTH_TEST, true);
 
+	// Every box is an instance of the unit quad, scaled to its half extents and moved to its center and layer
 	const GLchar *vert_shader =
 		"#version 330\n"
 		"layout(location = 0) in vec2 point;\n"
-		"uniform mat4 model, view, proj;\n"
+		"layout(location = 1) in vec2 center;\n"
+		"layout(location = 2) in vec2 extents;\n"
+		"layout(location = 3) in vec4 in_color;\n"
+		"layout(location = 4) in float layer;\n"
+		"layout(std140) uniform Camera { mat4 view; mat4 proj; };\n"
+		"out vec4 BoxColor;\n"
 		"void main() {\n"
-		"    gl_Position = proj * view * model * vec4(point, 0.0, 1.0);\n"
+		"    gl_Position = proj * view * vec4(center + point * extents, layer, 1.0);\n"
+		"    BoxColor = in_color;\n"
 		"}\n";
 	const GLchar *frag_shader =
 		"#version 330\n"
 		"layout(location = 0) out vec4 color;\n"
-		"uniform vec3 in_color;\n"
+		"in vec4 BoxColor;\n"
 		"void main() {\n"
-		"    color = vec4(in_color, 1.0);\n"
+		"    color = vec4(BoxColor.rgb, 1.0);\n"
 		"}\n";
 
-	// Compile and link OpenGL program
-	GLuint vert = CompileShader(GL_VERTEX_SHADER, vert_shader);
-	GLuint frag = CompileShader(GL_FRAGMENT_SHADER, frag_shader);
+	// Storing the compiled shader of the box in the graphics context
+	CreateShaderProgram(SHADER_PROGRAM::BOX, vert_shader, frag_shader);
 
-	// Storing the compiled shader of the circle in the graphics context
-	gc.mBoxShaderProgram = LinkProgram(vert, frag);
-	// Generating 1 Buffer and storing it's context
-	glGenBuffers(1, &gc.mVBOPoint);
-	// Generating 1 Vertex Array and storing it's context
-	glGenVertexArrays(1, &gc.mVAOPoint);
+	// The unit quad every box and circle is an instance of, its corners double as the circle's texture coordinates
+	const float UNIT_QUAD[8] = {
+		-1.0f,  1.0f,
+		-1.0f, -1.0f,
+		 1.0f,  1.0f,
+		 1.0f, -1.0f
+	};
 
-	glDeleteShader(frag);
-	glDeleteShader(vert);
+	// Generating 1 Buffer and storing it's context, it never changes after this
+	glGenBuffers(1, &gc.mVBOUnitQuad);
+	gc.mStateCache.BindBuffer(GL_ARRAY_BUFFER, gc.mVBOUnitQuad);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(UNIT_QUAD), UNIT_QUAD, GL_STATIC_DRAW);
 }
 
 void EngineH::InitializeCircleShaders()
@@ -176,44 +555,377 @@ void EngineH::InitializeCircleShaders()
 	// For drawing a circle we are first drawing a square and then removing all pixels outside the distance(radius) from the center
 
 	// Testing Depth
-	glEnable(GL_DEPTH_TEST);
+	gc.mStateCache.SetCapability(GL_DEPTH_TEST, true);
 
+	// Drawn from the same unit quad as the boxes, which is created along with the square shaders
 	const GLchar *vert_shader =
 		"#version 330\n"
 		"layout(location = 0) in vec2 point;\n"
-		"layout(location = 1) in vec2 tex;\n"
-		"uniform mat4 model, view, proj;\n"
-		"out vec2 CircleTexCoords;"
+		"layout(location = 1) in vec2 center;\n"
+		"layout(location = 2) in vec2 extents;\n"
+		"layout(location = 3) in vec4 in_color;\n"
+		"layout(location = 4) in float layer;\n"
+		"layout(std140) uniform Camera { mat4 view; mat4 proj; };\n"
+		"out vec2 CircleTexCoords;\n"
+		"out vec4 CircleColor;\n"
 		"void main() {\n"
-		"     gl_Position = proj * view * model * vec4(point, 0.0, 1.0);\n"
-		"     CircleTexCoords = tex;"
+		"     gl_Position = proj * view * vec4(center + point * extents, layer, 1.0);\n"
+		"     CircleTexCoords = point;\n"
+		"     CircleColor = in_color;\n"
 		"}\n";
 	const GLchar *frag_shader =
 		"#version 330\n"
 		"layout(location = 0) out vec4 color;\n"
-		"uniform vec3 in_color;\n"
 		"in vec2 CircleTexCoords;\n"
+		"in vec4 CircleColor;\n"
 		"void main() {\n"
 		"	float d = distance(CircleTexCoords, vec2(0.0, 0.0));\n"
 		"	if (d > 1.0)\n"
 		"	{\n"
 		"		discard;\n"
 		"	}\n"
-		"	color = vec4(in_color, 1.0);\n"
+		"	color = vec4(CircleColor.rgb, 1.0);\n"
 		"}\n";
 
+	// Storing the compiled shader of the circle in the graphics context
+	CreateShaderProgram(SHADER_PROGRAM::CIRCLE, vert_shader, frag_shader);
+}
+
+void EngineH::InitializeLineShaders()
+{
+	// Lines and outlines are tessellated into triangles on the CPU, so the shader only has to place and color them
+
+	// Testing Depth
+	gc.mStateCache.SetCapability(GL_DEPTH_TEST, true);
+
+	// Later draws on the same layer have to win, or outlines would be hidden by the fills they are drawn on
+	glDepthFunc(GL_LEQUAL);
+
+	const GLchar *vert_shader =
+		"#version 330\n"
+		"layout(location = 0) in vec3 point;\n"
+		"layout(location = 1) in vec4 in_color;\n"
+		"layout(std140) uniform Camera { mat4 view; mat4 proj; };\n"
+		"out vec4 LineColor;\n"
+		"void main() {\n"
+		"    gl_Position = proj * view * vec4(point, 1.0);\n"
+		"    LineColor = in_color;\n"
+		"}\n";
+	const GLchar *frag_shader =
+		"#version 330\n"
+		"layout(location = 0) out vec4 color;\n"
+		"in vec4 LineColor;\n"
+		"void main() {\n"
+		"    color = vec4(LineColor.rgb, 1.0);\n"
+		"}\n";
+
+	// Storing the compiled shader of the lines in the graphics context
+	CreateShaderProgram(SHADER_PROGRAM::LINE, vert_shader, frag_shader);
+}
+
+void EngineH::InitializeTextShaders()
+{
+	// Text is made of quads cut out of the glyph atlas, whose single channel is how much of each pixel the glyph covers
+
+	// Testing Depth
+	gc.mStateCache.SetCapability(GL_DEPTH_TEST, true);
+
+	// The coverage becomes the alpha, only the text ranges turn blending on
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	const GLchar *vert_shader =
+		"#version 330\n"
+		"layout(location = 0) in vec3 point;\n"
+		"layout(location = 1) in vec4 in_color;\n"
+		"layout(location = 2) in vec2 in_texcoords;\n"
+		"layout(std140) uniform Camera { mat4 view; mat4 proj; };\n"
+		"out vec4 TextColor;\n"
+		"out vec2 TextTexCoords;\n"
+		"void main() {\n"
+		"    gl_Position = proj * view * vec4(point, 1.0);\n"
+		"    TextColor = in_color;\n"
+		"    TextTexCoords = in_texcoords;\n"
+		"}\n";
+	const GLchar *frag_shader =
+		"#version 330\n"
+		"layout(location = 0) out vec4 color;\n"
+		"uniform sampler2D atlas;\n"
+		"in vec4 TextColor;\n"
+		"in vec2 TextTexCoords;\n"
+		"void main() {\n"
+		"	float coverage = texture(atlas, TextTexCoords).r;\n"
+		"	if (coverage == 0.0)\n"
+		"	{\n"
+		"		discard;\n"
+		"	}\n"
+		"	color = vec4(TextColor.rgb, TextColor.a * coverage);\n"
+		"}\n";
+
+	// Storing the compiled shader of the text in the graphics context
+	CreateShaderProgram(SHADER_PROGRAM::TEXT, vert_shader, frag_shader);
+
+	// The atlas page of each range is always bound to the first texture unit
+	const ShaderProgram& program = gc.mShaderPrograms[(int)SHADER_PROGRAM::TEXT];
+	gc.mStateCache.UseProgram(program.GetHandle());
+	program.SetUniform(program.GetUniform<int>("atlas"), 0);
+}
+
+void EngineH::InitializeBatchBuffers()
+{
+	// Both shaders read the same unit quad and instance layout, so a single vertex array is enough for every batch
+	gc.mInstanceStream.Initialize(gc.mStateCache, GL_ARRAY_BUFFER, kInstanceStreamRegionSize);
+
+	// Generating 1 Vertex Array and storing it's context
+	glGenVertexArrays(1, &gc.mVAOBatch);
+	gc.mStateCache.BindVertexArray(gc.mVAOBatch);
+
+	// The quad's corners advance per vertex
+	gc.mStateCache.BindBuffer(GL_ARRAY_BUFFER, gc.mVBOUnitQuad);
+	glVertexAttribPointer(ATTRIB_POINT_1, 2, GL_FLOAT, GL_FALSE, 0, 0);
+	glEnableVertexAttribArray(ATTRIB_POINT_1);
+
+	// Everything else advances per instance, the pointers themselves are set at draw time since every frame streams into a different part of the buffer
+	glEnableVertexAttribArray(ATTRIB_INSTANCE_CENTER);
+	glVertexAttribDivisor(ATTRIB_INSTANCE_CENTER, 1);
+	glEnableVertexAttribArray(ATTRIB_INSTANCE_EXTENTS);
+	glVertexAttribDivisor(ATTRIB_INSTANCE_EXTENTS, 1);
+	glEnableVertexAttribArray(ATTRIB_INSTANCE_COLOR);
+	glVertexAttribDivisor(ATTRIB_INSTANCE_COLOR, 1);
+	glEnableVertexAttribArray(ATTRIB_INSTANCE_LAYER);
+	glVertexAttribDivisor(ATTRIB_INSTANCE_LAYER, 1);
+
+	// Tessellated lines and text have their own stream, so each stream can be mapped once per frame
+	gc.mVertexStream.Initialize(gc.mStateCache, GL_ARRAY_BUFFER, kVertexStreamRegionSize);
+
+	// Generating 1 Vertex Array and storing it's context
+	glGenVertexArrays(1, &gc.mVAOVertices);
+	gc.mStateCache.BindVertexArray(gc.mVAOVertices);
+
+	// Defining the layout of a BatchVertex once, the draws address each frame's part of the stream by index
+	gc.mStateCache.BindBuffer(GL_ARRAY_BUFFER, gc.mVertexStream.GetBuffer());
+	glVertexAttribPointer(ATTRIB_POINT_1, 3, GL_FLOAT, GL_FALSE, sizeof(BatchVertex), (void*)offsetof(BatchVertex, mPosition));
+	glEnableVertexAttribArray(ATTRIB_POINT_1);
+	glVertexAttribPointer(ATTRIB_VERTEX_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(BatchVertex), (void*)offsetof(BatchVertex, mColor));
+	glEnableVertexAttribArray(ATTRIB_VERTEX_COLOR);
+	glVertexAttribPointer(ATTRIB_VERTEX_TEXCOORDS, 2, GL_FLOAT, GL_FALSE, sizeof(BatchVertex), (void*)offsetof(BatchVertex, mTexCoords));
+	glEnableVertexAttribArray(ATTRIB_VERTEX_TEXCOORDS);
+}
+
+void EngineH::InitializeCamera()
+{
+	glGenBuffers(1, &gc.mCameraBuffer);
+	gc.mStateCache.BindBuffer(GL_UNIFORM_BUFFER, gc.mCameraBuffer);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(CameraBlock), nullptr, GL_DYNAMIC_DRAW);
+
+	// Every program's camera block reads from this binding point, see CreateShaderProgram
+	gc.mStateCache.BindBufferBase(GL_UNIFORM_BUFFER, CAMERA_BLOCK_BINDING, gc.mCameraBuffer);
+}
+
+void EngineH::UpdateCamera(const RenderFrame& frame)
+{
+	// Two mat4s are laid out the same way in std140 and in memory, so the block can be written as is
+	CameraBlock camera;
+
+	camera.mProjection = kProjection;
+
+	// Moving the camera's position to the center of the viewport, scaled around it by the zoom
+	exVector2 v2Translation(kViewportWidth / 2.0f - frame.mCameraPosition.x * frame.mCameraZoom, kViewportHeight / 2.0f - frame.mCameraPosition.y * frame.mCameraZoom);
+	camera.mView = exMatrix4::exMakeScaleTranslationMatrix(frame.mCameraZoom, v2Translation);
+
+	gc.mStateCache.BindBuffer(GL_UNIFORM_BUFFER, gc.mCameraBuffer);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(CameraBlock), &camera);
+
+	mDrawStats.mUploadedBytes += sizeof(CameraBlock);
+}
+
+void EngineH::FlushBatches(RenderFrame& frame)
+{
+	PROFILE_FUNCTION();
+
+	RenderCommandBuffer& commandBuffer = frame.mCommandBuffer;
+	const int nCommands = commandBuffer.GetCommandCount();
+
+	if (nCommands == 0)
+	{
+		return;
+	}
+
+	UpdateCamera(frame);
+
+	{
+		// The game thread may be loading a font into the atlas right now
+		std::lock_guard<std::mutex> lock(mFontMutex);
+		UpdateAtlasTextures();
+	}
+
+	const RenderBatch& frameBatch = frame.mFrameBatcher.GetBatch();
+
+	// Streaming the whole frame in one go into this frame's part of each ring buffer
+	if (frameBatch.GetInstanceCount() > 0)
+	{
+		void* pInstances = gc.mInstanceStream.Map(frameBatch.GetInstancesSizeInBytes(), sizeof(InstanceData), gc.mInstanceStreamOffset);
+		memcpy(pInstances, frameBatch.GetInstances(), frameBatch.GetInstancesSizeInBytes());
+		gc.mInstanceStream.Unmap();
+	}
+
+	if (frameBatch.GetVertexCount() > 0)
+	{
+		size_t uOffset = 0;
+		void* pVertices = gc.mVertexStream.Map(frameBatch.GetVerticesSizeInBytes(), sizeof(BatchVertex), uOffset);
+		memcpy(pVertices, frameBatch.GetVertices(), frameBatch.GetVerticesSizeInBytes());
+		gc.mVertexStream.Unmap();
+
+		// The allocation is aligned to a whole vertex, so the draws can address it by index
+		gc.mVertexStreamBase = (int)(uOffset / sizeof(BatchVertex));
+	}
+
+	gc.mGpuTimer.Mark(GPU_PASS::UPLOAD);
+
+	for (const DrawRange& range : frame.mFrameBatcher.GetDrawRanges())
+	{
+		DrawUsingShaderProgram(range);
+		gc.mGpuTimer.Mark(GetGpuPass(range.mProgram), range.mCount);
+	}
+
+	commandBuffer.Clear();
+}
+
+void EngineH::UpdateAtlasTextures()
+{
+	const int nPages = gc.mGlyphAtlas.GetPageCount();
+
+	for (int nPage = 0; nPage < nPages; ++nPage)
+	{
+		if (!gc.mGlyphAtlas.IsPageDirty(nPage))
+		{
+			continue;
+		}
+
+		const bool bNewPage = (nPage >= (int)gc.mAtlasTextures.size());
+
+		if (bNewPage)
+		{
+			GLuint texture = 0;
+			glGenTextures(1, &texture);
+			gc.mAtlasTextures.push_back(texture);
+		}
+
+		gc.mStateCache.BindTexture2D(0, gc.mAtlasTextures[nPage]);
+
+		if (bNewPage)
+		{
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, kGlyphAtlasPageSize, kGlyphAtlasPageSize, 0, GL_RED, GL_UNSIGNED_BYTE, gc.mGlyphAtlas.GetPagePixels(nPage));
+		}
+		else
+		{
+			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, kGlyphAtlasPageSize, kGlyphAtlasPageSize, GL_RED, GL_UNSIGNED_BYTE, gc.mGlyphAtlas.GetPagePixels(nPage));
+		}
+
+		gc.mGlyphAtlas.ClearDirty(nPage);
+		mDrawStats.mUploadedBytes += kGlyphAtlasPageSize * kGlyphAtlasPageSize;
+	}
+}
+
+size_t EngineH::GetStreamedBytesLastFrame() const
+{
+	return gc.mInstanceStream.GetBytesStreamedLastFrame() + gc.mVertexStream.GetBytesStreamedLastFrame();
+}
+
+int EngineH::GetElidedStateChangesLastFrame() const
+{
+	return gc.mStateCache.GetElidedStateChangesLastFrame();
+}
+
+void EngineH::SetFramePacing(FRAME_PACING ePacing, float fTargetRate)
+{
+	mFramePacing = ePacing;
+	mTargetFrameRate = fTargetRate;
+
+	// Before Run there is no GL context to set the swap interval on yet, Initialize does it
+	if (mWindow != nullptr)
+	{
+		ApplyFramePacing();
+	}
+}
+
+void EngineH::SetRenderThread(bool bEnabled, int nFramesInFlight)
+{
+	mRenderThreadEnabled = bEnabled;
+	mFramesInFlight = (nFramesInFlight < 1) ? 1 : (nFramesInFlight > kMaxFramesInFlight) ? kMaxFramesInFlight : nFramesInFlight;
+}
+
+FrameTimings EngineH::GetFrameTimings() const
+{
+	return mFrameScheduler.GetTimings();
+}
+
+std::vector<StageTiming> EngineH::GetStageTimings() const
+{
+	// The slot recorded before the one being recorded now, without a render thread every frame is recorded into the first one
+	const int nSlot = mRenderThreadRunning ? (mRecordingFrame + mFramesInFlight) % (mFramesInFlight + 1) : mRecordingFrame;
+	const FrameGraph& graph = mFrameGraphs[nSlot];
+	std::vector<StageTiming> timings;
+
+	for (int nStage = 0; nStage < graph.GetStageCount(); ++nStage)
+	{
+		StageTiming timing;
+		timing.mName = graph.GetStageName(nStage);
+		timing.mMilliseconds = graph.GetStageTime(nStage);
+
+		timings.push_back(timing);
+	}
+
+	StageTiming submit;
+	submit.mName = "Submit";
+	submit.mMilliseconds = mSubmitTime;
+	timings.push_back(submit);
+
+	return timings;
+}
+
+void EngineH::ApplyFramePacing()
+{
+	mFrameScheduler.SetPacing(mFramePacing, mTargetFrameRate);
+
+	// The context is only current on the render thread while it runs, it picks the change up before its next frame
+	if (mRenderThreadRunning)
+	{
+		mSwapIntervalDirty = true;
+	}
+	else
+	{
+		ApplySwapInterval();
+	}
+}
+
+void EngineH::ApplySwapInterval()
+{
+	// Late swap tearing isn't supported everywhere, plain vsync is the closest thing to it
+	if (SDL_GL_SetSwapInterval(mFrameScheduler.GetSwapInterval()) != 0 && mFramePacing == FRAME_PACING::ADAPTIVE)
+	{
+		LOG_WARNING("Adaptive vsync is not supported, falling back to vsync\n");
+		SDL_GL_SetSwapInterval(1);
+	}
+}
+
+void EngineH::CreateShaderProgram(SHADER_PROGRAM eProgram, const GLchar* szVertexSource, const GLchar* szFragmentSource)
+{
 	// Compile and link OpenGL program
-	GLuint vert = CompileShader(GL_VERTEX_SHADER, vert_shader);
-	GLuint frag = CompileShader(GL_FRAGMENT_SHADER, frag_shader);
+	GLuint vert = CompileShader(GL_VERTEX_SHADER, szVertexSource);
+	GLuint frag = CompileShader(GL_FRAGMENT_SHADER, szFragmentSource);
 
-	// Storing the compiled shader of the circle in the graphics context
-	gc.mCircleShaderProgram = LinkProgram(vert, frag);
-	glGenBuffers(1, &gc.mVBOPoint_Circle);
-	glGenVertexArrays(1, &gc.mVAOPoint_Circle);
+	ShaderProgram& program = gc.mShaderPrograms[(int)eProgram];
+	program.Link(vert, frag);
 
 	glDeleteShader(vert);
 	glDeleteShader(frag);
 
+	// The camera block is shared by every program, nothing about it is set per draw
+	program.BindUniformBlock("Camera", CAMERA_BLOCK_BINDING);
 }
 
 GLuint EngineH::CompileShader(GLenum eShaderType, const GLchar * pSource)
@@ -237,176 +949,171 @@ GLuint EngineH::CompileShader(GLenum eShaderType, const GLchar * pSource)
 }
 
 
-GLuint EngineH::LinkProgram(GLuint gluVertexShader, GLuint gluFragmentShader)
+void EngineH::GL_IgnoreError()
 {
-	GLuint program = glCreateProgram();
-	glAttachShader(program, gluVertexShader);
-	glAttachShader(program, gluFragmentShader);
-	glLinkProgram(program);
-	glValidateProgram(program);
-
-	GLint param;
-	glGetProgramiv(program, GL_LINK_STATUS, &param);
+	glGetError();
+}
 
-	if (!param)
-	{
-		GLchar log[4096];
-		glGetProgramInfoLog(program, sizeof(log), NULL, log);
-		//printf("error: link: %s\n", (char*)log);
-		//exAssert(false);
-	}
 
-	return program;
+void EngineH::DrawBox(const exVector2& v2P1, const exVector2& v2P2, const exColor& color, int nLayer)
+{
+	// Only recording the box here, it is drawn along with everything else at the end of the frame
+	mCommandRecorder.GetThreadBuffer().AddBox(v2P1, v2P2, color, nLayer);
 }
 
-void EngineH::GL_IgnoreError()
+void EngineH::DrawLine(const exVector2& v2P1, const exVector2& v2P2, const exColor& color, int nLayer)
 {
-	glGetError();
+	// Recorded with the current width, the line is tessellated along with every other outline at the end of the frame
+	mCommandRecorder.GetThreadBuffer().AddLine(v2P1, v2P2, mLineWidth, color, nLayer);
 }
 
 
-void EngineH::DrawBox(const exVector2& v2P1, const exVector2& v2P2, const exColor& color, int nLayer)
+void EngineH::DrawLineBox(const exVector2& v2P1, const exVector2& v2P2, const exColor& color, int nLayer)
 {
-	float width = (v2P2.x - v2P1.x) / 2;
-	float height = (v2P2.y - v2P1.y) / 2;
-	exVector2 centroid = { width + v2P1.x , height + v2P1.y };
+	mCommandRecorder.GetThreadBuffer().AddLineBox(v2P1, v2P2, mLineWidth, color, nLayer);
+}
 
-	// Generating the coordinates for the box depending on the given two points
-	float SQUARE[8] = {
-		-width,  height,
-		-width, -height,
-		 width,  height,
-		 width, -height
-	};
+void EngineH::DrawCircle(const exVector2& v2Center, float fRadius, const exColor& color, int nLayer)
+{
+	// Only recording the circle here, it is drawn along with everything else at the end of the frame
+	mCommandRecorder.GetThreadBuffer().AddCircle(v2Center, fRadius, color, nLayer);
+}
 
-	// Prepare vertex buffer object (VBO)
-	// =================================
-	glBindBuffer(GL_ARRAY_BUFFER, gc.mVBOPoint);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(SQUARE), SQUARE, GL_STATIC_DRAW);
-	// Resetting OpenGL's selected Buffer, so that this is not the buffer being used when something is drawn (Good Practices)
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-	// Prepare vertex array object (VAO) and Defining the layout of our buffer 
-	// =====================================================================
-	glBindVertexArray(gc.mVAOPoint);
-	// Binding the Array Buffer
-	glBindBuffer(GL_ARRAY_BUFFER, gc.mVBOPoint);
-	glVertexAttribPointer(ATTRIB_POINT_1, 2, GL_FLOAT, GL_FALSE, 0, 0);
-	glEnableVertexAttribArray(ATTRIB_POINT_1);
-	// Resetting OpenGL's selected Buffer and Vertex Array, so that this is not the buffer or vertex array being used when something is drawn (Good Practices)
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
-	
-	DrawUsingShaderProgram(gc.mBoxShaderProgram, gc.mVAOPoint, centroid, color, nLayer, countof(SQUARE)/2);
+void EngineH::DrawLineCircle(const exVector2& v2Center, float fRadius, const exColor& color, int nLayer)
+{
+	mCommandRecorder.GetThreadBuffer().AddLineCircle(v2Center, fRadius, mLineWidth, color, nLayer);
 }
 
-void EngineH::DrawLine(const exVector2& v2P1, const exVector2& v2P2, const exColor& color, int nLayer)
+int	EngineH::LoadFont(const char* szFile, int nPTSize)
 {
+	// Rasterizing every glyph now, drawing text later only ever reads the atlas
+	Font font;
+	std::lock_guard<std::mutex> lock(mFontMutex);
 
-}
+	if (!font.Load(szFile, nPTSize, gc.mGlyphAtlas))
+	{
+		LOG_WARNING("Failed to load font %s\n", szFile);
+		return -1;
+	}
 
+	gc.mFonts.push_back(font);
+	mFontCount.store((int)gc.mFonts.size(), std::memory_order_release);
 
-void EngineH::DrawLineBox(const exVector2& v2P1, const exVector2& v2P2, const exColor& color, int nLayer)
+	return (int)gc.mFonts.size() - 1;
+}
+
+void EngineH::DrawText(int nFontID, const exVector2& v2Position, const char* szText, const exColor& color, int nLayer)
 {
+	if (nFontID < 0 || nFontID >= mFontCount.load(std::memory_order_acquire) || szText == nullptr)
+	{
+		return;
+	}
 
+	// Laid out at the end of the frame, with the quads of every other string on screen
+	mCommandRecorder.GetThreadBuffer().AddText(nFontID, v2Position, szText, color, nLayer);
 }
 
-void EngineH::DrawCircle(const exVector2& v2Center, float fRadius, const exColor& color, int nLayer)
+void EngineH::SetCamera(const exVector2& v2Position, float fZoom)
 {
-	// Generating the coordinates for the circle depending on the given two points
-	float CIRCLE[16] = {
-		-fRadius,  fRadius, -1.0f,  1.0f,
-		-fRadius, -fRadius, -1.0f, -1.0f,
-		 fRadius,  fRadius,  1.0f,  1.0f,
-		 fRadius, -fRadius,  1.0f, -1.0f
-	};
+	mCameraPosition = v2Position;
 
-	// Preparing the vertex Buffer to draw a circle
+	// Culling and the projection both divide by the zoom, so anything but a positive one (NaN included) keeps the last zoom
+	if (!(fZoom > 0.0f))
+	{
+		LOG_WARNING("Ignoring camera zoom %f, it has to be above 0\n", fZoom);
+		return;
+	}
 
-	// Prepare vertex buffer object (VBO)
-	// =================================
-	// Generating 1 Buffer and storing it's context
-	glBindBuffer(GL_ARRAY_BUFFER, gc.mVBOPoint_Circle);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(CIRCLE), CIRCLE, GL_STATIC_DRAW);
-	// Resetting OpenGL's selected Buffer, so that this is not the buffer being used when something is drawn (Good Practices)
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	mCameraZoom = fZoom;
+}
 
-	// Prepare vertex array object (VAO)
-	// =================================
-	// Generating 1 Vertex Array and storing it's context
-	glBindVertexArray(gc.mVAOPoint_Circle);
-	glBindBuffer(GL_ARRAY_BUFFER, gc.mVBOPoint_Circle);
-	glVertexAttribPointer(ATTRIB_POINT_1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
-	glEnableVertexAttribArray(ATTRIB_POINT_1);
-	glVertexAttribPointer(ATTRIB_POINT_2, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
-	glEnableVertexAttribArray(ATTRIB_POINT_2);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
+void EngineH::SetLineWidth(float fWidth)
+{
+	mLineWidth = fWidth;
+}
 
-	// Passing the Shader Program to use and the Vertex Buffer to offer for the 
-	DrawUsingShaderProgram(gc.mCircleShaderProgram, gc.mVAOPoint_Circle, v2Center, color, nLayer, countof(CIRCLE)/2);
+void EngineH::SetFixedTimestep(float fStep, int nMaxSteps)
+{
+	mFixedTimestep.SetStep(fStep, nMaxSteps);
 }
 
-void EngineH::DrawLineCircle(const exVector2& v2Center, float fRadius, const exColor& color, int nLayer)
+GpuTimings EngineH::GetGpuTimings() const
 {
+	return gc.mGpuTimer.GetTimings();
+}
 
+JobSystem& EngineH::GetJobSystem()
+{
+	return mJobSystem;
 }
 
-int	EngineH::LoadFont(const char* szFile, int nPTSize)
+RenderStats EngineH::GetRenderStats()
 {
-	return -1;
+	RenderStats stats;
+
+	{
+		std::lock_guard<std::mutex> lock(mStatsMutex);
+		stats = mDrawnStats;
+	}
+
+	stats.mFrame = mFrameCount;
+	stats.mFrameMilliseconds = mOnFrameTime;
+
+	return stats;
 }
 
-void EngineH::DrawText(int nFontID, const exVector2& v2Position, const char* szText, const exColor& color, int nLayer)
+bool EngineH::SetRenderStatsFile(const char* szFile)
 {
+	if (szFile == nullptr)
+	{
+		mStatsWriter.Close();
+		return true;
+	}
 
+	return mStatsWriter.Open(szFile);
 }
 
-void EngineH::DrawUsingShaderProgram(GLuint shaderProgram, GLuint vertexArrayObject, const exVector2& position, const exColor& color, int nLayer, int numberOfVertices)
+void EngineH::DrawUsingShaderProgram(const DrawRange& range)
 {
-	// The three matrices we need
-	exMatrix4 orthographicProjection;
-	exMatrix4 model;
-	exMatrix4 view;
+	// The view and projection come from the camera block, only the per-instance data differs between draws
+	const ShaderProgram& program = gc.mShaderPrograms[(int)range.mProgram];
 
-	// Projection matrix
-	exMatrix4::exOrthographicProjectionMatrix(&orthographicProjection, 800.0f, 600.0f, -100.0f, 100.0f);
+	// Binds matching what is already bound are skipped, so consecutive ranges only pay for what actually differs
+	gc.mStateCache.UseProgram(program.GetHandle());
 
-	// View matrix
-	exMatrix4::exMakeTranslationMatrix(&view, exVector2(0.0f, 0.0f));
+	// Only text has soft edges
+	gc.mStateCache.SetCapability(GL_BLEND, range.mProgram == SHADER_PROGRAM::TEXT);
 
-	// Positions of the uniforms
-	int view_mat_location;
-	int proj_mat_location;
-	int model_mat_location;
+	if (range.mProgram == SHADER_PROGRAM::LINE || range.mProgram == SHADER_PROGRAM::TEXT)
+	{
+		if (range.mProgram == SHADER_PROGRAM::TEXT)
+		{
+			gc.mStateCache.BindTexture2D(0, gc.mAtlasTextures[range.mPage]);
+		}
 
-	glUseProgram(shaderProgram);
+		gc.mStateCache.BindVertexArray(gc.mVAOVertices);
+		glDrawArrays(GL_TRIANGLES, gc.mVertexStreamBase + range.mFirst, range.mCount);
 
-	exColorF colorf;
-	exColorF::ToColorF(color, colorf);
-	int in_color_vec3_location;
-	in_color_vec3_location = glGetUniformLocation(shaderProgram, "in_color");
-	glUniform3fv(in_color_vec3_location, 1, &colorf.mColor[0]);
+		++mDrawStats.mDrawCalls;
+		mDrawStats.mVertices += range.mCount;
+		return;
+	}
 
-	// Position of the object
-	exMatrix4::exMakeTranslationMatrix(&model, position);
-	
-	// This is the "layer", cast from int to float
-	model.m43 = (float)nLayer;
+	gc.mStateCache.BindVertexArray(gc.mVAOBatch);
 
-	view_mat_location = glGetUniformLocation(shaderProgram, "view");
-	glUniformMatrix4fv(view_mat_location, 1, GL_FALSE, view.ToFloatPtr());
-	proj_mat_location = glGetUniformLocation(shaderProgram, "proj");
-	glUniformMatrix4fv(proj_mat_location, 1, GL_FALSE, orthographicProjection.ToFloatPtr());
-	model_mat_location = glGetUniformLocation(shaderProgram, "model");
-	glUniformMatrix4fv(model_mat_location, 1, GL_FALSE, model.ToFloatPtr());
+	// Pointing the per-instance attributes at this range of the instance stream
+	size_t instanceOffset = gc.mInstanceStreamOffset + range.mFirst * sizeof(InstanceData);
 
-	glBindVertexArray(vertexArrayObject);
-	
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, numberOfVertices);
-	
-	glBindVertexArray(0);
-	
-	glUseProgram(0);
-}
+	gc.mStateCache.BindBuffer(GL_ARRAY_BUFFER, gc.mInstanceStream.GetBuffer());
+	glVertexAttribPointer(ATTRIB_INSTANCE_CENTER, 2, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(instanceOffset + offsetof(InstanceData, mCenter)));
+	glVertexAttribPointer(ATTRIB_INSTANCE_EXTENTS, 2, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(instanceOffset + offsetof(InstanceData, mHalfExtents)));
+	glVertexAttribPointer(ATTRIB_INSTANCE_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(InstanceData), (void*)(instanceOffset + offsetof(InstanceData, mColor)));
+	glVertexAttribPointer(ATTRIB_INSTANCE_LAYER, 1, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(instanceOffset + offsetof(InstanceData, mLayer)));
 
+	// 4 vertices of the unit quad as a triangle strip, for every instance of the range
+	glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, range.mCount);
+
+	++mDrawStats.mDrawCalls;
+	mDrawStats.mInstances += range.mCount;
+	mDrawStats.mVertices += 4 * range.mCount;
+}
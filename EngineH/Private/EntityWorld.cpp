@@ -0,0 +1,253 @@
+#include "EntityWorld.h"
+#include "Logger.h"
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+
+// Sizes of the component types numbered so far, shared by every world
+static std::mutex gComponentTypeMutex;
+static size_t gComponentSizes[kMaxComponentTypes];
+static std::atomic<int> gComponentTypeCount(0);
+
+EntityWorld::EntityWorld()
+{
+	mEntityCount = 0;
+}
+
+EntityWorld::~EntityWorld()
+{
+
+}
+
+int EntityWorld::RegisterComponentType(size_t uSize)
+{
+	std::lock_guard<std::mutex> lock(gComponentTypeMutex);
+
+	const int nType = gComponentTypeCount.load(std::memory_order_relaxed);
+
+	// Archetypes are 64-bit masks, there is no way to carry on with a type that doesn't fit in them
+	if (nType >= kMaxComponentTypes)
+	{
+		LOG_SEVERE("More than %d component types\n", kMaxComponentTypes);
+		Logger::Shutdown();
+		abort();
+	}
+
+	gComponentSizes[nType] = uSize;
+	gComponentTypeCount.store(nType + 1, std::memory_order_release);
+
+	return nType;
+}
+
+Entity EntityWorld::AllocateEntity(uint64_t uMask)
+{
+	Entity entity;
+
+	if (!mFreeIndices.empty())
+	{
+		entity.mIndex = mFreeIndices.back();
+		mFreeIndices.pop_back();
+	}
+	else
+	{
+		entity.mIndex = (uint32_t)mRecords.size();
+
+		EntityRecord record;
+		record.mGeneration = 0;
+		record.mArchetype = -1;
+		record.mChunk = 0;
+		record.mRow = 0;
+		mRecords.push_back(record);
+	}
+
+	EntityRecord& record = mRecords[entity.mIndex];
+
+	// The generation moves on every time an index is reused, so handles to the entity that had it stop being alive
+	++record.mGeneration;
+	entity.mGeneration = record.mGeneration;
+
+	record.mArchetype = FindOrCreateArchetype(uMask);
+	AddRow(*mArchetypes[record.mArchetype], entity, record.mChunk, record.mRow);
+
+	++mEntityCount;
+
+	return entity;
+}
+
+void EntityWorld::DestroyEntity(Entity entity)
+{
+	if (!IsAlive(entity))
+	{
+		return;
+	}
+
+	EntityRecord& record = mRecords[entity.mIndex];
+
+	RemoveRow(*mArchetypes[record.mArchetype], record.mChunk, record.mRow);
+
+	record.mArchetype = -1;
+	mFreeIndices.push_back(entity.mIndex);
+
+	--mEntityCount;
+}
+
+bool EntityWorld::IsAlive(Entity entity) const
+{
+	return entity.mIndex < mRecords.size() && mRecords[entity.mIndex].mGeneration == entity.mGeneration && mRecords[entity.mIndex].mArchetype >= 0;
+}
+
+int EntityWorld::GetEntityCount() const
+{
+	return mEntityCount;
+}
+
+void EntityWorld::MoveEntity(Entity entity, uint64_t uMask)
+{
+	const int nArchetype = FindOrCreateArchetype(uMask);
+
+	EntityRecord& record = mRecords[entity.mIndex];
+	Archetype& from = *mArchetypes[record.mArchetype];
+	Archetype& to = *mArchetypes[nArchetype];
+
+	int nChunk;
+	int nRow;
+	AddRow(to, entity, nChunk, nRow);
+
+	Chunk& fromChunk = *from.mChunks[record.mChunk];
+	Chunk& toChunk = *to.mChunks[nChunk];
+
+	for (int nType : to.mTypes)
+	{
+		if ((from.mMask & (1ull << nType)) != 0)
+		{
+			const size_t uSize = gComponentSizes[nType];
+			memcpy(toChunk.mData + to.mOffsets[nType] + nRow * uSize, fromChunk.mData + from.mOffsets[nType] + record.mRow * uSize, uSize);
+		}
+	}
+
+	RemoveRow(from, record.mChunk, record.mRow);
+
+	record.mArchetype = nArchetype;
+	record.mChunk = nChunk;
+	record.mRow = nRow;
+}
+
+int EntityWorld::FindOrCreateArchetype(uint64_t uMask)
+{
+	std::unordered_map<uint64_t, int>::const_iterator it = mArchetypeIndices.find(uMask);
+
+	if (it != mArchetypeIndices.end())
+	{
+		return it->second;
+	}
+
+	std::unique_ptr<Archetype> pArchetype(new Archetype());
+	pArchetype->mMask = uMask;
+
+	size_t uEntityBytes = sizeof(Entity);
+
+	for (int nType = 0; nType < kMaxComponentTypes; ++nType)
+	{
+		pArchetype->mOffsets[nType] = 0;
+
+		if ((uMask & (1ull << nType)) != 0)
+		{
+			pArchetype->mTypes.push_back(nType);
+			uEntityBytes += gComponentSizes[nType];
+		}
+	}
+
+	// As many entities as fit, less a few if aligning the arrays doesn't leave room for all of them
+	int nCapacity = (int)(kEntityChunkSize / uEntityBytes);
+
+	for (;;)
+	{
+		size_t uOffset = nCapacity * sizeof(Entity);
+
+		for (int nType : pArchetype->mTypes)
+		{
+			// Every array starts 64 byte aligned, on a cache line of its own
+			uOffset = (uOffset + 63) & ~(size_t)63;
+			pArchetype->mOffsets[nType] = uOffset;
+			uOffset += nCapacity * gComponentSizes[nType];
+		}
+
+		if (uOffset <= (size_t)kEntityChunkSize)
+		{
+			break;
+		}
+
+		--nCapacity;
+	}
+
+	if (nCapacity < 1)
+	{
+		LOG_SEVERE("Entities with %d component types don't fit in a %d byte chunk\n", (int)pArchetype->mTypes.size(), kEntityChunkSize);
+		Logger::Shutdown();
+		abort();
+	}
+
+	pArchetype->mCapacity = nCapacity;
+
+	const int nArchetype = (int)mArchetypes.size();
+	mArchetypes.push_back(std::move(pArchetype));
+	mArchetypeIndices[uMask] = nArchetype;
+
+	return nArchetype;
+}
+
+void EntityWorld::AddRow(Archetype& archetype, Entity entity, int& nChunk, int& nRow)
+{
+	if (archetype.mChunks.empty() || archetype.mChunks.back()->mCount == archetype.mCapacity)
+	{
+		if (!mFreeChunks.empty())
+		{
+			archetype.mChunks.push_back(std::move(mFreeChunks.back()));
+			mFreeChunks.pop_back();
+		}
+		else
+		{
+			archetype.mChunks.push_back(std::unique_ptr<Chunk>(new Chunk()));
+		}
+
+		archetype.mChunks.back()->mCount = 0;
+	}
+
+	Chunk& chunk = *archetype.mChunks.back();
+
+	nChunk = (int)archetype.mChunks.size() - 1;
+	nRow = chunk.mCount++;
+
+	GetEntities(chunk)[nRow] = entity;
+}
+
+void EntityWorld::RemoveRow(Archetype& archetype, int nChunk, int nRow)
+{
+	Chunk& lastChunk = *archetype.mChunks.back();
+	const int nLastChunk = (int)archetype.mChunks.size() - 1;
+	const int nLastRow = lastChunk.mCount - 1;
+
+	if (nChunk != nLastChunk || nRow != nLastRow)
+	{
+		Chunk& chunk = *archetype.mChunks[nChunk];
+		const Entity moved = GetEntities(lastChunk)[nLastRow];
+
+		GetEntities(chunk)[nRow] = moved;
+
+		for (int nType : archetype.mTypes)
+		{
+			const size_t uSize = gComponentSizes[nType];
+			memcpy(chunk.mData + archetype.mOffsets[nType] + nRow * uSize, lastChunk.mData + archetype.mOffsets[nType] + nLastRow * uSize, uSize);
+		}
+
+		mRecords[moved.mIndex].mChunk = nChunk;
+		mRecords[moved.mIndex].mRow = nRow;
+	}
+
+	// An emptied chunk goes back to the pool, for whichever archetype needs one next
+	if (--lastChunk.mCount == 0)
+	{
+		mFreeChunks.push_back(std::move(archetype.mChunks.back()));
+		archetype.mChunks.pop_back();
+	}
+}
@@ -0,0 +1,89 @@
+#include "FixedTimestep.h"
+#include "GameInterface.h"
+#include "Profiler.h"
+
+FixedTimestep::FixedTimestep()
+{
+	mStep = 0.0f;
+	mMaxSteps = 1;
+	mAccumulator = 0.0f;
+
+	mStepCount = 0;
+	mAlpha = 1.0f;
+	mDroppedTime = 0.0f;
+}
+
+FixedTimestep::~FixedTimestep()
+{
+
+}
+
+void FixedTimestep::SetStep(float fStep, int nMaxSteps)
+{
+	mStep = (fStep > 0.0f) ? fStep : 0.0f;
+	mMaxSteps = (nMaxSteps > 0) ? nMaxSteps : 1;
+	mAccumulator = 0.0f;
+}
+
+bool FixedTimestep::IsEnabled() const
+{
+	return mStep > 0.0f;
+}
+
+void FixedTimestep::RunFrame(exGameInterface* pGame, float fDeltaT)
+{
+	if (!IsEnabled())
+	{
+		{
+			PROFILE_SCOPE("Game::Run");
+			pGame->Run(fDeltaT);
+		}
+
+		mStepCount = 1;
+		mAlpha = 1.0f;
+
+		PROFILE_SCOPE("Game::Render");
+		pGame->Render(mAlpha);
+		return;
+	}
+
+	mAccumulator += fDeltaT;
+	mStepCount = 0;
+
+	while (mAccumulator >= mStep && mStepCount < mMaxSteps)
+	{
+		PROFILE_SCOPE("Game::Run");
+		pGame->Run(mStep);
+
+		mAccumulator -= mStep;
+		++mStepCount;
+	}
+
+	// Too far behind to catch up, keeping only the partial step so the simulation slows down instead of spiralling
+	if (mAccumulator >= mStep)
+	{
+		const float fKept = mAccumulator - (int)(mAccumulator / mStep) * mStep;
+		mDroppedTime += mAccumulator - fKept;
+		mAccumulator = fKept;
+	}
+
+	mAlpha = mAccumulator / mStep;
+
+	PROFILE_SCOPE("Game::Render");
+	pGame->Render(mAlpha);
+}
+
+int FixedTimestep::GetStepCountLastFrame() const
+{
+	return mStepCount;
+}
+
+float FixedTimestep::GetAlphaLastFrame() const
+{
+	return mAlpha;
+}
+
+float FixedTimestep::GetDroppedTime() const
+{
+	return mDroppedTime;
+}
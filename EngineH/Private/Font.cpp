@@ -0,0 +1,1001 @@
+#include "Font.h"
+#include "GlyphAtlas.h"
+#include "RenderBatch.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+// Sub-scanlines per row of pixels when computing a glyph's coverage, coverage along a sub-scanline is exact
+const int kCoverageSamples = 5;
+
+// How far (in pixels) the segments a curve is flattened into may stray from it
+const float kCurveTolerance = 0.1f;
+
+// Composite glyphs nested deeper than this are cut off
+const int kMaxCompositeDepth = 8;
+
+// A glyph using more components than this, counting those of its components, or flattened into more edges, is dropped
+// Nesting alone doesn't bound the work, a component listed many times at every level multiplies it at every level
+const int kMaxGlyphComponents = 256;
+const int kMaxGlyphEdges = 65536;
+
+//-----------------------------------------------------------------
+// Reading TrueType data, which is big endian
+//-----------------------------------------------------------------
+
+static uint16_t ReadU16(const unsigned char* p)
+{
+	return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static int16_t ReadS16(const unsigned char* p)
+{
+	return (int16_t)ReadU16(p);
+}
+
+static uint32_t ReadU32(const unsigned char* p)
+{
+	return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+// 2.14 fixed point, used by the scales of composite glyphs
+static float ReadF2Dot14(const unsigned char* p)
+{
+	return ReadS16(p) / 16384.0f;
+}
+
+// A straight piece of a glyph's outline in pixels, y down
+struct GlyphEdge
+{
+	float x0, y0;
+	float x1, y1;
+};
+
+// Maps font units to pixels, x' = a*x + c*y + e and y' = b*x + d*y + f
+struct GlyphTransform
+{
+	float a, b, c, d, e, f;
+
+	exVector2 Apply(float x, float y) const
+	{
+		return exVector2(a * x + c * y + e, b * x + d * y + f);
+	}
+
+	// The transform applying child first and then this one
+	GlyphTransform Combine(const GlyphTransform& child) const
+	{
+		GlyphTransform result;
+		result.a = a * child.a + c * child.b;
+		result.b = b * child.a + d * child.b;
+		result.c = a * child.c + c * child.d;
+		result.d = b * child.c + d * child.d;
+		result.e = a * child.e + c * child.f + e;
+		result.f = b * child.e + d * child.f + f;
+		return result;
+	}
+};
+
+// The parts of a TrueType file needed to turn characters into outlines, it doesn't own the data
+class TrueTypeFile
+{
+public:
+	bool Parse(const std::vector<unsigned char>& data);
+
+	// 0 (the missing glyph) for characters the font doesn't map
+	int FindGlyphIndex(int nCharacter) const;
+
+	int GetAdvance(int nGlyph) const;
+
+	// Appends the glyph's outline mapped through the transform, with its curves flattened into edges
+	// False if the glyph is made of itself or goes over the component or edge budget, the edges are left partly added then
+	bool AddGlyphEdges(int nGlyph, const GlyphTransform& transform, std::vector<GlyphEdge>& edges) const;
+
+	int mUnitsPerEm;
+	int mAscender;
+	int mDescender;
+	int mLineGap;
+
+private:
+	// The glyphs being added, from the outermost one down, and the components used so far
+	struct OutlineBudget
+	{
+		int mPath[kMaxCompositeDepth + 1];
+		int mDepth;
+		int mComponents;
+	};
+
+	const unsigned char* FindTable(const char* szTag, uint32_t& uOutLength) const;
+
+	bool AddOutlineEdges(int nGlyph, const GlyphTransform& transform, std::vector<GlyphEdge>& edges, OutlineBudget& budget) const;
+
+	void AddContour(const std::vector<exVector2>& points, const std::vector<unsigned char>& flags, int nFirst, int nLast, std::vector<GlyphEdge>& edges) const;
+
+	static void AddCurve(const exVector2& p0, const exVector2& p1, const exVector2& p2, std::vector<GlyphEdge>& edges);
+
+	const unsigned char* mData;
+	size_t mSize;
+
+	// Every length is the bytes there are to read from the pointer next to it
+	const unsigned char* mCharacterMap;
+	uint32_t mCharacterMapLength;
+	int mCharacterMapFormat;
+	const unsigned char* mLocations;
+	uint32_t mLocationsLength;
+	bool mLongLocations;
+	const unsigned char* mGlyphs;
+	uint32_t mGlyphsLength;
+	const unsigned char* mHorizontalMetrics;
+	uint32_t mHorizontalMetricsLength;
+	int mHorizontalMetricCount;
+	int mGlyphCount;
+};
+
+const unsigned char* TrueTypeFile::FindTable(const char* szTag, uint32_t& uOutLength) const
+{
+	const int nTables = ReadU16(mData + 4);
+
+	for (int i = 0; i < nTables; ++i)
+	{
+		const unsigned char* pRecord = mData + 12 + i * 16;
+
+		if (pRecord + 16 > mData + mSize)
+		{
+			break;
+		}
+
+		if (memcmp(pRecord, szTag, 4) == 0)
+		{
+			uint32_t uOffset = ReadU32(pRecord + 8);
+			uOutLength = ReadU32(pRecord + 12);
+
+			if ((size_t)uOffset + uOutLength > mSize)
+			{
+				return nullptr;
+			}
+
+			return mData + uOffset;
+		}
+	}
+
+	return nullptr;
+}
+
+bool TrueTypeFile::Parse(const std::vector<unsigned char>& data)
+{
+	mData = data.data();
+	mSize = data.size();
+
+	if (mSize < 12)
+	{
+		return false;
+	}
+
+	// Only outlines made of quadratic curves are supported, CFF based fonts have no glyf table
+	uint32_t uHeadLength = 0;
+	uint32_t uHorizontalHeaderLength = 0;
+	uint32_t uMaximumProfileLength = 0;
+	uint32_t uCharacterMapsLength = 0;
+
+	const unsigned char* pHead = FindTable("head", uHeadLength);
+	const unsigned char* pHorizontalHeader = FindTable("hhea", uHorizontalHeaderLength);
+	const unsigned char* pMaximumProfile = FindTable("maxp", uMaximumProfileLength);
+	const unsigned char* pCharacterMaps = FindTable("cmap", uCharacterMapsLength);
+	mHorizontalMetrics = FindTable("hmtx", mHorizontalMetricsLength);
+	mLocations = FindTable("loca", mLocationsLength);
+	mGlyphs = FindTable("glyf", mGlyphsLength);
+
+	if (!pHead || !pHorizontalHeader || !pMaximumProfile || !mHorizontalMetrics || !mLocations || !mGlyphs || !pCharacterMaps)
+	{
+		return false;
+	}
+
+	// Every field read from the fixed size tables has to be in them
+	if (uHeadLength < 54 || uHorizontalHeaderLength < 36 || uMaximumProfileLength < 6 || uCharacterMapsLength < 4)
+	{
+		return false;
+	}
+
+	mUnitsPerEm = ReadU16(pHead + 18);
+	mLongLocations = ReadS16(pHead + 50) != 0;
+	mGlyphCount = ReadU16(pMaximumProfile + 4);
+
+	mAscender = ReadS16(pHorizontalHeader + 4);
+	mDescender = ReadS16(pHorizontalHeader + 6);
+	mLineGap = ReadS16(pHorizontalHeader + 8);
+	mHorizontalMetricCount = ReadU16(pHorizontalHeader + 34);
+
+	// A location for every glyph and one past the last, and a metric for as many glyphs as hhea says
+	if ((uint64_t)mLocationsLength < (uint64_t)(mGlyphCount + 1) * (mLongLocations ? 4 : 2) || (uint64_t)mHorizontalMetricsLength < (uint64_t)mHorizontalMetricCount * 4)
+	{
+		return false;
+	}
+
+	// Picking a unicode map, format 12 covers everything but format 4 is all printable ASCII needs
+	mCharacterMap = nullptr;
+	mCharacterMapLength = 0;
+	mCharacterMapFormat = 0;
+
+	const int nMaps = ReadU16(pCharacterMaps + 2);
+
+	for (int i = 0; i < nMaps && 4 + (i + 1) * 8 <= (int64_t)uCharacterMapsLength; ++i)
+	{
+		const unsigned char* pRecord = pCharacterMaps + 4 + i * 8;
+		const int nPlatform = ReadU16(pRecord);
+		const int nEncoding = ReadU16(pRecord + 2);
+		const uint32_t uOffset = ReadU32(pRecord + 4);
+
+		const bool bUnicode = (nPlatform == 0) || (nPlatform == 3 && (nEncoding == 1 || nEncoding == 10));
+
+		if (!bUnicode || (uint64_t)uOffset + 2 > uCharacterMapsLength)
+		{
+			continue;
+		}
+
+		const unsigned char* pMap = pCharacterMaps + uOffset;
+		const uint32_t uMapLength = uCharacterMapsLength - uOffset;
+		const int nFormat = ReadU16(pMap);
+
+		// The map's header and the arrays FindGlyphIndex walks have to be in the table
+		bool bComplete = false;
+
+		if (nFormat == 4 && uMapLength >= 14)
+		{
+			bComplete = 16 + (uint64_t)(ReadU16(pMap + 6) / 2) * 8 <= uMapLength;
+		}
+		else if (nFormat == 12 && uMapLength >= 16)
+		{
+			bComplete = 16 + (uint64_t)ReadU32(pMap + 12) * 12 <= uMapLength;
+		}
+
+		if (bComplete && nFormat > mCharacterMapFormat)
+		{
+			mCharacterMap = pMap;
+			mCharacterMapLength = uMapLength;
+			mCharacterMapFormat = nFormat;
+		}
+	}
+
+	return mCharacterMap != nullptr && mUnitsPerEm > 0 && mHorizontalMetricCount > 0;
+}
+
+int TrueTypeFile::FindGlyphIndex(int nCharacter) const
+{
+	if (mCharacterMapFormat == 12)
+	{
+		const uint32_t uGroups = ReadU32(mCharacterMap + 12);
+
+		for (uint32_t i = 0; i < uGroups; ++i)
+		{
+			const unsigned char* pGroup = mCharacterMap + 16 + i * 12;
+			const uint32_t uStart = ReadU32(pGroup);
+			const uint32_t uEnd = ReadU32(pGroup + 4);
+
+			if ((uint32_t)nCharacter >= uStart && (uint32_t)nCharacter <= uEnd)
+			{
+				const uint32_t uGlyph = ReadU32(pGroup + 8) + (nCharacter - uStart);
+				return (uGlyph < (uint32_t)mGlyphCount) ? (int)uGlyph : 0;
+			}
+		}
+
+		return 0;
+	}
+
+	// Format 4, segments of consecutive characters
+	const int nSegments = ReadU16(mCharacterMap + 6) / 2;
+	const unsigned char* pEndCodes = mCharacterMap + 14;
+	const unsigned char* pStartCodes = pEndCodes + nSegments * 2 + 2;
+	const unsigned char* pDeltas = pStartCodes + nSegments * 2;
+	const unsigned char* pRangeOffsets = pDeltas + nSegments * 2;
+
+	for (int i = 0; i < nSegments; ++i)
+	{
+		if (nCharacter > ReadU16(pEndCodes + i * 2))
+		{
+			continue;
+		}
+
+		const int nStart = ReadU16(pStartCodes + i * 2);
+
+		if (nCharacter < nStart)
+		{
+			return 0;
+		}
+
+		const int nDelta = ReadS16(pDeltas + i * 2);
+		const int nRangeOffset = ReadU16(pRangeOffsets + i * 2);
+
+		if (nRangeOffset == 0)
+		{
+			return (nCharacter + nDelta) & 0xFFFF;
+		}
+
+		// The range offset is relative to where it is stored
+		const int64_t nIndexOffset = (pRangeOffsets - mCharacterMap) + i * 2 + nRangeOffset + (nCharacter - nStart) * 2;
+
+		if (nIndexOffset + 2 > (int64_t)mCharacterMapLength)
+		{
+			return 0;
+		}
+
+		const int nGlyph = ReadU16(mCharacterMap + nIndexOffset);
+
+		return (nGlyph == 0) ? 0 : ((nGlyph + nDelta) & 0xFFFF);
+	}
+
+	return 0;
+}
+
+int TrueTypeFile::GetAdvance(int nGlyph) const
+{
+	// Glyphs past the last metric share its advance
+	const int nMetric = (nGlyph < mHorizontalMetricCount) ? nGlyph : mHorizontalMetricCount - 1;
+	return ReadU16(mHorizontalMetrics + nMetric * 4);
+}
+
+bool TrueTypeFile::AddGlyphEdges(int nGlyph, const GlyphTransform& transform, std::vector<GlyphEdge>& edges) const
+{
+	OutlineBudget budget;
+	budget.mPath[0] = nGlyph;
+	budget.mDepth = 0;
+	budget.mComponents = 0;
+
+	return AddOutlineEdges(nGlyph, transform, edges, budget);
+}
+
+bool TrueTypeFile::AddOutlineEdges(int nGlyph, const GlyphTransform& transform, std::vector<GlyphEdge>& edges, OutlineBudget& budget) const
+{
+	if (nGlyph < 0 || nGlyph >= mGlyphCount)
+	{
+		return true;
+	}
+
+	const uint32_t uOffset = mLongLocations ? ReadU32(mLocations + nGlyph * 4) : ReadU16(mLocations + nGlyph * 2) * 2u;
+	const uint32_t uNextOffset = mLongLocations ? ReadU32(mLocations + nGlyph * 4 + 4) : ReadU16(mLocations + nGlyph * 2 + 2) * 2u;
+
+	// Empty glyphs (the space) have no data at all, the rest start with a 10 byte header
+	if (uNextOffset <= uOffset || uNextOffset > mGlyphsLength || uNextOffset - uOffset < 10)
+	{
+		return true;
+	}
+
+	// Glyphs whose data runs past their end are skipped, composites keep the components read before it
+	const unsigned char* pGlyph = mGlyphs + uOffset;
+	const unsigned char* pEnd = mGlyphs + uNextOffset;
+	const int nContours = ReadS16(pGlyph);
+
+	if (nContours < 0)
+	{
+		// A composite glyph, made of other glyphs each with its own transform
+		const unsigned char* p = pGlyph + 10;
+		uint16_t uFlags = 0;
+
+		do
+		{
+			if (pEnd - p < 4)
+			{
+				return true;
+			}
+
+			uFlags = ReadU16(p);
+			const int nComponent = ReadU16(p + 2);
+			p += 4;
+
+			// The arguments, words or bytes, and then the scale, one value, two or a 2x2 matrix
+			const int nTransformSize = ((uFlags & 0x0001) ? 4 : 2) + ((uFlags & 0x0008) ? 2 : (uFlags & 0x0040) ? 4 : (uFlags & 0x0080) ? 8 : 0);
+
+			if (pEnd - p < nTransformSize)
+			{
+				return true;
+			}
+
+			GlyphTransform component = { 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f };
+
+			// Only offsets are supported, components positioned by matching points stay where they are
+			if (uFlags & 0x0001)
+			{
+				if (uFlags & 0x0002)
+				{
+					component.e = ReadS16(p);
+					component.f = ReadS16(p + 2);
+				}
+				p += 4;
+			}
+			else
+			{
+				if (uFlags & 0x0002)
+				{
+					component.e = (signed char)p[0];
+					component.f = (signed char)p[1];
+				}
+				p += 2;
+			}
+
+			if (uFlags & 0x0008)
+			{
+				component.a = component.d = ReadF2Dot14(p);
+				p += 2;
+			}
+			else if (uFlags & 0x0040)
+			{
+				component.a = ReadF2Dot14(p);
+				component.d = ReadF2Dot14(p + 2);
+				p += 4;
+			}
+			else if (uFlags & 0x0080)
+			{
+				component.a = ReadF2Dot14(p);
+				component.b = ReadF2Dot14(p + 2);
+				component.c = ReadF2Dot14(p + 4);
+				component.d = ReadF2Dot14(p + 6);
+				p += 8;
+			}
+
+			if (++budget.mComponents > kMaxGlyphComponents)
+			{
+				return false;
+			}
+
+			// A glyph can't contain itself, not even through other glyphs
+			for (int i = 0; i <= budget.mDepth; ++i)
+			{
+				if (budget.mPath[i] == nComponent)
+				{
+					return false;
+				}
+			}
+
+			if (budget.mDepth < kMaxCompositeDepth)
+			{
+				budget.mPath[++budget.mDepth] = nComponent;
+				const bool bAdded = AddOutlineEdges(nComponent, transform.Combine(component), edges, budget);
+				--budget.mDepth;
+
+				if (!bAdded)
+				{
+					return false;
+				}
+			}
+		}
+		while (uFlags & 0x0020);
+
+		return true;
+	}
+
+	if (nContours == 0)
+	{
+		return true;
+	}
+
+	const unsigned char* pEndPoints = pGlyph + 10;
+
+	// The contours' last points and the length of the instructions
+	if (pEnd - pEndPoints < nContours * 2 + 2)
+	{
+		return true;
+	}
+
+	const int nPoints = ReadU16(pEndPoints + (nContours - 1) * 2) + 1;
+
+	// Skipping the hinting instructions
+	const unsigned char* p = pEndPoints + nContours * 2;
+	const int nInstructionLength = ReadU16(p);
+
+	if (pEnd - p < 2 + nInstructionLength)
+	{
+		return true;
+	}
+
+	p += 2 + nInstructionLength;
+
+	// Flags, with runs of repeated flags compressed
+	std::vector<unsigned char> flags(nPoints);
+
+	for (int i = 0; i < nPoints; ++i)
+	{
+		if (p == pEnd)
+		{
+			return true;
+		}
+
+		unsigned char uFlag = *p++;
+		flags[i] = uFlag;
+
+		if (uFlag & 0x08)
+		{
+			if (p == pEnd)
+			{
+				return true;
+			}
+
+			int nRepeat = *p++;
+
+			while (nRepeat-- > 0 && i + 1 < nPoints)
+			{
+				flags[++i] = uFlag;
+			}
+		}
+	}
+
+	// Coordinates are deltas from the previous point, either a byte with its sign in the flags or a short
+	std::vector<exVector2> points(nPoints);
+	int nValue = 0;
+
+	for (int i = 0; i < nPoints; ++i)
+	{
+		const int nSize = (flags[i] & 0x02) ? 1 : (flags[i] & 0x10) ? 0 : 2;
+
+		if (pEnd - p < nSize)
+		{
+			return true;
+		}
+
+		if (flags[i] & 0x02)
+		{
+			nValue += (flags[i] & 0x10) ? *p : -*p;
+			p += 1;
+		}
+		else if (!(flags[i] & 0x10))
+		{
+			nValue += ReadS16(p);
+			p += 2;
+		}
+		points[i].x = (float)nValue;
+	}
+
+	nValue = 0;
+
+	for (int i = 0; i < nPoints; ++i)
+	{
+		const int nSize = (flags[i] & 0x04) ? 1 : (flags[i] & 0x20) ? 0 : 2;
+
+		if (pEnd - p < nSize)
+		{
+			return true;
+		}
+
+		if (flags[i] & 0x04)
+		{
+			nValue += (flags[i] & 0x20) ? *p : -*p;
+			p += 1;
+		}
+		else if (!(flags[i] & 0x20))
+		{
+			nValue += ReadS16(p);
+			p += 2;
+		}
+		points[i].y = (float)nValue;
+	}
+
+	for (exVector2& point : points)
+	{
+		point = transform.Apply(point.x, point.y);
+	}
+
+	int nFirst = 0;
+
+	for (int nContour = 0; nContour < nContours; ++nContour)
+	{
+		const int nLast = ReadU16(pEndPoints + nContour * 2);
+
+		if (nLast >= nPoints || nLast < nFirst)
+		{
+			break;
+		}
+
+		AddContour(points, flags, nFirst, nLast, edges);
+		nFirst = nLast + 1;
+	}
+
+	return edges.size() <= (size_t)kMaxGlyphEdges;
+}
+
+void TrueTypeFile::AddContour(const std::vector<exVector2>& points, const std::vector<unsigned char>& flags, int nFirst, int nLast, std::vector<GlyphEdge>& edges) const
+{
+	const int nCount = nLast - nFirst + 1;
+
+	if (nCount < 2)
+	{
+		return;
+	}
+
+	// Starting on a point of the outline, or between two control points if there are none
+	int nStart = -1;
+
+	for (int i = 0; i < nCount; ++i)
+	{
+		if (flags[nFirst + i] & 0x01)
+		{
+			nStart = i;
+			break;
+		}
+	}
+
+	exVector2 v2Start;
+
+	if (nStart >= 0)
+	{
+		v2Start = points[nFirst + nStart];
+	}
+	else
+	{
+		const exVector2& v2First = points[nFirst];
+		const exVector2& v2Last = points[nLast];
+		v2Start = exVector2((v2First.x + v2Last.x) * 0.5f, (v2First.y + v2Last.y) * 0.5f);
+	}
+
+	exVector2 v2Pen = v2Start;
+	exVector2 v2Control;
+	bool bHasControl = false;
+
+	const int nRemaining = (nStart >= 0) ? nCount - 1 : nCount;
+	const int nOffset = (nStart >= 0) ? nStart + 1 : 0;
+
+	for (int k = 0; k < nRemaining; ++k)
+	{
+		const int i = nFirst + (nOffset + k) % nCount;
+		const exVector2& v2Point = points[i];
+
+		if (flags[i] & 0x01)
+		{
+			if (bHasControl)
+			{
+				AddCurve(v2Pen, v2Control, v2Point, edges);
+			}
+			else
+			{
+				edges.push_back({ v2Pen.x, v2Pen.y, v2Point.x, v2Point.y });
+			}
+
+			v2Pen = v2Point;
+			bHasControl = false;
+		}
+		else
+		{
+			// Two control points in a row imply a point of the outline halfway between them
+			if (bHasControl)
+			{
+				exVector2 v2Middle((v2Control.x + v2Point.x) * 0.5f, (v2Control.y + v2Point.y) * 0.5f);
+				AddCurve(v2Pen, v2Control, v2Middle, edges);
+				v2Pen = v2Middle;
+			}
+
+			v2Control = v2Point;
+			bHasControl = true;
+		}
+	}
+
+	// Closing the contour
+	if (bHasControl)
+	{
+		AddCurve(v2Pen, v2Control, v2Start, edges);
+	}
+	else
+	{
+		edges.push_back({ v2Pen.x, v2Pen.y, v2Start.x, v2Start.y });
+	}
+}
+
+void TrueTypeFile::AddCurve(const exVector2& p0, const exVector2& p1, const exVector2& p2, std::vector<GlyphEdge>& edges)
+{
+	// The points are already in pixels, a quadratic split into n segments strays at most |p0 - 2 p1 + p2| / (8 n^2) from them
+	float dx = p0.x - 2.0f * p1.x + p2.x;
+	float dy = p0.y - 2.0f * p1.y + p2.y;
+	float fDeviation = sqrtf(dx * dx + dy * dy);
+
+	int nSegments = (int)ceilf(sqrtf(fDeviation / (8.0f * kCurveTolerance)));
+	nSegments = (nSegments < 1) ? 1 : nSegments;
+
+	exVector2 v2Previous = p0;
+
+	for (int i = 1; i <= nSegments; ++i)
+	{
+		float t = (float)i / nSegments;
+		float u = 1.0f - t;
+
+		exVector2 v2Point(u * u * p0.x + 2.0f * u * t * p1.x + t * t * p2.x, u * u * p0.y + 2.0f * u * t * p1.y + t * t * p2.y);
+
+		edges.push_back({ v2Previous.x, v2Previous.y, v2Point.x, v2Point.y });
+		v2Previous = v2Point;
+	}
+}
+
+//-----------------------------------------------------------------
+// Rasterizing outlines into coverage bitmaps
+//-----------------------------------------------------------------
+
+// Adds weight times the covered part of each pixel between x0 and x1
+static void AddCoverageSpan(float* pRow, int nWidth, float x0, float x1, float fWeight)
+{
+	x0 = (x0 < 0.0f) ? 0.0f : x0;
+	x1 = (x1 > (float)nWidth) ? (float)nWidth : x1;
+
+	if (x1 <= x0)
+	{
+		return;
+	}
+
+	const int nPixel0 = (int)x0;
+	const int nPixel1 = (int)x1;
+
+	if (nPixel0 == nPixel1)
+	{
+		pRow[nPixel0] += (x1 - x0) * fWeight;
+		return;
+	}
+
+	pRow[nPixel0] += (nPixel0 + 1 - x0) * fWeight;
+
+	for (int x = nPixel0 + 1; x < nPixel1; ++x)
+	{
+		pRow[x] += fWeight;
+	}
+
+	if (nPixel1 < nWidth)
+	{
+		pRow[nPixel1] += (x1 - nPixel1) * fWeight;
+	}
+}
+
+// Fills the outline with the non-zero winding rule into an 8-bit coverage bitmap whose top left pixel is at (nLeft, nTop)
+static void RasterizeEdges(const std::vector<GlyphEdge>& edges, int nLeft, int nTop, int nWidth, int nHeight, std::vector<unsigned char>& pixels)
+{
+	struct Crossing
+	{
+		float mX;
+		int mWinding;
+	};
+
+	std::vector<float> coverage(nWidth);
+	std::vector<Crossing> crossings;
+	const float fWeight = 1.0f / kCoverageSamples;
+
+	pixels.assign(nWidth * nHeight, 0);
+
+	for (int y = 0; y < nHeight; ++y)
+	{
+		std::fill(coverage.begin(), coverage.end(), 0.0f);
+
+		for (int nSample = 0; nSample < kCoverageSamples; ++nSample)
+		{
+			const float fScanline = nTop + y + (nSample + 0.5f) * fWeight;
+
+			crossings.clear();
+
+			for (const GlyphEdge& edge : edges)
+			{
+				// Half open in y so an edge's end and the next one's start are never both counted
+				const bool bDown = edge.y1 > edge.y0;
+				const float fTop = bDown ? edge.y0 : edge.y1;
+				const float fBottom = bDown ? edge.y1 : edge.y0;
+
+				if (fScanline < fTop || fScanline >= fBottom)
+				{
+					continue;
+				}
+
+				float t = (fScanline - edge.y0) / (edge.y1 - edge.y0);
+				crossings.push_back({ edge.x0 + t * (edge.x1 - edge.x0) - nLeft, bDown ? 1 : -1 });
+			}
+
+			std::sort(crossings.begin(), crossings.end(), [](const Crossing& a, const Crossing& b) { return a.mX < b.mX; });
+
+			int nWinding = 0;
+			float fSpanStart = 0.0f;
+
+			for (const Crossing& crossing : crossings)
+			{
+				const int nPrevious = nWinding;
+				nWinding += crossing.mWinding;
+
+				if (nPrevious == 0 && nWinding != 0)
+				{
+					fSpanStart = crossing.mX;
+				}
+				else if (nPrevious != 0 && nWinding == 0)
+				{
+					AddCoverageSpan(coverage.data(), nWidth, fSpanStart, crossing.mX, fWeight);
+				}
+			}
+		}
+
+		for (int x = 0; x < nWidth; ++x)
+		{
+			float fValue = coverage[x] * 255.0f + 0.5f;
+			pixels[y * nWidth + x] = (unsigned char)((fValue > 255.0f) ? 255.0f : fValue);
+		}
+	}
+}
+
+//-----------------------------------------------------------------
+//-----------------------------------------------------------------
+
+Font::Font()
+{
+	memset(mGlyphs, 0, sizeof(mGlyphs));
+
+	for (Glyph& glyph : mGlyphs)
+	{
+		glyph.mPage = -1;
+	}
+
+	mAscent = 0.0f;
+	mLineHeight = 0.0f;
+}
+
+Font::~Font()
+{
+
+}
+
+bool Font::Load(const char* szFile, int nPTSize, GlyphAtlas& atlas)
+{
+	if (szFile == nullptr || nPTSize <= 0)
+	{
+		return false;
+	}
+
+	FILE* pFile = fopen(szFile, "rb");
+
+	if (pFile == nullptr)
+	{
+		return false;
+	}
+
+	std::vector<unsigned char> data;
+	fseek(pFile, 0, SEEK_END);
+	long nSize = ftell(pFile);
+	fseek(pFile, 0, SEEK_SET);
+
+	if (nSize > 0)
+	{
+		data.resize(nSize);
+		data.resize(fread(data.data(), 1, data.size(), pFile));
+	}
+
+	fclose(pFile);
+
+	TrueTypeFile file;
+
+	if (!file.Parse(data))
+	{
+		return false;
+	}
+
+	// Like SDL_ttf the point size is taken at 72 dpi, so it is the size of an em in pixels
+	const float fPixelsPerUnit = (float)nPTSize / file.mUnitsPerEm;
+
+	mAscent = roundf(file.mAscender * fPixelsPerUnit);
+	mLineHeight = roundf((file.mAscender - file.mDescender + file.mLineGap) * fPixelsPerUnit);
+
+	// Font units are y up, the engine is y down with the origin on the baseline
+	const GlyphTransform toPixels = { fPixelsPerUnit, 0.0f, 0.0f, -fPixelsPerUnit, 0.0f, 0.0f };
+
+	std::vector<GlyphEdge> edges;
+	std::vector<unsigned char> pixels;
+
+	for (int c = kFirstGlyphCharacter; c <= kLastGlyphCharacter; ++c)
+	{
+		Glyph& glyph = mGlyphs[c - kFirstGlyphCharacter];
+		const int nGlyph = file.FindGlyphIndex(c);
+
+		glyph.mAdvance = roundf(file.GetAdvance(nGlyph) * fPixelsPerUnit);
+		glyph.mPage = -1;
+
+		edges.clear();
+
+		// A glyph over its budget is left without pixels, rather than a hostile font hanging the load
+		if (!file.AddGlyphEdges(nGlyph, toPixels, edges))
+		{
+			edges.clear();
+		}
+
+		if (edges.empty())
+		{
+			continue;
+		}
+
+		float fMinX = edges[0].x0, fMaxX = edges[0].x0;
+		float fMinY = edges[0].y0, fMaxY = edges[0].y0;
+
+		for (const GlyphEdge& edge : edges)
+		{
+			fMinX = std::min(fMinX, std::min(edge.x0, edge.x1));
+			fMaxX = std::max(fMaxX, std::max(edge.x0, edge.x1));
+			fMinY = std::min(fMinY, std::min(edge.y0, edge.y1));
+			fMaxY = std::max(fMaxY, std::max(edge.y0, edge.y1));
+		}
+
+		const int nLeft = (int)floorf(fMinX);
+		const int nTop = (int)floorf(fMinY);
+		const int nWidth = (int)ceilf(fMaxX) - nLeft;
+		const int nHeight = (int)ceilf(fMaxY) - nTop;
+
+		if (nWidth <= 0 || nHeight <= 0)
+		{
+			continue;
+		}
+
+		int nPage = 0, nX = 0, nY = 0;
+
+		if (!atlas.Allocate(nWidth, nHeight, nPage, nX, nY))
+		{
+			continue;
+		}
+
+		RasterizeEdges(edges, nLeft, nTop, nWidth, nHeight, pixels);
+		atlas.Write(nPage, nX, nY, nWidth, nHeight, pixels.data());
+
+		glyph.mOffset[0] = (float)nLeft;
+		glyph.mOffset[1] = (float)nTop;
+		glyph.mSize[0] = (float)nWidth;
+		glyph.mSize[1] = (float)nHeight;
+		glyph.mTexCoords[0] = (float)nX / kGlyphAtlasPageSize;
+		glyph.mTexCoords[1] = (float)nY / kGlyphAtlasPageSize;
+		glyph.mTexCoords[2] = (float)(nX + nWidth) / kGlyphAtlasPageSize;
+		glyph.mTexCoords[3] = (float)(nY + nHeight) / kGlyphAtlasPageSize;
+		glyph.mPage = nPage;
+	}
+
+	return true;
+}
+
+const Glyph& Font::GetGlyph(char c) const
+{
+	if (c < kFirstGlyphCharacter || c > kLastGlyphCharacter)
+	{
+		c = '?';
+	}
+
+	return mGlyphs[c - kFirstGlyphCharacter];
+}
+
+float Font::GetAscent() const
+{
+	return mAscent;
+}
+
+float Font::GetLineHeight() const
+{
+	return mLineHeight;
+}
+
+void Font::AddText(std::vector<RenderBatch>& pageBatches, const exVector2& v2Position, const char* szText, const exColor& color, int nLayer) const
+{
+	float fPenX = v2Position.x;
+	float fBaseline = v2Position.y + mAscent;
+
+	for (const char* p = szText; *p != '\0'; ++p)
+	{
+		if (*p == '\n')
+		{
+			fPenX = v2Position.x;
+			fBaseline += mLineHeight;
+			continue;
+		}
+
+		const Glyph& glyph = GetGlyph(*p);
+
+		if (glyph.mPage >= 0 && glyph.mPage < (int)pageBatches.size())
+		{
+			// Snapping to whole units keeps the bitmaps crisp when the camera isn't zoomed
+			float x0 = floorf(fPenX + 0.5f) + glyph.mOffset[0];
+			float y0 = floorf(fBaseline + 0.5f) + glyph.mOffset[1];
+			float x1 = x0 + glyph.mSize[0];
+			float y1 = y0 + glyph.mSize[1];
+
+			const float* uv = glyph.mTexCoords;
+			RenderBatch& batch = pageBatches[glyph.mPage];
+
+			batch.AddVertex(exVector2(x0, y0), uv[0], uv[1], color, nLayer);
+			batch.AddVertex(exVector2(x0, y1), uv[0], uv[3], color, nLayer);
+			batch.AddVertex(exVector2(x1, y0), uv[2], uv[1], color, nLayer);
+
+			batch.AddVertex(exVector2(x1, y0), uv[2], uv[1], color, nLayer);
+			batch.AddVertex(exVector2(x0, y1), uv[0], uv[3], color, nLayer);
+			batch.AddVertex(exVector2(x1, y1), uv[2], uv[3], color, nLayer);
+		}
+
+		fPenX += glyph.mAdvance;
+	}
+}
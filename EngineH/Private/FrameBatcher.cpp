@@ -0,0 +1,122 @@
+#include "FrameBatcher.h"
+#include "Font.h"
+
+FrameBatcher::FrameBatcher()
+{
+
+}
+
+FrameBatcher::~FrameBatcher()
+{
+
+}
+
+void FrameBatcher::Build(RenderCommandBuffer& commandBuffer, const std::vector<Font>& fonts, int nAtlasPages, float fScreenScale)
+{
+	const int nCommands = commandBuffer.GetCommandCount();
+
+	// Ordering the draws by layer first and shader second, so each shader switch is only paid once per layer at most
+	commandBuffer.Sort();
+
+	// Generating the instances and vertices in sorted order, starting a new range whenever the shader changes
+	mFrameBatch.Clear();
+	mDrawRanges.clear();
+
+	if ((int)mTextPageBatches.size() < nAtlasPages)
+	{
+		mTextPageBatches.resize(nAtlasPages);
+	}
+
+	SHADER_PROGRAM eRunProgram = SHADER_PROGRAM::COUNT;
+
+	for (int i = 0; i < nCommands; ++i)
+	{
+		const RenderCommand& command = commandBuffer.GetSortedCommand(i);
+		SHADER_PROGRAM eProgram = RenderCommandBuffer::GetProgramFromKey(command.mKey);
+		const bool bVertices = (eProgram == SHADER_PROGRAM::LINE);
+
+		if (eProgram != eRunProgram)
+		{
+			// Text only knows its ranges once the whole run has been laid out
+			if (eRunProgram == SHADER_PROGRAM::TEXT)
+			{
+				AddTextRanges();
+			}
+
+			if (eProgram != SHADER_PROGRAM::TEXT)
+			{
+				DrawRange range = { eProgram, bVertices ? mFrameBatch.GetVertexCount() : mFrameBatch.GetInstanceCount(), 0, -1 };
+				mDrawRanges.push_back(range);
+			}
+
+			eRunProgram = eProgram;
+		}
+
+		switch (command.mType)
+		{
+		case PRIMITIVE_TYPE::BOX:
+		{
+			float width = (command.mP2.x - command.mP1.x) / 2;
+			float height = (command.mP2.y - command.mP1.y) / 2;
+			exVector2 centroid = { width + command.mP1.x , height + command.mP1.y };
+
+			mFrameBatch.AddInstance(centroid, width, height, command.mColor, command.mLayer);
+			break;
+		}
+		case PRIMITIVE_TYPE::CIRCLE:
+			// A square around the circle, the circle shader removes all pixels outside the radius
+			mFrameBatch.AddInstance(command.mP1, command.mRadius, command.mRadius, command.mColor, command.mLayer);
+			break;
+		case PRIMITIVE_TYPE::LINE:
+			mLineTessellator.AddLine(mFrameBatch, command.mP1, command.mP2, command.mWidth, command.mColor, command.mLayer);
+			break;
+		case PRIMITIVE_TYPE::LINE_BOX:
+			mLineTessellator.AddLineBox(mFrameBatch, command.mP1, command.mP2, command.mWidth, command.mColor, command.mLayer);
+			break;
+		case PRIMITIVE_TYPE::LINE_CIRCLE:
+			// The camera's zoom decides how big the circle ends up on screen, and so how many segments it needs
+			mLineTessellator.AddLineCircle(mFrameBatch, command.mP1, command.mRadius, fScreenScale, command.mWidth, command.mColor, command.mLayer);
+			break;
+		case PRIMITIVE_TYPE::TEXT:
+			fonts[command.mFontID].AddText(mTextPageBatches, command.mP1, commandBuffer.GetText(command), command.mColor, command.mLayer);
+			continue;
+		}
+
+		DrawRange& range = mDrawRanges.back();
+		range.mCount = (bVertices ? mFrameBatch.GetVertexCount() : mFrameBatch.GetInstanceCount()) - range.mFirst;
+	}
+
+	if (eRunProgram == SHADER_PROGRAM::TEXT)
+	{
+		AddTextRanges();
+	}
+}
+
+const RenderBatch& FrameBatcher::GetBatch() const
+{
+	return mFrameBatch;
+}
+
+const std::vector<DrawRange>& FrameBatcher::GetDrawRanges() const
+{
+	return mDrawRanges;
+}
+
+void FrameBatcher::AddTextRanges()
+{
+	for (int nPage = 0; nPage < (int)mTextPageBatches.size(); ++nPage)
+	{
+		RenderBatch& pageBatch = mTextPageBatches[nPage];
+
+		if (pageBatch.GetVertexCount() == 0)
+		{
+			continue;
+		}
+
+		DrawRange range = { SHADER_PROGRAM::TEXT, mFrameBatch.GetVertexCount(), pageBatch.GetVertexCount(), nPage };
+		mDrawRanges.push_back(range);
+
+		mFrameBatch.AppendVertices(pageBatch);
+		pageBatch.Clear();
+	}
+}
@@ -0,0 +1,231 @@
+#include "FrameGraph.h"
+#include "Logger.h"
+#include "Profiler.h"
+#include <chrono>
+#include <string>
+
+FrameGraph::FrameGraph()
+{
+	mJobSystem = nullptr;
+}
+
+FrameGraph::~FrameGraph()
+{
+	if (mJobSystem != nullptr)
+	{
+		Wait(*mJobSystem);
+	}
+}
+
+int FrameGraph::AddResource(const char* szName, bool bSharedAcrossFrames)
+{
+	Resource resource;
+	resource.mName = szName;
+	resource.mShared = bSharedAcrossFrames;
+
+	mResources.push_back(resource);
+
+	return (int)mResources.size() - 1;
+}
+
+int FrameGraph::AddStage(const char* szName, STAGE_THREAD eThread, std::function<void()> function)
+{
+	std::unique_ptr<Stage> stage(new Stage());
+	stage->mName = szName;
+	stage->mThread = eThread;
+	stage->mFunction = std::move(function);
+	stage->mRemainingDependencies = 0;
+	stage->mReady = false;
+	stage->mTime = 0.0f;
+
+	mStages.push_back(std::move(stage));
+
+	return (int)mStages.size() - 1;
+}
+
+void FrameGraph::AddDependency(int nStage, int nDependency)
+{
+	if (nDependency >= nStage)
+	{
+		LOG_WARNING("Frame graph stage %s can only depend on stages added before it\n", mStages[nStage]->mName);
+		return;
+	}
+
+	mStages[nStage]->mDependencies.push_back(nDependency);
+	mStages[nDependency]->mDependents.push_back(nStage);
+}
+
+void FrameGraph::AddAccess(int nStage, int nResource, RESOURCE_ACCESS eAccess)
+{
+	mStages[nStage]->mAccesses.push_back(std::make_pair(nResource, eAccess));
+}
+
+bool FrameGraph::Validate() const
+{
+	bool bValid = true;
+
+	for (int nStage = 0; nStage < (int)mStages.size(); ++nStage)
+	{
+		for (const std::pair<int, RESOURCE_ACCESS>& access : mStages[nStage]->mAccesses)
+		{
+			const Resource& resource = mResources[access.first];
+
+			if (resource.mShared && !IsBlocking(nStage))
+			{
+				LOG_WARNING("Frame graph stage %s touches %s, which the next frame may touch while it is still running\n", mStages[nStage]->mName, resource.mName);
+				bValid = false;
+			}
+
+			// Every later stage touching the same resource, with a write on either side, has to be ordered with this one
+			for (int nOther = nStage + 1; nOther < (int)mStages.size(); ++nOther)
+			{
+				for (const std::pair<int, RESOURCE_ACCESS>& otherAccess : mStages[nOther]->mAccesses)
+				{
+					const bool bConflict = (otherAccess.first == access.first) && (access.second == RESOURCE_ACCESS::WRITE || otherAccess.second == RESOURCE_ACCESS::WRITE);
+
+					if (bConflict && !IsAncestor(nStage, nOther))
+					{
+						LOG_WARNING("Frame graph stages %s and %s can run at the same time and both touch %s\n", mStages[nStage]->mName, mStages[nOther]->mName, resource.mName);
+						bValid = false;
+					}
+				}
+			}
+		}
+	}
+
+	return bValid;
+}
+
+void FrameGraph::Execute(JobSystem& jobSystem)
+{
+	// The previous run has to be over before the stages can be reset
+	Wait(jobSystem);
+
+	mJobSystem = &jobSystem;
+
+	int nMainStages = 0;
+
+	for (std::unique_ptr<Stage>& stage : mStages)
+	{
+		stage->mRemainingDependencies = (int)stage->mDependencies.size();
+		stage->mReady = false;
+
+		nMainStages += (stage->mThread == STAGE_THREAD::MAIN) ? 1 : 0;
+	}
+
+	for (int nStage = 0; nStage < (int)mStages.size(); ++nStage)
+	{
+		if (mStages[nStage]->mDependencies.empty())
+		{
+			Release(nStage);
+		}
+	}
+
+	// Running the MAIN stages as they become ready, and helping with the jobs in between
+	while (nMainStages > 0)
+	{
+		bool bRan = false;
+
+		for (int nStage = 0; nStage < (int)mStages.size(); ++nStage)
+		{
+			if (mStages[nStage]->mThread == STAGE_THREAD::MAIN && mStages[nStage]->mReady.exchange(false))
+			{
+				RunStage(nStage);
+
+				--nMainStages;
+				bRan = true;
+			}
+		}
+
+		if (!bRan && !jobSystem.TryRunJob())
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+void FrameGraph::Wait(JobSystem& jobSystem)
+{
+	jobSystem.Wait(mJobs);
+}
+
+void FrameGraph::WaitWithoutRunning(JobSystem& jobSystem)
+{
+	jobSystem.WaitWithoutRunning(mJobs);
+}
+
+int FrameGraph::GetStageCount() const
+{
+	return (int)mStages.size();
+}
+
+const char* FrameGraph::GetStageName(int nStage) const
+{
+	return mStages[nStage]->mName;
+}
+
+float FrameGraph::GetStageTime(int nStage) const
+{
+	return mStages[nStage]->mTime;
+}
+
+void FrameGraph::RunStage(int nStage)
+{
+	Stage& stage = *mStages[nStage];
+	PROFILE_SCOPE(stage.mName);
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	stage.mFunction();
+	stage.mTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	// Released from inside the stage's job, so the graph's job count can't drop to 0 before its dependents are queued
+	for (int nDependent : stage.mDependents)
+	{
+		if (--mStages[nDependent]->mRemainingDependencies == 0)
+		{
+			Release(nDependent);
+		}
+	}
+}
+
+void FrameGraph::Release(int nStage)
+{
+	if (mStages[nStage]->mThread == STAGE_THREAD::MAIN)
+	{
+		mStages[nStage]->mReady = true;
+		return;
+	}
+
+	mJobSystem->Run(mJobs, [this, nStage]() { RunStage(nStage); });
+}
+
+bool FrameGraph::IsAncestor(int nAncestor, int nStage) const
+{
+	for (int nDependency : mStages[nStage]->mDependencies)
+	{
+		if (nDependency == nAncestor || IsAncestor(nAncestor, nDependency))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool FrameGraph::IsBlocking(int nStage) const
+{
+	if (mStages[nStage]->mThread == STAGE_THREAD::MAIN)
+	{
+		return true;
+	}
+
+	for (int nOther = nStage + 1; nOther < (int)mStages.size(); ++nOther)
+	{
+		if (mStages[nOther]->mThread == STAGE_THREAD::MAIN && IsAncestor(nStage, nOther))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,235 @@
+#include "FrameScheduler.h"
+#include "Profiler.h"
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define FRAME_SCHEDULER_PAUSE() _mm_pause()
+#else
+#define FRAME_SCHEDULER_PAUSE() std::this_thread::yield()
+#endif
+
+// Length of each sleep while waiting, short enough to keep the overshoot estimate meaningful
+const double kSleepStep = 0.001;
+
+// Sleep overshoot assumed before any sleep has been measured
+const double kInitialSleepEstimate = 0.002;
+
+// Sleeps taking longer than this are outliers (the process was descheduled), they would wreck the estimate
+const double kMaxSleepSample = 0.010;
+
+static uint64_t GetSteadyClockCounter()
+{
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+FrameScheduler::FrameScheduler()
+{
+	mCounter = &GetSteadyClockCounter;
+	mFrequency = 1000000000;
+
+	mPacing = FRAME_PACING::VSYNC;
+	mTargetRate = 0.0f;
+	mFramePeriod = 0;
+	mNextFrame = 0;
+	mFrameStart = 0;
+	mStarted = false;
+
+	mSleepMean = kInitialSleepEstimate;
+	mSleepM2 = 0.0;
+	mSleepCount = 1;
+
+	mFrameTimeCount = 0;
+	mFrameTimeHead = 0;
+}
+
+FrameScheduler::~FrameScheduler()
+{
+
+}
+
+void FrameScheduler::Initialize(CounterFunction pCounter, uint64_t uFrequency)
+{
+	if (pCounter != nullptr && uFrequency > 0)
+	{
+		mCounter = pCounter;
+		mFrequency = uFrequency;
+	}
+	else
+	{
+		mCounter = &GetSteadyClockCounter;
+		mFrequency = 1000000000;
+	}
+
+	// The period is in ticks of the counter, which may just have changed
+	SetPacing(mPacing, mTargetRate);
+
+	mStarted = false;
+	mFrameTimeCount = 0;
+	mFrameTimeHead = 0;
+}
+
+void FrameScheduler::SetPacing(FRAME_PACING ePacing, float fTargetRate)
+{
+	mPacing = ePacing;
+	mTargetRate = fTargetRate;
+	mFramePeriod = (fTargetRate > 0.0f) ? (uint64_t)(mFrequency / fTargetRate) : 0;
+
+	// Starting the schedule over from the next frame
+	mNextFrame = 0;
+}
+
+FRAME_PACING FrameScheduler::GetPacing() const
+{
+	return mPacing;
+}
+
+int FrameScheduler::GetSwapInterval() const
+{
+	switch (mPacing)
+	{
+	case FRAME_PACING::VSYNC:
+		return 1;
+	case FRAME_PACING::ADAPTIVE:
+		return -1;
+	default:
+		return 0;
+	}
+}
+
+float FrameScheduler::BeginFrame()
+{
+	const uint64_t uNow = Now();
+	double fDeltaT = 0.0;
+
+	if (mStarted)
+	{
+		fDeltaT = TicksToSeconds((int64_t)(uNow - mFrameStart));
+
+		mFrameTimes[mFrameTimeHead] = fDeltaT;
+		mFrameTimeHead = (mFrameTimeHead + 1) % kFrameTimingWindow;
+		mFrameTimeCount = (mFrameTimeCount < kFrameTimingWindow) ? mFrameTimeCount + 1 : kFrameTimingWindow;
+	}
+
+	mFrameStart = uNow;
+	mStarted = true;
+
+	return (float)fDeltaT;
+}
+
+void FrameScheduler::EndFrame()
+{
+	if (mPacing != FRAME_PACING::FIXED || mFramePeriod == 0)
+	{
+		return;
+	}
+
+	const uint64_t uNow = Now();
+
+	// Frames are due at fixed points in time rather than a period after each other, so waiting never adds up drift
+	if (mNextFrame == 0)
+	{
+		mNextFrame = mFrameStart + mFramePeriod;
+	}
+	else
+	{
+		mNextFrame += mFramePeriod;
+	}
+
+	// After a hitch longer than a frame, starting over instead of rushing through frames to catch up
+	if (uNow > mNextFrame + mFramePeriod)
+	{
+		mNextFrame = uNow;
+		return;
+	}
+
+	PROFILE_SCOPE("WaitForNextFrame");
+	WaitUntil(mNextFrame);
+}
+
+FrameTimings FrameScheduler::GetTimings() const
+{
+	FrameTimings timings = { 0.0, 0.0, 0.0, 0.0, mFrameTimeCount };
+
+	if (mFrameTimeCount == 0)
+	{
+		return timings;
+	}
+
+	double fSum = 0.0;
+	timings.mMin = mFrameTimes[0];
+	timings.mMax = mFrameTimes[0];
+
+	for (int i = 0; i < mFrameTimeCount; ++i)
+	{
+		fSum += mFrameTimes[i];
+		timings.mMin = (mFrameTimes[i] < timings.mMin) ? mFrameTimes[i] : timings.mMin;
+		timings.mMax = (mFrameTimes[i] > timings.mMax) ? mFrameTimes[i] : timings.mMax;
+	}
+
+	const double fMean = fSum / mFrameTimeCount;
+	double fVariance = 0.0;
+
+	for (int i = 0; i < mFrameTimeCount; ++i)
+	{
+		fVariance += (mFrameTimes[i] - fMean) * (mFrameTimes[i] - fMean);
+	}
+
+	timings.mAverage = fMean * 1000.0;
+	timings.mMin *= 1000.0;
+	timings.mMax *= 1000.0;
+	timings.mJitter = sqrt(fVariance / mFrameTimeCount) * 1000.0;
+
+	return timings;
+}
+
+uint64_t FrameScheduler::Now() const
+{
+	return mCounter();
+}
+
+void FrameScheduler::WaitUntil(uint64_t uTarget)
+{
+	while (true)
+	{
+		const uint64_t uNow = Now();
+
+		if (uNow >= uTarget)
+		{
+			return;
+		}
+
+		const double fRemaining = TicksToSeconds((int64_t)(uTarget - uNow));
+		const double fEstimate = mSleepMean + sqrt(mSleepM2 / mSleepCount);
+
+		// Close enough that another sleep could overshoot, spinning the rest of the way
+		if (fRemaining <= fEstimate)
+		{
+			while (Now() < uTarget)
+			{
+				FRAME_SCHEDULER_PAUSE();
+			}
+			return;
+		}
+
+		std::this_thread::sleep_for(std::chrono::microseconds((int64_t)(kSleepStep * 1000000.0)));
+
+		// Welford's running mean and variance of how long the sleep really took
+		const double fSlept = TicksToSeconds((int64_t)(Now() - uNow));
+
+		if (fSlept < kMaxSleepSample)
+		{
+			++mSleepCount;
+			const double fDelta = fSlept - mSleepMean;
+			mSleepMean += fDelta / mSleepCount;
+			mSleepM2 += fDelta * (fSlept - mSleepMean);
+		}
+	}
+}
+
+double FrameScheduler::TicksToSeconds(int64_t nTicks) const
+{
+	return (double)nTicks / (double)mFrequency;
+}
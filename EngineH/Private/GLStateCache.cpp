@@ -0,0 +1,203 @@
+#include "GLStateCache.h"
+#include "GLEW.h"
+
+GLStateCache::GLStateCache()
+{
+	mStateChanges = 0;
+	mElidedStateChanges = 0;
+	mStateChangesLastFrame = 0;
+	mElidedStateChangesLastFrame = 0;
+	mProgramBinds = 0;
+	mVertexArrayBinds = 0;
+	mProgramBindsLastFrame = 0;
+	mVertexArrayBindsLastFrame = 0;
+
+	Invalidate();
+}
+
+GLStateCache::~GLStateCache()
+{
+
+}
+
+void GLStateCache::UseProgram(GLuint program)
+{
+	if (Update(mProgram, program))
+	{
+		++mProgramBinds;
+		glUseProgram(program);
+	}
+}
+
+void GLStateCache::BindVertexArray(GLuint vertexArray)
+{
+	if (Update(mVertexArray, vertexArray))
+	{
+		++mVertexArrayBinds;
+		glBindVertexArray(vertexArray);
+	}
+}
+
+void GLStateCache::BindBuffer(GLenum eTarget, GLuint buffer)
+{
+	GLuint* pShadow = nullptr;
+
+	switch (eTarget)
+	{
+	case GL_ARRAY_BUFFER:
+		pShadow = &mArrayBuffer;
+		break;
+	case GL_UNIFORM_BUFFER:
+		pShadow = &mUniformBuffer;
+		break;
+	default:
+		++mStateChanges;
+		glBindBuffer(eTarget, buffer);
+		return;
+	}
+
+	if (Update(*pShadow, buffer))
+	{
+		glBindBuffer(eTarget, buffer);
+	}
+}
+
+void GLStateCache::BindBufferBase(GLenum eTarget, GLuint uIndex, GLuint buffer)
+{
+	// Indexed bindings aren't shadowed, only the generic binding they overwrite is
+	++mStateChanges;
+	glBindBufferBase(eTarget, uIndex, buffer);
+
+	if (eTarget == GL_ARRAY_BUFFER)
+	{
+		mArrayBuffer = buffer;
+	}
+	else if (eTarget == GL_UNIFORM_BUFFER)
+	{
+		mUniformBuffer = buffer;
+	}
+}
+
+void GLStateCache::BindTexture2D(int nUnit, GLuint texture)
+{
+	if (nUnit >= kCachedTextureUnits)
+	{
+		mActiveTextureUnit = kUnknown;
+		mStateChanges += 2;
+		glActiveTexture(GL_TEXTURE0 + nUnit);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		return;
+	}
+
+	// Only switching the active unit when the texture on it actually has to change
+	if (mTextures[nUnit] == texture)
+	{
+		++mElidedStateChanges;
+		return;
+	}
+
+	if (Update(mActiveTextureUnit, (GLuint)nUnit))
+	{
+		glActiveTexture(GL_TEXTURE0 + nUnit);
+	}
+
+	Update(mTextures[nUnit], texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+}
+
+void GLStateCache::SetCapability(GLenum eCapability, bool bEnabled)
+{
+	GLuint* pShadow = nullptr;
+
+	switch (eCapability)
+	{
+	case GL_DEPTH_TEST:
+		pShadow = &mDepthTest;
+		break;
+	case GL_BLEND:
+		pShadow = &mBlend;
+		break;
+	default:
+		break;
+	}
+
+	if (pShadow != nullptr && !Update(*pShadow, bEnabled ? 1 : 0))
+	{
+		return;
+	}
+
+	if (pShadow == nullptr)
+	{
+		++mStateChanges;
+	}
+
+	if (bEnabled)
+	{
+		glEnable(eCapability);
+	}
+	else
+	{
+		glDisable(eCapability);
+	}
+}
+
+void GLStateCache::Invalidate()
+{
+	mProgram = kUnknown;
+	mVertexArray = kUnknown;
+	mArrayBuffer = kUnknown;
+	mUniformBuffer = kUnknown;
+	mActiveTextureUnit = kUnknown;
+	mDepthTest = kUnknown;
+	mBlend = kUnknown;
+
+	for (int i = 0; i < kCachedTextureUnits; ++i)
+	{
+		mTextures[i] = kUnknown;
+	}
+}
+
+void GLStateCache::EndFrame()
+{
+	mStateChangesLastFrame = mStateChanges;
+	mElidedStateChangesLastFrame = mElidedStateChanges;
+	mProgramBindsLastFrame = mProgramBinds;
+	mVertexArrayBindsLastFrame = mVertexArrayBinds;
+	mStateChanges = 0;
+	mElidedStateChanges = 0;
+	mProgramBinds = 0;
+	mVertexArrayBinds = 0;
+}
+
+int GLStateCache::GetStateChangesLastFrame() const
+{
+	return mStateChangesLastFrame;
+}
+
+int GLStateCache::GetElidedStateChangesLastFrame() const
+{
+	return mElidedStateChangesLastFrame;
+}
+
+int GLStateCache::GetProgramBindsLastFrame() const
+{
+	return mProgramBindsLastFrame;
+}
+
+int GLStateCache::GetVertexArrayBindsLastFrame() const
+{
+	return mVertexArrayBindsLastFrame;
+}
+
+bool GLStateCache::Update(GLuint& shadow, GLuint value)
+{
+	if (shadow == value)
+	{
+		++mElidedStateChanges;
+		return false;
+	}
+
+	shadow = value;
+	++mStateChanges;
+	return true;
+}
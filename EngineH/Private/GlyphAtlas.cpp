@@ -0,0 +1,101 @@
+#include "GlyphAtlas.h"
+#include <cstring>
+
+// Empty pixels left between bitmaps, so filtering never samples a neighbouring glyph
+const int kGlyphPadding = 1;
+
+GlyphAtlas::GlyphAtlas()
+{
+
+}
+
+GlyphAtlas::~GlyphAtlas()
+{
+
+}
+
+bool GlyphAtlas::Allocate(int nWidth, int nHeight, int& nOutPage, int& nOutX, int& nOutY)
+{
+	const int nPaddedWidth = nWidth + kGlyphPadding;
+	const int nPaddedHeight = nHeight + kGlyphPadding;
+
+	if (nPaddedWidth > kGlyphAtlasPageSize || nPaddedHeight > kGlyphAtlasPageSize)
+	{
+		return false;
+	}
+
+	if (mPages.empty())
+	{
+		AddPage();
+	}
+
+	Page* pPage = &mPages.back();
+
+	// Out of room on this shelf, the next one starts below its tallest bitmap
+	if (pPage->mShelfX + nPaddedWidth > kGlyphAtlasPageSize)
+	{
+		pPage->mShelfY += pPage->mShelfHeight;
+		pPage->mShelfX = kGlyphPadding;
+		pPage->mShelfHeight = 0;
+	}
+
+	// Out of room on this page
+	if (pPage->mShelfY + nPaddedHeight > kGlyphAtlasPageSize)
+	{
+		AddPage();
+		pPage = &mPages.back();
+	}
+
+	nOutPage = (int)mPages.size() - 1;
+	nOutX = pPage->mShelfX;
+	nOutY = pPage->mShelfY;
+
+	pPage->mShelfX += nPaddedWidth;
+	pPage->mShelfHeight = (nPaddedHeight > pPage->mShelfHeight) ? nPaddedHeight : pPage->mShelfHeight;
+
+	return true;
+}
+
+void GlyphAtlas::Write(int nPage, int nX, int nY, int nWidth, int nHeight, const unsigned char* pPixels)
+{
+	Page& page = mPages[nPage];
+
+	for (int nRow = 0; nRow < nHeight; ++nRow)
+	{
+		memcpy(&page.mPixels[(nY + nRow) * kGlyphAtlasPageSize + nX], pPixels + nRow * nWidth, nWidth);
+	}
+
+	page.mDirty = true;
+}
+
+int GlyphAtlas::GetPageCount() const
+{
+	return (int)mPages.size();
+}
+
+const unsigned char* GlyphAtlas::GetPagePixels(int nPage) const
+{
+	return mPages[nPage].mPixels.data();
+}
+
+bool GlyphAtlas::IsPageDirty(int nPage) const
+{
+	return mPages[nPage].mDirty;
+}
+
+void GlyphAtlas::ClearDirty(int nPage)
+{
+	mPages[nPage].mDirty = false;
+}
+
+void GlyphAtlas::AddPage()
+{
+	Page page;
+	page.mPixels.assign(kGlyphAtlasPageSize * kGlyphAtlasPageSize, 0);
+	page.mShelfY = kGlyphPadding;
+	page.mShelfHeight = 0;
+	page.mShelfX = kGlyphPadding;
+	page.mDirty = true;
+
+	mPages.push_back(page);
+}
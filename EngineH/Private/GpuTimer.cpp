@@ -0,0 +1,223 @@
+#include "GpuTimer.h"
+#include "GLEW.h"
+#include <chrono>
+#include <utility>
+
+const char* kGpuPassNames[(int)GPU_PASS::COUNT] = { "Clear", "Upload", "Box", "Circle", "Line", "Text", "Swap" };
+
+GpuTimer::GpuTimer()
+{
+	mSupported = false;
+	mFrameOpen = false;
+	mFrame = 0;
+	mReadFrame = 0;
+	mLastMarkTime = 0.0;
+	mDroppedFrames = 0;
+
+	for (int i = 0; i < kGpuTimerFrames; ++i)
+	{
+		mFrames[i].mMarkCount = 0;
+		mFrames[i].mFrame = 0;
+		mFrames[i].mPending = false;
+	}
+
+	mLatest.mSupported = false;
+	mLatest.mFrame = 0;
+	mLatest.mCpuMilliseconds = 0.0f;
+	mLatest.mGpuMilliseconds = 0.0f;
+	mLatest.mDroppedFrames = 0;
+
+	for (int i = 0; i < (int)GPU_PASS::COUNT; ++i)
+	{
+		mLatest.mPasses[i].mCpuMilliseconds = 0.0f;
+		mLatest.mPasses[i].mGpuMilliseconds = 0.0f;
+		mLatest.mPasses[i].mBatches = 0;
+	}
+}
+
+GpuTimer::~GpuTimer()
+{
+	// The queries are released along with the context
+}
+
+bool GpuTimer::Initialize()
+{
+	// Core since 3.3, and ARB_timer_query before that
+	mSupported = (GLEW_VERSION_3_3 || GLEW_ARB_timer_query);
+
+	if (mSupported)
+	{
+		for (int i = 0; i < kGpuTimerFrames; ++i)
+		{
+			glGenQueries(kMaxGpuMarks + 1, mFrames[i].mQueries);
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(mMutex);
+	mLatest.mSupported = mSupported;
+
+	return mSupported;
+}
+
+bool GpuTimer::IsSupported() const
+{
+	return mSupported;
+}
+
+void GpuTimer::BeginFrame()
+{
+	if (!mSupported)
+	{
+		return;
+	}
+
+	ReadBackFrames();
+
+	FrameQueries& frame = mFrames[mFrame % kGpuTimerFrames];
+
+	// Still not back after going all the way around the ring, waiting on it would stall the frame
+	if (frame.mPending)
+	{
+		frame.mPending = false;
+		++mDroppedFrames;
+	}
+
+	frame.mMarkCount = 0;
+	frame.mFrame = mFrame;
+
+	glQueryCounter(frame.mQueries[0], GL_TIMESTAMP);
+	mLastMarkTime = NowMilliseconds();
+	mFrameOpen = true;
+}
+
+void GpuTimer::Mark(GPU_PASS ePass, int nCount)
+{
+	if (!mFrameOpen)
+	{
+		return;
+	}
+
+	FrameQueries& frame = mFrames[mFrame % kGpuTimerFrames];
+
+	// Out of marks the rest of the frame's batches end up in its swap
+	if (frame.mMarkCount >= kMaxGpuMarks - 1 && ePass != GPU_PASS::SWAP)
+	{
+		return;
+	}
+
+	const double dNow = NowMilliseconds();
+
+	PassMark& mark = frame.mMarks[frame.mMarkCount];
+	mark.mPass = ePass;
+	mark.mCount = nCount;
+	mark.mCpuMilliseconds = (float)(dNow - mLastMarkTime);
+
+	glQueryCounter(frame.mQueries[frame.mMarkCount + 1], GL_TIMESTAMP);
+	++frame.mMarkCount;
+
+	mLastMarkTime = dNow;
+}
+
+void GpuTimer::EndFrame()
+{
+	if (!mFrameOpen)
+	{
+		return;
+	}
+
+	mFrames[mFrame % kGpuTimerFrames].mPending = true;
+	mFrameOpen = false;
+	++mFrame;
+}
+
+GpuTimings GpuTimer::GetTimings() const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mLatest;
+}
+
+const char* GpuTimer::GetPassName(GPU_PASS ePass)
+{
+	return kGpuPassNames[(int)ePass];
+}
+
+void GpuTimer::ReadBackFrames()
+{
+	for (; mReadFrame < mFrame; ++mReadFrame)
+	{
+		FrameQueries& frame = mFrames[mReadFrame % kGpuTimerFrames];
+
+		if (!frame.mPending || frame.mFrame != mReadFrame)
+		{
+			continue;
+		}
+
+		// Timestamps are written in order, once the frame's last one is there all of them are
+		GLuint uAvailable = GL_FALSE;
+		glGetQueryObjectuiv(frame.mQueries[frame.mMarkCount], GL_QUERY_RESULT_AVAILABLE, &uAvailable);
+
+		if (uAvailable == GL_FALSE)
+		{
+			break;
+		}
+
+		ReadBackFrame(frame);
+		frame.mPending = false;
+	}
+}
+
+void GpuTimer::ReadBackFrame(FrameQueries& frame)
+{
+	GpuTimings timings;
+	timings.mSupported = true;
+	timings.mFrame = frame.mFrame;
+	timings.mCpuMilliseconds = 0.0f;
+	timings.mGpuMilliseconds = 0.0f;
+	timings.mDroppedFrames = mDroppedFrames;
+
+	for (int i = 0; i < (int)GPU_PASS::COUNT; ++i)
+	{
+		timings.mPasses[i].mCpuMilliseconds = 0.0f;
+		timings.mPasses[i].mGpuMilliseconds = 0.0f;
+		timings.mPasses[i].mBatches = 0;
+	}
+
+	GLuint64 uPrevious = 0;
+	glGetQueryObjectui64v(frame.mQueries[0], GL_QUERY_RESULT, &uPrevious);
+
+	timings.mBatches.reserve(frame.mMarkCount);
+
+	for (int i = 0; i < frame.mMarkCount; ++i)
+	{
+		const PassMark& mark = frame.mMarks[i];
+
+		GLuint64 uTimestamp = 0;
+		glGetQueryObjectui64v(frame.mQueries[i + 1], GL_QUERY_RESULT, &uTimestamp);
+
+		// Timestamps are in nanoseconds
+		GpuBatchTiming batch;
+		batch.mPass = mark.mPass;
+		batch.mCount = mark.mCount;
+		batch.mCpuMilliseconds = mark.mCpuMilliseconds;
+		batch.mGpuMilliseconds = (uTimestamp > uPrevious) ? (float)((uTimestamp - uPrevious) / 1.0e6) : 0.0f;
+		timings.mBatches.push_back(batch);
+
+		GpuPassTiming& pass = timings.mPasses[(int)mark.mPass];
+		pass.mCpuMilliseconds += batch.mCpuMilliseconds;
+		pass.mGpuMilliseconds += batch.mGpuMilliseconds;
+		++pass.mBatches;
+
+		timings.mCpuMilliseconds += batch.mCpuMilliseconds;
+		timings.mGpuMilliseconds += batch.mGpuMilliseconds;
+
+		uPrevious = uTimestamp;
+	}
+
+	std::lock_guard<std::mutex> lock(mMutex);
+	mLatest = std::move(timings);
+}
+
+double GpuTimer::NowMilliseconds() const
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
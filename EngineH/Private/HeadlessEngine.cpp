@@ -0,0 +1,115 @@
+#include "HeadlessEngine.h"
+#include "Profiler.h"
+#include <chrono>
+#include <cstring>
+
+HeadlessEngine::HeadlessEngine()
+{
+	mCommandCount = 0;
+	mCulledCount = 0;
+	mStreamedBytes = 0;
+}
+
+HeadlessEngine::~HeadlessEngine()
+{
+
+}
+
+void HeadlessEngine::OnFrame(float fDeltaT)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	mCulledCount = RecordFrame(fDeltaT);
+
+	FlushBatches();
+
+	UpdateStats(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count());
+}
+
+void HeadlessEngine::FlushBatches()
+{
+	PROFILE_FUNCTION();
+
+	mCommandCount = mCommandBuffer.GetCommandCount();
+
+	mFrameBatcher.Build(mCommandBuffer, mFonts, mGlyphAtlas.GetPageCount(), mCameraZoom);
+
+	const RenderBatch& frameBatch = mFrameBatcher.GetBatch();
+
+	// Copying the frame like EngineH copies it into its mapped buffers, so the cost of the copy is part of the measurements
+	const size_t uInstanceBytes = frameBatch.GetInstancesSizeInBytes();
+	const size_t uVertexBytes = frameBatch.GetVerticesSizeInBytes();
+
+	mStreamedBytes = uInstanceBytes + uVertexBytes;
+
+	if (mStream.size() < mStreamedBytes)
+	{
+		mStream.resize(mStreamedBytes);
+	}
+
+	if (uInstanceBytes > 0)
+	{
+		memcpy(mStream.data(), frameBatch.GetInstances(), uInstanceBytes);
+	}
+
+	if (uVertexBytes > 0)
+	{
+		memcpy(mStream.data() + uInstanceBytes, frameBatch.GetVertices(), uVertexBytes);
+	}
+
+	mCommandBuffer.Clear();
+}
+
+void HeadlessEngine::UpdateStats(float fFrameMilliseconds)
+{
+	const RenderBatch& frameBatch = mFrameBatcher.GetBatch();
+
+	++mStats.mFrame;
+	mStats.mCommands = mCommandCount;
+	mStats.mCulledCommands = mCulledCount;
+	mStats.mDrawCalls = (int)mFrameBatcher.GetDrawRanges().size();
+	mStats.mInstances = frameBatch.GetInstanceCount();
+	mStats.mVertices = 4 * frameBatch.GetInstanceCount() + frameBatch.GetVertexCount();
+	mStats.mUploadedBytes = mStreamedBytes;
+	mStats.mProgramBinds = 0;
+	mStats.mVertexArrayBinds = 0;
+
+	// EngineH binds a program whenever it differs from the previous draw's, and the lines and text share a vertex array
+	SHADER_PROGRAM ePreviousProgram = SHADER_PROGRAM::COUNT;
+	int nPreviousVertexArray = -1;
+
+	for (const DrawRange& range : mFrameBatcher.GetDrawRanges())
+	{
+		const int nVertexArray = (range.mProgram == SHADER_PROGRAM::LINE || range.mProgram == SHADER_PROGRAM::TEXT) ? 1 : 0;
+
+		mStats.mProgramBinds += (range.mProgram != ePreviousProgram) ? 1 : 0;
+		mStats.mVertexArrayBinds += (nVertexArray != nPreviousVertexArray) ? 1 : 0;
+
+		ePreviousProgram = range.mProgram;
+		nPreviousVertexArray = nVertexArray;
+	}
+
+	mStats.mFrameMilliseconds = fFrameMilliseconds;
+
+	mStatsWriter.Write(mStats);
+}
+
+int HeadlessEngine::GetCommandCountLastFrame() const
+{
+	return mCommandCount;
+}
+
+int HeadlessEngine::GetDrawCountLastFrame() const
+{
+	return (int)mFrameBatcher.GetDrawRanges().size();
+}
+
+size_t HeadlessEngine::GetStreamedBytesLastFrame() const
+{
+	return mStreamedBytes;
+}
+
+const std::vector<DrawRange>& HeadlessEngine::GetDrawRanges() const
+{
+	return mFrameBatcher.GetDrawRanges();
+}
@@ -0,0 +1,314 @@
+#include "JobSystem.h"
+#include "Profiler.h"
+#include <cstdio>
+
+// Times a worker looks for jobs again before going to sleep, waking up costs a lot more than a few yields
+const int kWorkerSpinCount = 64;
+
+// Ranges ParallelFor aims to give every thread when it picks the grain size, so threads that finish early can steal
+const int kRangesPerThread = 4;
+
+// The job system a thread belongs to, and its deque there
+struct JobThreadInfo
+{
+	uint64_t mSystemID;
+	int mQueue;
+};
+
+static thread_local JobThreadInfo tJobThread = { 0, 0 };
+
+static std::atomic<uint64_t> gNextJobSystemID(1);
+
+JobGroup::JobGroup()
+{
+	mPending = 0;
+}
+
+JobGroup::~JobGroup()
+{
+
+}
+
+bool JobGroup::IsDone() const
+{
+	return mPending == 0;
+}
+
+JobSystem::JobSystem()
+{
+	mID = gNextJobSystemID++;
+	mQueuedJobs = 0;
+	mShutdown = false;
+
+	// Until there are workers, everything runs on the calling thread's deque
+	mQueues.emplace_back(new WorkQueue());
+}
+
+JobSystem::~JobSystem()
+{
+	Shutdown();
+}
+
+void JobSystem::Initialize(int nWorkerThreads)
+{
+	Shutdown();
+
+	if (nWorkerThreads < 0)
+	{
+		const int nHardwareThreads = (int)std::thread::hardware_concurrency();
+		nWorkerThreads = (nHardwareThreads > 1) ? nHardwareThreads - 1 : 0;
+	}
+
+	mShutdown = false;
+	mQueues.clear();
+
+	for (int i = 0; i < nWorkerThreads + 1; ++i)
+	{
+		mQueues.emplace_back(new WorkQueue());
+	}
+
+	for (int i = 0; i < nWorkerThreads; ++i)
+	{
+		mWorkers.emplace_back(&JobSystem::WorkerLoop, this, i + 1);
+	}
+}
+
+void JobSystem::Shutdown()
+{
+	if (!mWorkers.empty())
+	{
+		{
+			std::lock_guard<std::mutex> lock(mSleepMutex);
+			mShutdown = true;
+		}
+
+		mJobQueued.notify_all();
+
+		for (std::thread& worker : mWorkers)
+		{
+			worker.join();
+		}
+
+		mWorkers.clear();
+	}
+
+	// Dropping the jobs left would leave their groups pending forever, and the jobs parked on them, so they run here instead
+	while (TryRunJob())
+	{
+	}
+}
+
+void JobSystem::Run(JobGroup& group, std::function<void()> job, JobGroup* pDependency)
+{
+	++group.mPending;
+
+	if (pDependency != nullptr)
+	{
+		std::lock_guard<std::mutex> lock(pDependency->mMutex);
+
+		// Parked on the dependency, whichever thread finishes its last job pushes it
+		if (pDependency->mPending > 0)
+		{
+			pDependency->mContinuations.emplace_back(std::move(job), &group);
+			return;
+		}
+	}
+
+	Job newJob;
+	newJob.mFunction = std::move(job);
+	newJob.mGroup = &group;
+
+	Push(newJob);
+}
+
+void JobSystem::Wait(JobGroup& group)
+{
+	while (group.mPending > 0)
+	{
+		if (!TryRunJob())
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	// The thread that finished the last job may still be unlocking the group, which the caller is about to be free to destroy
+	std::lock_guard<std::mutex> lock(group.mMutex);
+}
+
+void JobSystem::WaitWithoutRunning(JobGroup& group)
+{
+	if (mWorkers.empty())
+	{
+		Wait(group);
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(group.mMutex);
+	group.mDone.wait(lock, [&group] { return group.mPending == 0; });
+}
+
+void JobSystem::ParallelFor(int nCount, int nGrainSize, const std::function<void(int nBegin, int nEnd)>& function)
+{
+	if (nCount <= 0)
+	{
+		return;
+	}
+
+	if (nGrainSize <= 0)
+	{
+		nGrainSize = nCount / (GetThreadCount() * kRangesPerThread);
+		nGrainSize = (nGrainSize > 0) ? nGrainSize : 1;
+	}
+
+	JobGroup group;
+
+	for (int nBegin = 0; nBegin < nCount; nBegin += nGrainSize)
+	{
+		const int nEnd = (nCount - nBegin > nGrainSize) ? nBegin + nGrainSize : nCount;
+
+		Run(group, [&function, nBegin, nEnd]() { function(nBegin, nEnd); });
+	}
+
+	Wait(group);
+}
+
+int JobSystem::GetThreadCount() const
+{
+	return (int)mWorkers.size() + 1;
+}
+
+void JobSystem::Push(Job& job)
+{
+	WorkQueue& queue = *mQueues[GetQueueIndex()];
+
+	{
+		std::lock_guard<std::mutex> lock(queue.mMutex);
+		queue.mJobs.push_back(std::move(job));
+	}
+
+	++mQueuedJobs;
+
+	// Taking the lock orders this with a worker that checked for jobs and is about to sleep, so the wake up isn't lost
+	{
+		std::lock_guard<std::mutex> lock(mSleepMutex);
+	}
+
+	mJobQueued.notify_one();
+}
+
+bool JobSystem::TryRunJob()
+{
+	const int nQueues = (int)mQueues.size();
+	const int nOwnQueue = GetQueueIndex();
+
+	Job job;
+	bool bFound = false;
+
+	// Newest own job first, it is the most likely to still be in the cache
+	{
+		WorkQueue& queue = *mQueues[nOwnQueue];
+		std::lock_guard<std::mutex> lock(queue.mMutex);
+
+		if (!queue.mJobs.empty())
+		{
+			job = std::move(queue.mJobs.back());
+			queue.mJobs.pop_back();
+			bFound = true;
+		}
+	}
+
+	// Oldest job of someone else's otherwise, usually the biggest piece of work they have left
+	for (int i = 1; i < nQueues && !bFound; ++i)
+	{
+		WorkQueue& queue = *mQueues[(nOwnQueue + i) % nQueues];
+		std::lock_guard<std::mutex> lock(queue.mMutex);
+
+		if (!queue.mJobs.empty())
+		{
+			job = std::move(queue.mJobs.front());
+			queue.mJobs.pop_front();
+			bFound = true;
+		}
+	}
+
+	if (!bFound)
+	{
+		return false;
+	}
+
+	--mQueuedJobs;
+	Execute(job);
+
+	return true;
+}
+
+void JobSystem::Execute(Job& job)
+{
+	job.mFunction();
+
+	JobGroup& group = *job.mGroup;
+	std::vector<std::pair<std::function<void()>, JobGroup*>> continuations;
+
+	{
+		std::lock_guard<std::mutex> lock(group.mMutex);
+
+		if (--group.mPending == 0)
+		{
+			continuations.swap(group.mContinuations);
+			group.mDone.notify_all();
+		}
+	}
+
+	// Jobs that were waiting for this group are free to run now
+	for (std::pair<std::function<void()>, JobGroup*>& continuation : continuations)
+	{
+		Job continuationJob;
+		continuationJob.mFunction = std::move(continuation.first);
+		continuationJob.mGroup = continuation.second;
+
+		Push(continuationJob);
+	}
+}
+
+void JobSystem::WorkerLoop(int nQueue)
+{
+	tJobThread.mSystemID = mID;
+	tJobThread.mQueue = nQueue;
+
+	char szName[32];
+	snprintf(szName, sizeof(szName), "Worker %d", nQueue);
+	Profiler::SetThreadName(szName);
+
+	while (true)
+	{
+		bool bRan = false;
+
+		for (int i = 0; i < kWorkerSpinCount && !bRan; ++i)
+		{
+			bRan = TryRunJob();
+
+			if (!bRan)
+			{
+				std::this_thread::yield();
+			}
+		}
+
+		if (bRan)
+		{
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(mSleepMutex);
+		mJobQueued.wait(lock, [this] { return mQueuedJobs > 0 || mShutdown; });
+
+		if (mShutdown)
+		{
+			return;
+		}
+	}
+}
+
+int JobSystem::GetQueueIndex() const
+{
+	return (tJobThread.mSystemID == mID) ? tJobThread.mQueue : 0;
+}
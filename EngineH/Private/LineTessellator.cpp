@@ -0,0 +1,201 @@
+#include "LineTessellator.h"
+#include "RenderBatch.h"
+
+// How far (in pixels) a circle outline may stray from the true circle
+const float kCircleTolerance = 0.25f;
+const int kMinCircleSegments = 8;
+const int kMaxCircleSegments = 256;
+
+// A miter longer than this many half widths is replaced by a bevel
+const float kMiterLimit = 4.0f;
+
+const float kPi = 3.14159265358979f;
+
+LineTessellator::LineTessellator()
+{
+	mPoints.reserve(kMaxCircleSegments);
+}
+
+LineTessellator::~LineTessellator()
+{
+
+}
+
+void LineTessellator::AddLine(RenderBatch& batch, const exVector2& v2P1, const exVector2& v2P2, float fWidth, const exColor& color, int nLayer)
+{
+	AddSegment(batch, v2P1, v2P2, fWidth * 0.5f, color, nLayer);
+}
+
+void LineTessellator::AddLineBox(RenderBatch& batch, const exVector2& v2P1, const exVector2& v2P2, float fWidth, const exColor& color, int nLayer)
+{
+	const exVector2 corners[4] = {
+		{ v2P1.x, v2P1.y },
+		{ v2P2.x, v2P1.y },
+		{ v2P2.x, v2P2.y },
+		{ v2P1.x, v2P2.y }
+	};
+
+	AddPolyline(batch, corners, 4, true, fWidth, color, nLayer);
+}
+
+void LineTessellator::AddLineCircle(RenderBatch& batch, const exVector2& v2Center, float fRadius, float fScreenScale, float fWidth, const exColor& color, int nLayer)
+{
+	const int nSegments = GetCircleSegmentCount(fRadius * fScreenScale);
+
+	// Rotating a single offset around the center, so there is only one sin and cos per circle
+	const float fStep = 2.0f * kPi / nSegments;
+	const float fCos = cosf(fStep);
+	const float fSin = sinf(fStep);
+
+	float x = fRadius;
+	float y = 0.0f;
+
+	mPoints.clear();
+
+	for (int i = 0; i < nSegments; ++i)
+	{
+		mPoints.push_back(exVector2(v2Center.x + x, v2Center.y + y));
+
+		float fRotatedX = x * fCos - y * fSin;
+		y = x * fSin + y * fCos;
+		x = fRotatedX;
+	}
+
+	AddPolyline(batch, mPoints.data(), nSegments, true, fWidth, color, nLayer);
+}
+
+void LineTessellator::AddPolyline(RenderBatch& batch, const exVector2* pPoints, int nCount, bool bClosed, float fWidth, const exColor& color, int nLayer)
+{
+	if (nCount < 2)
+	{
+		return;
+	}
+
+	const float fHalfWidth = fWidth * 0.5f;
+	const int nSegments = bClosed ? nCount : nCount - 1;
+
+	for (int i = 0; i < nSegments; ++i)
+	{
+		AddSegment(batch, pPoints[i], pPoints[(i + 1) % nCount], fHalfWidth, color, nLayer);
+	}
+
+	// Open polylines have no join at their two ends
+	const int nFirstJoin = bClosed ? 0 : 1;
+	const int nLastJoin = bClosed ? nCount - 1 : nCount - 2;
+
+	for (int i = nFirstJoin; i <= nLastJoin; ++i)
+	{
+		const exVector2& v2Previous = pPoints[(i + nCount - 1) % nCount];
+		const exVector2& v2Next = pPoints[(i + 1) % nCount];
+
+		AddJoin(batch, v2Previous, pPoints[i], v2Next, fHalfWidth, color, nLayer);
+	}
+}
+
+int LineTessellator::GetCircleSegmentCount(float fScreenRadius)
+{
+	if (fScreenRadius <= kCircleTolerance)
+	{
+		return kMinCircleSegments;
+	}
+
+	// Each segment spans the angle over which a chord stays within the tolerance of the arc
+	float fHalfAngle = acosf(1.0f - kCircleTolerance / fScreenRadius);
+	int nSegments = (int)ceilf(kPi / fHalfAngle);
+
+	return (nSegments < kMinCircleSegments) ? kMinCircleSegments : ((nSegments > kMaxCircleSegments) ? kMaxCircleSegments : nSegments);
+}
+
+void LineTessellator::AddSegment(RenderBatch& batch, const exVector2& v2P1, const exVector2& v2P2, float fHalfWidth, const exColor& color, int nLayer)
+{
+	float dx = v2P2.x - v2P1.x;
+	float dy = v2P2.y - v2P1.y;
+	float fLength = sqrtf(dx * dx + dy * dy);
+
+	if (fLength <= 0.0f)
+	{
+		return;
+	}
+
+	// Normal of the segment, scaled to half the width
+	float nx = -dy / fLength * fHalfWidth;
+	float ny = dx / fLength * fHalfWidth;
+
+	exVector2 a(v2P1.x + nx, v2P1.y + ny);
+	exVector2 b(v2P1.x - nx, v2P1.y - ny);
+	exVector2 c(v2P2.x + nx, v2P2.y + ny);
+	exVector2 d(v2P2.x - nx, v2P2.y - ny);
+
+	batch.AddVertex(a, color, nLayer);
+	batch.AddVertex(b, color, nLayer);
+	batch.AddVertex(c, color, nLayer);
+
+	batch.AddVertex(c, color, nLayer);
+	batch.AddVertex(b, color, nLayer);
+	batch.AddVertex(d, color, nLayer);
+}
+
+void LineTessellator::AddJoin(RenderBatch& batch, const exVector2& v2Previous, const exVector2& v2Point, const exVector2& v2Next, float fHalfWidth, const exColor& color, int nLayer)
+{
+	exVector2 d0(v2Point.x - v2Previous.x, v2Point.y - v2Previous.y);
+	exVector2 d1(v2Next.x - v2Point.x, v2Next.y - v2Point.y);
+
+	float fLength0 = d0.Magnitude();
+	float fLength1 = d1.Magnitude();
+
+	if (fLength0 <= 0.0f || fLength1 <= 0.0f)
+	{
+		return;
+	}
+
+	d0 = d0 * (1.0f / fLength0);
+	d1 = d1 * (1.0f / fLength1);
+
+	// Nothing to fill when the two segments carry straight on
+	float fCross = d0.x * d1.y - d0.y * d1.x;
+
+	if (fCross > -1e-4f && fCross < 1e-4f)
+	{
+		return;
+	}
+
+	// The gap between the two segment quads opens on the outside of the turn, the inside is already covered by their overlap
+	float fSide = (fCross > 0.0f) ? -1.0f : 1.0f;
+
+	exVector2 n0(-d0.y * fSide, d0.x * fSide);
+	exVector2 n1(-d1.y * fSide, d1.x * fSide);
+
+	exVector2 a(v2Point.x + n0.x * fHalfWidth, v2Point.y + n0.y * fHalfWidth);
+	exVector2 b(v2Point.x + n1.x * fHalfWidth, v2Point.y + n1.y * fHalfWidth);
+
+	// The miter points halfway between the two normals, far enough to meet both outer edges
+	exVector2 miter(n0.x + n1.x, n0.y + n1.y);
+	float fMiterLength = miter.Magnitude();
+
+	if (fMiterLength > 0.0f)
+	{
+		miter = miter * (1.0f / fMiterLength);
+
+		float fCosine = exVector2::DotProduct(miter, n0);
+		float fExtent = (fCosine > 0.0f) ? 1.0f / fCosine : kMiterLimit + 1.0f;
+
+		if (fExtent <= kMiterLimit)
+		{
+			exVector2 m(v2Point.x + miter.x * fExtent * fHalfWidth, v2Point.y + miter.y * fExtent * fHalfWidth);
+
+			batch.AddVertex(v2Point, color, nLayer);
+			batch.AddVertex(a, color, nLayer);
+			batch.AddVertex(m, color, nLayer);
+
+			batch.AddVertex(v2Point, color, nLayer);
+			batch.AddVertex(m, color, nLayer);
+			batch.AddVertex(b, color, nLayer);
+			return;
+		}
+	}
+
+	// Bevel
+	batch.AddVertex(v2Point, color, nLayer);
+	batch.AddVertex(a, color, nLayer);
+	batch.AddVertex(b, color, nLayer);
+}
@@ -0,0 +1,485 @@
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+#include "Logger.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// How long the background thread sleeps between looking for messages, in milliseconds
+const int kLogFlushInterval = 10;
+
+// Largest single argument the formatter writes, longer strings are still cut at kMaxLogStringLength
+const int kLogArgumentTextSize = kMaxLogStringLength + 64;
+
+// A message read back from a thread's ring, formatted and waiting to be written in time order with the other threads' ones
+struct LogLine
+{
+	int64_t mTime;
+	LOG_LEVEL mLevel;
+	std::string mText;
+};
+
+// Everything the logger shares between threads, never destroyed so messages logged while the program exits still have
+// somewhere to go, Shutdown() is what stops the thread
+struct LoggerState
+{
+	std::mutex mMutex;
+	std::condition_variable mWake;
+	std::condition_variable mFlushed;
+	std::vector<std::unique_ptr<LogThreadBuffer>> mBuffers;
+	std::thread mThread;
+	bool mStarted;
+	bool mShutdown;
+	uint64_t mFlushRequests;
+	uint64_t mFlushesDone;
+	uint64_t mDropped;
+
+	// Only touched while draining, which holds mDrainMutex
+	std::mutex mDrainMutex;
+	FILE* mFile;
+	std::vector<LogLine> mLines;
+};
+
+static LoggerState* AccessLoggerState()
+{
+	static LoggerState* pState = []()
+	{
+		LoggerState* pNewState = new LoggerState();
+		pNewState->mStarted = false;
+		pNewState->mShutdown = false;
+		pNewState->mFlushRequests = 0;
+		pNewState->mFlushesDone = 0;
+		pNewState->mDropped = 0;
+		pNewState->mFile = nullptr;
+		return pNewState;
+	}();
+
+	return pState;
+}
+
+// Set once the background thread is gone, every message is then written by the thread logging it
+static std::atomic<bool> gLoggerSynchronous(false);
+
+// Stops the thread on exit, once everything constructed after the logger has been destroyed
+static struct LoggerShutdown
+{
+	~LoggerShutdown()
+	{
+		Logger::Shutdown();
+	}
+} gLoggerShutdown;
+
+// The printf conversion for the argument, with the length modifier its stored type needs
+static void FormatArgument(std::string& text, const std::string& spec, char cConversion, LOG_ARGUMENT eType, const unsigned char*& pArgument)
+{
+	char szText[kLogArgumentTextSize];
+	std::string format(spec);
+
+	if (eType == LOG_ARGUMENT::STRING)
+	{
+		uint32_t uLength = 0;
+		memcpy(&uLength, pArgument, sizeof(uLength));
+		const std::string value((const char*)pArgument + sizeof(uLength), uLength);
+		pArgument += sizeof(uLength) + uLength;
+
+		// Strings are copied into the record, there is no terminator to print them from in place
+		if (cConversion == 's')
+		{
+			format += 's';
+			snprintf(szText, sizeof(szText), format.c_str(), value.c_str());
+			text += szText;
+		}
+		else
+		{
+			text += value;
+		}
+
+		return;
+	}
+
+	uint64_t uBits = 0;
+	memcpy(&uBits, pArgument, sizeof(uBits));
+	pArgument += sizeof(uBits);
+
+	int64_t nValue = 0;
+	double fValue = 0.0;
+	memcpy(&nValue, &uBits, sizeof(nValue));
+	memcpy(&fValue, &uBits, sizeof(fValue));
+
+	switch (cConversion)
+	{
+	case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+		format += cConversion;
+		snprintf(szText, sizeof(szText), format.c_str(), (eType == LOG_ARGUMENT::DOUBLE) ? fValue : (eType == LOG_ARGUMENT::INT) ? (double)nValue : (double)uBits);
+		break;
+	case 'p':
+		format += 'p';
+		snprintf(szText, sizeof(szText), format.c_str(), (void*)(uintptr_t)uBits);
+		break;
+	case 'c':
+		format += 'c';
+		snprintf(szText, sizeof(szText), format.c_str(), (int)nValue);
+		break;
+	case 'd': case 'i': case 'u': case 'x': case 'X': case 'o':
+		if (eType == LOG_ARGUMENT::DOUBLE)
+		{
+			nValue = (int64_t)fValue;
+			uBits = (uint64_t)nValue;
+		}
+
+		format += "ll";
+		format += cConversion;
+
+		if (cConversion == 'd' || cConversion == 'i')
+		{
+			snprintf(szText, sizeof(szText), format.c_str(), (long long)nValue);
+		}
+		else
+		{
+			snprintf(szText, sizeof(szText), format.c_str(), (unsigned long long)uBits);
+		}
+		break;
+	default:
+		// %s given a number, or a conversion the logger doesn't know, prints the value the way it was stored
+		if (eType == LOG_ARGUMENT::DOUBLE)
+		{
+			snprintf(szText, sizeof(szText), "%g", fValue);
+		}
+		else if (eType == LOG_ARGUMENT::INT)
+		{
+			snprintf(szText, sizeof(szText), "%lld", (long long)nValue);
+		}
+		else if (eType == LOG_ARGUMENT::UINT)
+		{
+			snprintf(szText, sizeof(szText), "%llu", (unsigned long long)uBits);
+		}
+		else
+		{
+			snprintf(szText, sizeof(szText), "%p", (void*)(uintptr_t)uBits);
+		}
+		break;
+	}
+
+	text += szText;
+}
+
+// Formats a record's printf style format with its stored arguments
+static void FormatRecord(std::string& text, const LogRecordHeader& header, const unsigned char* pArguments)
+{
+	int nArgumentsLeft = header.mArgumentCount;
+
+	for (const char* pChar = header.mFormat; *pChar != '\0'; ++pChar)
+	{
+		if (*pChar != '%')
+		{
+			text += *pChar;
+			continue;
+		}
+
+		if (pChar[1] == '%')
+		{
+			text += '%';
+			++pChar;
+			continue;
+		}
+
+		// Flags, width and precision are kept, length modifiers are replaced with the ones of the stored type
+		const char* pSpec = pChar++;
+
+		while (*pChar != '\0' && strchr("-+ #0", *pChar) != nullptr)
+		{
+			++pChar;
+		}
+
+		while ((*pChar >= '0' && *pChar <= '9') || *pChar == '.')
+		{
+			++pChar;
+		}
+
+		std::string spec(pSpec, pChar - pSpec);
+
+		while (*pChar != '\0' && strchr("hlLzjtq", *pChar) != nullptr)
+		{
+			++pChar;
+		}
+
+		if (*pChar == '\0')
+		{
+			text += spec;
+			break;
+		}
+
+		if (nArgumentsLeft == 0)
+		{
+			// Fewer arguments than conversions, the conversion is printed as it is
+			text += spec;
+			text += *pChar;
+			continue;
+		}
+
+		const LOG_ARGUMENT eType = (LOG_ARGUMENT)*pArguments++;
+		FormatArgument(text, spec, *pChar, eType, pArguments);
+		--nArgumentsLeft;
+	}
+}
+
+// Reads every record the buffer's thread published so far into the lines
+static void ReadBuffer(LogThreadBuffer& buffer, std::vector<LogLine>& lines)
+{
+	const uint64_t uHead = buffer.mHead.load(std::memory_order_acquire);
+	uint64_t uTail = buffer.mTail.load(std::memory_order_relaxed);
+
+	while (uTail < uHead)
+	{
+		const unsigned char* pRecord = buffer.mData + (uTail & (kLogBufferSize - 1));
+
+		LogRecordHeader header;
+		memcpy(&header.mSize, pRecord + offsetof(LogRecordHeader, mSize), sizeof(header.mSize));
+		header.mArgumentCount = pRecord[offsetof(LogRecordHeader, mArgumentCount)];
+
+		if (header.mArgumentCount != kLogSkipRecord)
+		{
+			memcpy(&header, pRecord, sizeof(header));
+
+			LogLine line;
+			line.mTime = header.mTime;
+			line.mLevel = header.mLevel;
+			FormatRecord(line.mText, header, pRecord + sizeof(header));
+			lines.push_back(std::move(line));
+		}
+
+		uTail += header.mSize;
+	}
+
+	buffer.mTail.store(uTail, std::memory_order_release);
+}
+
+static void WriteText(LoggerState& state, const char* szText)
+{
+#ifdef _WIN32
+	// Windows applications have no console, the debugger's output is where the engine always logged
+	OutputDebugStringA(szText);
+#endif
+
+	fputs(szText, (state.mFile != nullptr) ? state.mFile : stderr);
+}
+
+// Formats and writes everything logged so far, one caller at a time
+static void Drain(LoggerState& state)
+{
+	std::vector<LogThreadBuffer*> buffers;
+	uint64_t uDropped = 0;
+
+	{
+		std::lock_guard<std::mutex> lock(state.mMutex);
+
+		for (const std::unique_ptr<LogThreadBuffer>& buffer : state.mBuffers)
+		{
+			buffers.push_back(buffer.get());
+			uDropped += buffer->mDropped.load(std::memory_order_relaxed);
+		}
+	}
+
+	std::lock_guard<std::mutex> drainLock(state.mDrainMutex);
+
+	for (LogThreadBuffer* pBuffer : buffers)
+	{
+		ReadBuffer(*pBuffer, state.mLines);
+	}
+
+	// Every thread's messages are in order already, merging them by time keeps the output in the order things happened
+	std::stable_sort(state.mLines.begin(), state.mLines.end(), [](const LogLine& a, const LogLine& b) { return a.mTime < b.mTime; });
+
+	for (const LogLine& line : state.mLines)
+	{
+		if (line.mLevel == LOG_LEVEL::WARNING)
+		{
+			WriteText(state, "Warning: ");
+		}
+		else if (line.mLevel == LOG_LEVEL::SEVERE)
+		{
+			WriteText(state, "Error: ");
+		}
+
+		WriteText(state, line.mText.c_str());
+	}
+
+	if (uDropped > state.mDropped)
+	{
+		char szText[96];
+		snprintf(szText, sizeof(szText), "Warning: %llu log messages dropped, their thread's buffer was full\n", (unsigned long long)(uDropped - state.mDropped));
+		WriteText(state, szText);
+		state.mDropped = uDropped;
+	}
+
+	if (!state.mLines.empty())
+	{
+		fflush((state.mFile != nullptr) ? state.mFile : stderr);
+	}
+
+	state.mLines.clear();
+}
+
+static void LoggerThreadLoop(LoggerState* pState)
+{
+	Profiler::SetThreadName("Logger");
+
+	std::unique_lock<std::mutex> lock(pState->mMutex);
+
+	while (true)
+	{
+		pState->mWake.wait_for(lock, std::chrono::milliseconds(kLogFlushInterval), [pState]()
+		{
+			return pState->mShutdown || pState->mFlushRequests > pState->mFlushesDone;
+		});
+
+		const uint64_t uFlushRequests = pState->mFlushRequests;
+		const bool bShutdown = pState->mShutdown;
+
+		lock.unlock();
+		Drain(*pState);
+		lock.lock();
+
+		pState->mFlushesDone = uFlushRequests;
+		pState->mFlushed.notify_all();
+
+		if (bShutdown)
+		{
+			break;
+		}
+	}
+}
+
+LogThreadBuffer* Logger::RegisterThread()
+{
+	std::unique_ptr<LogThreadBuffer> buffer(new LogThreadBuffer());
+	buffer->mHead = 0;
+	buffer->mTail = 0;
+	buffer->mDropped = 0;
+
+	LoggerState* pState = AccessLoggerState();
+
+	std::lock_guard<std::mutex> lock(pState->mMutex);
+
+	// Started with the first message, so programs that never log never get the thread
+	if (!pState->mStarted && !pState->mShutdown)
+	{
+		pState->mStarted = true;
+		pState->mThread = std::thread(&LoggerThreadLoop, pState);
+	}
+
+	tBuffer = buffer.get();
+	pState->mBuffers.push_back(std::move(buffer));
+
+	return tBuffer;
+}
+
+int64_t Logger::Now()
+{
+	return (int64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+}
+
+void Logger::Commit(LogThreadBuffer* pBuffer, uint32_t uSize, LOG_LEVEL eLevel)
+{
+	const uint64_t uHead = pBuffer->mHead.load(std::memory_order_relaxed) + uSize;
+	pBuffer->mHead.store(uHead, std::memory_order_release);
+
+	if (gLoggerSynchronous.load(std::memory_order_relaxed))
+	{
+		Drain(*AccessLoggerState());
+	}
+	else if (eLevel == LOG_LEVEL::SEVERE || uHead - pBuffer->mTail.load(std::memory_order_relaxed) > kLogBufferSize / 2)
+	{
+		// Errors don't wait for the next round, the program may be about to go down, and neither does a filling buffer
+		AccessLoggerState()->mWake.notify_one();
+	}
+}
+
+bool Logger::SetFile(const char* szFile)
+{
+	// Everything logged so far goes where it was meant to
+	Flush();
+
+	LoggerState* pState = AccessLoggerState();
+	FILE* pFile = nullptr;
+
+	if (szFile != nullptr)
+	{
+		pFile = fopen(szFile, "w");
+
+		if (pFile == nullptr)
+		{
+			return false;
+		}
+	}
+
+	std::lock_guard<std::mutex> drainLock(pState->mDrainMutex);
+
+	if (pState->mFile != nullptr)
+	{
+		fclose(pState->mFile);
+	}
+
+	pState->mFile = pFile;
+
+	return true;
+}
+
+void Logger::Flush()
+{
+	LoggerState* pState = AccessLoggerState();
+	std::unique_lock<std::mutex> lock(pState->mMutex);
+
+	if (!pState->mStarted || pState->mShutdown)
+	{
+		lock.unlock();
+		Drain(*pState);
+		return;
+	}
+
+	const uint64_t uRequest = ++pState->mFlushRequests;
+	pState->mWake.notify_one();
+	pState->mFlushed.wait(lock, [pState, uRequest]() { return pState->mFlushesDone >= uRequest; });
+}
+
+void Logger::Shutdown()
+{
+	LoggerState* pState = AccessLoggerState();
+
+	{
+		std::lock_guard<std::mutex> lock(pState->mMutex);
+
+		if (pState->mShutdown)
+		{
+			return;
+		}
+
+		pState->mShutdown = true;
+	}
+
+	pState->mWake.notify_one();
+
+	if (pState->mThread.joinable())
+	{
+		pState->mThread.join();
+	}
+
+	gLoggerSynchronous = true;
+
+	// Anything logged between the thread's last drain and the switch
+	Drain(*pState);
+
+	std::lock_guard<std::mutex> drainLock(pState->mDrainMutex);
+
+	if (pState->mFile != nullptr)
+	{
+		fflush(pState->mFile);
+	}
+}
@@ -1,19 +1,25 @@
-#include <Windows.h>
-#include <iostream>
 #include <string>
 #include "Output.h"
 
 void Console::Log(const char* text)
 {
-	OutputDebugString(text);
+	LOG_INFO("%s", text);
 }
 
-void Console::LogString(std::string text)
+void Console::LogString(const std::string& text)
 {
-	Console::Log(text.c_str());
+	LOG_INFO("%s", text);
 }
 
 void Console::LogOpenGL(unsigned int error)
 {
-	Console::LogString("OpenGL Error Code - " + std::to_string(error) + "\n");
-}
\ No newline at end of file
+	// Called with whatever glGetError returns, 0 is no error
+	if (error != 0)
+	{
+		LOG_SEVERE("OpenGL Error Code - %u\n", error);
+	}
+	else
+	{
+		LOG_INFO("OpenGL Error Code - %u\n", error);
+	}
+}
@@ -0,0 +1,119 @@
+#include "Profiler.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Events at the old end of a buffer that aren't written out, the thread may be overwriting them while the trace is being written
+const uint64_t kProfilerDumpMargin = 4096;
+
+// Every buffer ever registered, kept after their threads exit so their events still make it into the trace
+static std::mutex gProfilerMutex;
+static std::vector<std::unique_ptr<ProfilerThreadBuffer>> gProfilerBuffers;
+
+// Where the counter and the clock stood when the program started, the trace's timestamps are relative to it
+static const uint64_t gProfilerStartTicks = Profiler::Now();
+static const std::chrono::steady_clock::time_point gProfilerStartTime = std::chrono::steady_clock::now();
+
+ProfilerThreadBuffer* Profiler::RegisterThread()
+{
+	std::unique_ptr<ProfilerThreadBuffer> buffer(new ProfilerThreadBuffer());
+	buffer->mCount = 0;
+	buffer->mThreadName[0] = '\0';
+
+	std::lock_guard<std::mutex> lock(gProfilerMutex);
+
+	buffer->mThreadIndex = (int)gProfilerBuffers.size();
+	tBuffer = buffer.get();
+	gProfilerBuffers.push_back(std::move(buffer));
+
+	return tBuffer;
+}
+
+void Profiler::SetThreadName(const char* szName)
+{
+	ProfilerThreadBuffer* pBuffer = (tBuffer != nullptr) ? tBuffer : RegisterThread();
+
+	std::lock_guard<std::mutex> lock(gProfilerMutex);
+
+	strncpy(pBuffer->mThreadName, szName, sizeof(pBuffer->mThreadName) - 1);
+	pBuffer->mThreadName[sizeof(pBuffer->mThreadName) - 1] = '\0';
+}
+
+// Writes a string as a JSON string, names are identifiers in practice but a stray quote shouldn't break the file
+static void WriteJSONString(FILE* pFile, const char* szText)
+{
+	fputc('"', pFile);
+
+	for (const char* pChar = szText; *pChar != '\0'; ++pChar)
+	{
+		if (*pChar == '"' || *pChar == '\\')
+		{
+			fputc('\\', pFile);
+		}
+
+		fputc((unsigned char)*pChar >= 0x20 ? *pChar : ' ', pFile);
+	}
+
+	fputc('"', pFile);
+}
+
+bool Profiler::WriteChromeTrace(const char* szFile)
+{
+	FILE* pFile = fopen(szFile, "wb");
+
+	if (pFile == nullptr)
+	{
+		return false;
+	}
+
+	// How fast the counter ticks, measured over the whole run so far
+	const uint64_t uNowTicks = Now();
+	const double fElapsedMicroseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - gProfilerStartTime).count();
+	const double fTicksPerMicrosecond = (fElapsedMicroseconds > 0.0) ? (double)(uNowTicks - gProfilerStartTicks) / fElapsedMicroseconds : 1.0;
+
+	std::lock_guard<std::mutex> lock(gProfilerMutex);
+
+	fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", pFile);
+
+	bool bFirst = true;
+
+	for (const std::unique_ptr<ProfilerThreadBuffer>& buffer : gProfilerBuffers)
+	{
+		if (buffer->mThreadName[0] != '\0')
+		{
+			fprintf(pFile, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":", bFirst ? "" : ",\n", buffer->mThreadIndex);
+			WriteJSONString(pFile, buffer->mThreadName);
+			fputs("}}", pFile);
+			bFirst = false;
+		}
+
+		const uint64_t uCount = buffer->mCount.load(std::memory_order_acquire);
+		const uint64_t uKept = kProfilerEventsPerThread - kProfilerDumpMargin;
+		const uint64_t uFirst = (uCount > uKept) ? uCount - uKept : 0;
+
+		for (uint64_t i = uFirst; i < uCount; ++i)
+		{
+			const ProfilerEvent& event = buffer->mEvents[i & (kProfilerEventsPerThread - 1)];
+			const uint64_t uStart = event.mStart.load(std::memory_order_relaxed);
+			const uint64_t uEnd = event.mEnd.load(std::memory_order_relaxed);
+
+			const double fStart = (double)(int64_t)(uStart - gProfilerStartTicks) / fTicksPerMicrosecond;
+			const double fDuration = (double)(uEnd - uStart) / fTicksPerMicrosecond;
+
+			fprintf(pFile, "%s{\"name\":", bFirst ? "" : ",\n");
+			WriteJSONString(pFile, event.mName.load(std::memory_order_relaxed));
+			fprintf(pFile, ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", buffer->mThreadIndex, fStart, fDuration);
+			bFirst = false;
+		}
+	}
+
+	fputs("\n]}\n", pFile);
+
+	const bool bWritten = (ferror(pFile) == 0);
+	fclose(pFile);
+
+	return bWritten;
+}
@@ -0,0 +1,96 @@
+#include "RenderBatch.h"
+
+// Number of instances and vertices reserved up front so the first frames don't keep growing the streams
+const int kInitialBatchInstances = 4 * 1024;
+const int kInitialBatchVertices = 6 * 1024;
+
+RenderBatch::RenderBatch()
+{
+	mInstances.reserve(kInitialBatchInstances);
+	mVertices.reserve(kInitialBatchVertices);
+}
+
+RenderBatch::~RenderBatch()
+{
+
+}
+
+void RenderBatch::AddInstance(const exVector2& v2Center, float fHalfWidth, float fHalfHeight, const exColor& color, int nLayer)
+{
+	InstanceData instance;
+	instance.mCenter[0] = v2Center.x;
+	instance.mCenter[1] = v2Center.y;
+	instance.mHalfExtents[0] = fHalfWidth;
+	instance.mHalfExtents[1] = fHalfHeight;
+	instance.mLayer = (float)nLayer;
+
+	for (int c = 0; c < 4; ++c)
+	{
+		instance.mColor[c] = color.mColor[c];
+	}
+
+	mInstances.push_back(instance);
+}
+
+void RenderBatch::AddVertex(const exVector2& v2Position, const exColor& color, int nLayer)
+{
+	AddVertex(v2Position, 0.0f, 0.0f, color, nLayer);
+}
+
+void RenderBatch::AddVertex(const exVector2& v2Position, float fU, float fV, const exColor& color, int nLayer)
+{
+	BatchVertex vertex;
+	vertex.mPosition[0] = v2Position.x;
+	vertex.mPosition[1] = v2Position.y;
+	vertex.mPosition[2] = (float)nLayer;
+	vertex.mTexCoords[0] = fU;
+	vertex.mTexCoords[1] = fV;
+
+	for (int c = 0; c < 4; ++c)
+	{
+		vertex.mColor[c] = color.mColor[c];
+	}
+
+	mVertices.push_back(vertex);
+}
+
+void RenderBatch::AppendVertices(const RenderBatch& batch)
+{
+	mVertices.insert(mVertices.end(), batch.mVertices.begin(), batch.mVertices.end());
+}
+
+void RenderBatch::Clear()
+{
+	mInstances.clear();
+	mVertices.clear();
+}
+
+const InstanceData* RenderBatch::GetInstances() const
+{
+	return mInstances.data();
+}
+
+int RenderBatch::GetInstanceCount() const
+{
+	return (int)mInstances.size();
+}
+
+int RenderBatch::GetInstancesSizeInBytes() const
+{
+	return (int)(mInstances.size() * sizeof(InstanceData));
+}
+
+const BatchVertex* RenderBatch::GetVertices() const
+{
+	return mVertices.data();
+}
+
+int RenderBatch::GetVertexCount() const
+{
+	return (int)mVertices.size();
+}
+
+int RenderBatch::GetVerticesSizeInBytes() const
+{
+	return (int)(mVertices.size() * sizeof(BatchVertex));
+}
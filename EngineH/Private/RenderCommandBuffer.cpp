@@ -0,0 +1,375 @@
+#include "RenderCommandBuffer.h"
+#include "BatchMath.h"
+#include "EngineInterface.h"
+#include <cfloat>
+#include <cstring>
+
+// Number of commands reserved up front so the first frames don't keep growing the buffer
+const int kInitialCommandCount = 4096;
+
+const int kLayerShift = 48;
+const int kProgramShift = 40;
+const int kPrimitiveShift = 32;
+
+// Layers are signed, biasing them makes negative layers sort before positive ones
+const int kLayerBias = 32768;
+
+RenderCommandBuffer::RenderCommandBuffer()
+{
+	mCommands.reserve(kInitialCommandCount);
+	mSortEntries.reserve(kInitialCommandCount);
+	mSortScratch.reserve(kInitialCommandCount);
+	mBoundsMinX.reserve(kInitialCommandCount);
+	mBoundsMinY.reserve(kInitialCommandCount);
+	mBoundsMaxX.reserve(kInitialCommandCount);
+	mBoundsMaxY.reserve(kInitialCommandCount);
+	mVisible.reserve(kInitialCommandCount);
+}
+
+RenderCommandBuffer::~RenderCommandBuffer()
+{
+
+}
+
+void RenderCommandBuffer::AddBox(const exVector2& v2P1, const exVector2& v2P2, const exColor& color, int nLayer)
+{
+	RenderCommand command;
+	command.mType = PRIMITIVE_TYPE::BOX;
+	command.mColor = color;
+	command.mLayer = nLayer;
+	command.mP1 = v2P1;
+	command.mP2 = v2P2;
+	command.mRadius = 0.0f;
+	command.mWidth = 0.0f;
+	command.mFontID = -1;
+	command.mTextOffset = -1;
+
+	AddCommand(command);
+}
+
+void RenderCommandBuffer::AddCircle(const exVector2& v2Center, float fRadius, const exColor& color, int nLayer)
+{
+	RenderCommand command;
+	command.mType = PRIMITIVE_TYPE::CIRCLE;
+	command.mColor = color;
+	command.mLayer = nLayer;
+	command.mP1 = v2Center;
+	command.mP2 = v2Center;
+	command.mRadius = fRadius;
+	command.mWidth = 0.0f;
+	command.mFontID = -1;
+	command.mTextOffset = -1;
+
+	AddCommand(command);
+}
+
+void RenderCommandBuffer::AddLine(const exVector2& v2P1, const exVector2& v2P2, float fWidth, const exColor& color, int nLayer)
+{
+	RenderCommand command;
+	command.mType = PRIMITIVE_TYPE::LINE;
+	command.mColor = color;
+	command.mLayer = nLayer;
+	command.mP1 = v2P1;
+	command.mP2 = v2P2;
+	command.mRadius = 0.0f;
+	command.mWidth = fWidth;
+	command.mFontID = -1;
+	command.mTextOffset = -1;
+
+	AddCommand(command);
+}
+
+void RenderCommandBuffer::AddLineBox(const exVector2& v2P1, const exVector2& v2P2, float fWidth, const exColor& color, int nLayer)
+{
+	RenderCommand command;
+	command.mType = PRIMITIVE_TYPE::LINE_BOX;
+	command.mColor = color;
+	command.mLayer = nLayer;
+	command.mP1 = v2P1;
+	command.mP2 = v2P2;
+	command.mRadius = 0.0f;
+	command.mWidth = fWidth;
+	command.mFontID = -1;
+	command.mTextOffset = -1;
+
+	AddCommand(command);
+}
+
+void RenderCommandBuffer::AddLineCircle(const exVector2& v2Center, float fRadius, float fWidth, const exColor& color, int nLayer)
+{
+	RenderCommand command;
+	command.mType = PRIMITIVE_TYPE::LINE_CIRCLE;
+	command.mColor = color;
+	command.mLayer = nLayer;
+	command.mP1 = v2Center;
+	command.mP2 = v2Center;
+	command.mRadius = fRadius;
+	command.mWidth = fWidth;
+	command.mFontID = -1;
+	command.mTextOffset = -1;
+
+	AddCommand(command);
+}
+
+void RenderCommandBuffer::AddText(int nFontID, const exVector2& v2Position, const char* szText, const exColor& color, int nLayer)
+{
+	RenderCommand command;
+	command.mType = PRIMITIVE_TYPE::TEXT;
+	command.mColor = color;
+	command.mLayer = nLayer;
+	command.mP1 = v2Position;
+	command.mP2 = v2Position;
+	command.mRadius = 0.0f;
+	command.mWidth = 0.0f;
+	command.mFontID = nFontID;
+	command.mTextOffset = (int)mText.size();
+
+	mText.insert(mText.end(), szText, szText + strlen(szText) + 1);
+
+	AddCommand(command);
+}
+
+const char* RenderCommandBuffer::GetText(const RenderCommand& command) const
+{
+	return &mText[command.mTextOffset];
+}
+
+void RenderCommandBuffer::AddCommand(RenderCommand& command)
+{
+	// The depth is the submission order, so draws that compare equal otherwise still come out in the order the game issued them
+	uint32_t uDepth = (uint32_t)mCommands.size();
+	command.mKey = MakeSortKey(command.mLayer, GetProgramForPrimitive(command.mType), command.mType, uDepth);
+
+	mCommands.push_back(command);
+	AddBounds(command);
+}
+
+void RenderCommandBuffer::AddBounds(const RenderCommand& command)
+{
+	// Text reaches everywhere, so it never gets culled
+	if (command.mType == PRIMITIVE_TYPE::TEXT)
+	{
+		mBoundsMinX.push_back(-FLT_MAX);
+		mBoundsMinY.push_back(-FLT_MAX);
+		mBoundsMaxX.push_back(FLT_MAX);
+		mBoundsMaxY.push_back(FLT_MAX);
+		return;
+	}
+
+	// Circles reach their radius around the center, outlines half their width beyond the shape
+	const float fExtent = command.mRadius + command.mWidth * 0.5f;
+
+	mBoundsMinX.push_back(((command.mP1.x < command.mP2.x) ? command.mP1.x : command.mP2.x) - fExtent);
+	mBoundsMinY.push_back(((command.mP1.y < command.mP2.y) ? command.mP1.y : command.mP2.y) - fExtent);
+	mBoundsMaxX.push_back(((command.mP1.x > command.mP2.x) ? command.mP1.x : command.mP2.x) + fExtent);
+	mBoundsMaxY.push_back(((command.mP1.y > command.mP2.y) ? command.mP1.y : command.mP2.y) + fExtent);
+}
+
+void RenderCommandBuffer::Append(const RenderCommandBuffer& other)
+{
+	const int nTextBase = (int)mText.size();
+	mText.insert(mText.end(), other.mText.begin(), other.mText.end());
+
+	mCommands.reserve(mCommands.size() + other.mCommands.size());
+
+	mBoundsMinX.insert(mBoundsMinX.end(), other.mBoundsMinX.begin(), other.mBoundsMinX.end());
+	mBoundsMinY.insert(mBoundsMinY.end(), other.mBoundsMinY.begin(), other.mBoundsMinY.end());
+	mBoundsMaxX.insert(mBoundsMaxX.end(), other.mBoundsMaxX.begin(), other.mBoundsMaxX.end());
+	mBoundsMaxY.insert(mBoundsMaxY.end(), other.mBoundsMaxY.begin(), other.mBoundsMaxY.end());
+
+	for (const RenderCommand& otherCommand : other.mCommands)
+	{
+		RenderCommand command = otherCommand;
+
+		// Re-stamping the depth so the appended commands keep their order, after everything already here
+		command.mKey = (command.mKey & ~(uint64_t)0xFFFFFFFF) | (uint64_t)mCommands.size();
+
+		if (command.mTextOffset >= 0)
+		{
+			command.mTextOffset += nTextBase;
+		}
+
+		mCommands.push_back(command);
+	}
+}
+
+void RenderCommandBuffer::Swap(RenderCommandBuffer& other)
+{
+	mCommands.swap(other.mCommands);
+	mSortEntries.swap(other.mSortEntries);
+	mText.swap(other.mText);
+	mBoundsMinX.swap(other.mBoundsMinX);
+	mBoundsMinY.swap(other.mBoundsMinY);
+	mBoundsMaxX.swap(other.mBoundsMaxX);
+	mBoundsMaxY.swap(other.mBoundsMaxY);
+}
+
+int RenderCommandBuffer::CullToView(const exVector2& v2CameraPosition, float fCameraZoom)
+{
+	// The world space rectangle the viewport shows
+	const float fHalfWidth = kViewportWidth / (2.0f * fCameraZoom);
+	const float fHalfHeight = kViewportHeight / (2.0f * fCameraZoom);
+	const exVector2 v2ViewMin(v2CameraPosition.x - fHalfWidth, v2CameraPosition.y - fHalfHeight);
+	const exVector2 v2ViewMax(v2CameraPosition.x + fHalfWidth, v2CameraPosition.y + fHalfHeight);
+
+	const int nCommands = (int)mCommands.size();
+
+	mVisible.resize(nCommands);
+
+	const int nKept = BatchMath::FindOverlappingBounds(mBoundsMinX.data(), mBoundsMinY.data(), mBoundsMaxX.data(), mBoundsMaxY.data(), nCommands,
+		v2ViewMin, v2ViewMax, mVisible.data());
+
+	if (nKept == nCommands)
+	{
+		return 0;
+	}
+
+	// Compacting in place keeps the commands in order, their depths just end up with gaps
+	// The indices only ever grow, so nothing is overwritten before it is moved
+	for (int i = 0; i < nKept; ++i)
+	{
+		const uint32_t uIndex = mVisible[i];
+
+		if (uIndex != (uint32_t)i)
+		{
+			mCommands[i] = mCommands[uIndex];
+			mBoundsMinX[i] = mBoundsMinX[uIndex];
+			mBoundsMinY[i] = mBoundsMinY[uIndex];
+			mBoundsMaxX[i] = mBoundsMaxX[uIndex];
+			mBoundsMaxY[i] = mBoundsMaxY[uIndex];
+		}
+	}
+
+	mCommands.resize(nKept);
+	mBoundsMinX.resize(nKept);
+	mBoundsMinY.resize(nKept);
+	mBoundsMaxX.resize(nKept);
+	mBoundsMaxY.resize(nKept);
+
+	return nCommands - nKept;
+}
+
+void RenderCommandBuffer::Sort()
+{
+	const size_t uCount = mCommands.size();
+
+	mSortEntries.resize(uCount);
+	mSortScratch.resize(uCount);
+
+	for (size_t i = 0; i < uCount; ++i)
+	{
+		mSortEntries[i].mKey = mCommands[i].mKey;
+		mSortEntries[i].mIndex = (uint32_t)i;
+	}
+
+	// Building the histograms of all 8 digits in a single pass over the keys
+	uint32_t histograms[8][256];
+	memset(histograms, 0, sizeof(histograms));
+
+	for (size_t i = 0; i < uCount; ++i)
+	{
+		uint64_t uKey = mSortEntries[i].mKey;
+
+		for (int nDigit = 0; nDigit < 8; ++nDigit)
+		{
+			++histograms[nDigit][(uKey >> (nDigit * 8)) & 0xFF];
+		}
+	}
+
+	SortEntry* pSource = mSortEntries.data();
+	SortEntry* pDestination = mSortScratch.data();
+
+	// Least significant digit first, each pass is stable so the earlier passes are preserved
+	for (int nDigit = 0; nDigit < 8; ++nDigit)
+	{
+		uint32_t* histogram = histograms[nDigit];
+
+		// All the keys share this digit (the layer and program bytes usually do), nothing to reorder
+		if (uCount == 0 || histogram[(pSource[0].mKey >> (nDigit * 8)) & 0xFF] == uCount)
+		{
+			continue;
+		}
+
+		uint32_t offsets[256];
+		uint32_t uTotal = 0;
+
+		for (int nBucket = 0; nBucket < 256; ++nBucket)
+		{
+			offsets[nBucket] = uTotal;
+			uTotal += histogram[nBucket];
+		}
+
+		for (size_t i = 0; i < uCount; ++i)
+		{
+			uint32_t uBucket = (pSource[i].mKey >> (nDigit * 8)) & 0xFF;
+			pDestination[offsets[uBucket]++] = pSource[i];
+		}
+
+		SortEntry* pTemp = pSource;
+		pSource = pDestination;
+		pDestination = pTemp;
+	}
+
+	// Making sure the sorted entries are the ones that will be read
+	if (pSource != mSortEntries.data())
+	{
+		mSortEntries.swap(mSortScratch);
+	}
+}
+
+void RenderCommandBuffer::Clear()
+{
+	mCommands.clear();
+	mSortEntries.clear();
+	mText.clear();
+	mBoundsMinX.clear();
+	mBoundsMinY.clear();
+	mBoundsMaxX.clear();
+	mBoundsMaxY.clear();
+}
+
+int RenderCommandBuffer::GetCommandCount() const
+{
+	return (int)mCommands.size();
+}
+
+const RenderCommand& RenderCommandBuffer::GetSortedCommand(int nIndex) const
+{
+	return mCommands[mSortEntries[nIndex].mIndex];
+}
+
+uint64_t RenderCommandBuffer::MakeSortKey(int nLayer, SHADER_PROGRAM eProgram, PRIMITIVE_TYPE eType, uint32_t uDepth)
+{
+	// Clamping the layer so it fits its 16 bits
+	int nBiasedLayer = nLayer + kLayerBias;
+	nBiasedLayer = (nBiasedLayer < 0) ? 0 : ((nBiasedLayer > 0xFFFF) ? 0xFFFF : nBiasedLayer);
+
+	return ((uint64_t)nBiasedLayer << kLayerShift) |
+		((uint64_t)eProgram << kProgramShift) |
+		((uint64_t)eType << kPrimitiveShift) |
+		(uint64_t)uDepth;
+}
+
+SHADER_PROGRAM RenderCommandBuffer::GetProgramFromKey(uint64_t uKey)
+{
+	return (SHADER_PROGRAM)((uKey >> kProgramShift) & 0xFF);
+}
+
+SHADER_PROGRAM RenderCommandBuffer::GetProgramForPrimitive(PRIMITIVE_TYPE eType)
+{
+	switch (eType)
+	{
+	case PRIMITIVE_TYPE::CIRCLE:
+		return SHADER_PROGRAM::CIRCLE;
+	case PRIMITIVE_TYPE::LINE:
+	case PRIMITIVE_TYPE::LINE_BOX:
+	case PRIMITIVE_TYPE::LINE_CIRCLE:
+		// Every outline is tessellated into the same vertex stream
+		return SHADER_PROGRAM::LINE;
+	case PRIMITIVE_TYPE::TEXT:
+		return SHADER_PROGRAM::TEXT;
+	case PRIMITIVE_TYPE::BOX:
+	default:
+		return SHADER_PROGRAM::BOX;
+	}
+}
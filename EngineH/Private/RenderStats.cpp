@@ -0,0 +1,69 @@
+#include "RenderStats.h"
+
+RenderStats::RenderStats()
+{
+	mFrame = 0;
+	mCommands = 0;
+	mCulledCommands = 0;
+	mDrawCalls = 0;
+	mInstances = 0;
+	mVertices = 0;
+	mUploadedBytes = 0;
+	mProgramBinds = 0;
+	mVertexArrayBinds = 0;
+	mStateChanges = 0;
+	mElidedStateChanges = 0;
+	mFrameMilliseconds = 0.0f;
+}
+
+RenderStatsWriter::RenderStatsWriter()
+{
+	mFile = nullptr;
+}
+
+RenderStatsWriter::~RenderStatsWriter()
+{
+	Close();
+}
+
+bool RenderStatsWriter::Open(const char* szFile)
+{
+	Close();
+
+	mFile = fopen(szFile, "w");
+
+	if (mFile == nullptr)
+	{
+		return false;
+	}
+
+	fputs("frame,commands,culled_commands,draw_calls,instances,vertices,uploaded_bytes,program_binds,vertex_array_binds,state_changes,elided_state_changes,frame_ms\n", mFile);
+	return true;
+}
+
+void RenderStatsWriter::Close()
+{
+	if (mFile != nullptr)
+	{
+		fclose(mFile);
+		mFile = nullptr;
+	}
+}
+
+bool RenderStatsWriter::IsOpen() const
+{
+	return mFile != nullptr;
+}
+
+void RenderStatsWriter::Write(const RenderStats& stats)
+{
+	if (mFile == nullptr)
+	{
+		return;
+	}
+
+	// Buffered by stdio, the file only sees a write every few frames
+	fprintf(mFile, "%llu,%d,%d,%d,%d,%d,%llu,%d,%d,%d,%d,%.3f\n", (unsigned long long)stats.mFrame, stats.mCommands, stats.mCulledCommands, stats.mDrawCalls,
+		stats.mInstances, stats.mVertices, (unsigned long long)stats.mUploadedBytes, stats.mProgramBinds, stats.mVertexArrayBinds,
+		stats.mStateChanges, stats.mElidedStateChanges, stats.mFrameMilliseconds);
+}
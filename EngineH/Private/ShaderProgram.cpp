@@ -0,0 +1,205 @@
+#include "ShaderProgram.h"
+#include "GLEW.h"
+#include "Logger.h"
+
+// The GL types each supported handle type may be bound to
+template <typename T> struct UniformType;
+template <> struct UniformType<exMatrix4> { static bool Matches(GLenum eType) { return eType == GL_FLOAT_MAT4; } };
+template <> struct UniformType<exColorF> { static bool Matches(GLenum eType) { return eType == GL_FLOAT_VEC4; } };
+template <> struct UniformType<exVector2> { static bool Matches(GLenum eType) { return eType == GL_FLOAT_VEC2; } };
+template <> struct UniformType<float> { static bool Matches(GLenum eType) { return eType == GL_FLOAT; } };
+template <> struct UniformType<int>
+{
+	static bool Matches(GLenum eType)
+	{
+		return eType == GL_INT || eType == GL_BOOL || eType == GL_SAMPLER_2D;
+	}
+};
+
+// Arrays are reported as "name[0]", stripping that so they can be found by their plain name
+static std::string StripArraySuffix(const GLchar* szName)
+{
+	std::string name(szName);
+	size_t uBracket = name.find('[');
+
+	if (uBracket != std::string::npos)
+	{
+		name.resize(uBracket);
+	}
+
+	return name;
+}
+
+ShaderProgram::ShaderProgram()
+{
+	mProgram = 0;
+}
+
+ShaderProgram::~ShaderProgram()
+{
+	// The GL program is released along with the context
+}
+
+bool ShaderProgram::Link(GLuint gluVertexShader, GLuint gluFragmentShader)
+{
+	mProgram = glCreateProgram();
+	glAttachShader(mProgram, gluVertexShader);
+	glAttachShader(mProgram, gluFragmentShader);
+	glLinkProgram(mProgram);
+	glValidateProgram(mProgram);
+
+	GLint param;
+	glGetProgramiv(mProgram, GL_LINK_STATUS, &param);
+
+	if (!param)
+	{
+		GLchar log[4096];
+		glGetProgramInfoLog(mProgram, sizeof(log), NULL, log);
+		LOG_SEVERE("Shader link error - %s\n", log);
+		return false;
+	}
+
+	Reflect();
+
+	return true;
+}
+
+void ShaderProgram::Reflect()
+{
+	GLchar szName[256];
+	GLint nCount = 0;
+
+	mUniforms.clear();
+	mAttributes.clear();
+
+	glGetProgramiv(mProgram, GL_ACTIVE_UNIFORMS, &nCount);
+
+	for (GLint i = 0; i < nCount; ++i)
+	{
+		ShaderVariable uniform;
+		glGetActiveUniform(mProgram, i, sizeof(szName), nullptr, &uniform.mSize, &uniform.mType, szName);
+
+		// Uniforms living in a uniform block report a location of -1, they are kept so the program can still be inspected
+		uniform.mLocation = glGetUniformLocation(mProgram, szName);
+		uniform.mName = StripArraySuffix(szName);
+		mUniforms.push_back(uniform);
+	}
+
+	glGetProgramiv(mProgram, GL_ACTIVE_ATTRIBUTES, &nCount);
+
+	for (GLint i = 0; i < nCount; ++i)
+	{
+		ShaderVariable attribute;
+		glGetActiveAttrib(mProgram, i, sizeof(szName), nullptr, &attribute.mSize, &attribute.mType, szName);
+
+		attribute.mLocation = glGetAttribLocation(mProgram, szName);
+		attribute.mName = StripArraySuffix(szName);
+		mAttributes.push_back(attribute);
+	}
+}
+
+GLuint ShaderProgram::GetHandle() const
+{
+	return mProgram;
+}
+
+template <typename T>
+UniformHandle<T> ShaderProgram::GetUniform(const char* szName) const
+{
+	UniformHandle<T> handle;
+	const ShaderVariable* pUniform = FindUniform(szName);
+
+	if (pUniform == nullptr)
+	{
+		return handle;
+	}
+
+	if (!UniformType<T>::Matches(pUniform->mType))
+	{
+		LOG_SEVERE("Uniform type mismatch - %s\n", szName);
+		return handle;
+	}
+
+	handle.mLocation = pUniform->mLocation;
+	return handle;
+}
+
+template UniformHandle<exMatrix4> ShaderProgram::GetUniform<exMatrix4>(const char* szName) const;
+template UniformHandle<exColorF> ShaderProgram::GetUniform<exColorF>(const char* szName) const;
+template UniformHandle<exVector2> ShaderProgram::GetUniform<exVector2>(const char* szName) const;
+template UniformHandle<float> ShaderProgram::GetUniform<float>(const char* szName) const;
+template UniformHandle<int> ShaderProgram::GetUniform<int>(const char* szName) const;
+
+GLint ShaderProgram::GetAttributeLocation(const char* szName) const
+{
+	for (const ShaderVariable& attribute : mAttributes)
+	{
+		if (attribute.mName == szName)
+		{
+			return attribute.mLocation;
+		}
+	}
+
+	return -1;
+}
+
+bool ShaderProgram::BindUniformBlock(const char* szName, GLuint uBindingPoint) const
+{
+	GLuint uBlockIndex = glGetUniformBlockIndex(mProgram, szName);
+
+	if (uBlockIndex == GL_INVALID_INDEX)
+	{
+		return false;
+	}
+
+	glUniformBlockBinding(mProgram, uBlockIndex, uBindingPoint);
+	return true;
+}
+
+const std::vector<ShaderVariable>& ShaderProgram::GetUniforms() const
+{
+	return mUniforms;
+}
+
+const std::vector<ShaderVariable>& ShaderProgram::GetAttributes() const
+{
+	return mAttributes;
+}
+
+void ShaderProgram::SetUniform(UniformHandle<exMatrix4> handle, const exMatrix4& value) const
+{
+	glUniformMatrix4fv(handle.mLocation, 1, GL_FALSE, value.ToFloatPtr());
+}
+
+void ShaderProgram::SetUniform(UniformHandle<exColorF> handle, const exColorF& value) const
+{
+	glUniform4fv(handle.mLocation, 1, value.mColor);
+}
+
+void ShaderProgram::SetUniform(UniformHandle<exVector2> handle, const exVector2& value) const
+{
+	glUniform2f(handle.mLocation, value.x, value.y);
+}
+
+void ShaderProgram::SetUniform(UniformHandle<float> handle, float value) const
+{
+	glUniform1f(handle.mLocation, value);
+}
+
+void ShaderProgram::SetUniform(UniformHandle<int> handle, int value) const
+{
+	glUniform1i(handle.mLocation, value);
+}
+
+const ShaderVariable* ShaderProgram::FindUniform(const char* szName) const
+{
+	for (const ShaderVariable& uniform : mUniforms)
+	{
+		if (uniform.mName == szName)
+		{
+			return &uniform;
+		}
+	}
+
+	return nullptr;
+}
@@ -0,0 +1,39 @@
+#include "ShapeComponents.h"
+#include "EngineInterface.h"
+#include "EntityWorld.h"
+#include "Profiler.h"
+
+static exVector2 GetDrawPosition(const TransformComponent& transform, float fAlpha)
+{
+	return transform.mPreviousPosition + (transform.mPosition - transform.mPreviousPosition) * fAlpha;
+}
+
+void ShapeRenderer::Draw(EntityWorld& world, exEngineInterface* pEngine, float fAlpha)
+{
+	PROFILE_FUNCTION();
+
+	JobSystem& jobSystem = pEngine->GetJobSystem();
+
+	world.ParallelForEachChunk<const TransformComponent, const BoxComponent>(jobSystem,
+		[pEngine, fAlpha](int nCount, const Entity*, const TransformComponent* pTransforms, const BoxComponent* pBoxes)
+	{
+		for (int i = 0; i < nCount; ++i)
+		{
+			const exVector2 v2Position = GetDrawPosition(pTransforms[i], fAlpha);
+			const BoxComponent& box = pBoxes[i];
+
+			pEngine->DrawBox(v2Position - box.mHalfSize, v2Position + box.mHalfSize, box.mColor, box.mLayer);
+		}
+	});
+
+	world.ParallelForEachChunk<const TransformComponent, const CircleComponent>(jobSystem,
+		[pEngine, fAlpha](int nCount, const Entity*, const TransformComponent* pTransforms, const CircleComponent* pCircles)
+	{
+		for (int i = 0; i < nCount; ++i)
+		{
+			const CircleComponent& circle = pCircles[i];
+
+			pEngine->DrawCircle(GetDrawPosition(pTransforms[i], fAlpha), circle.mRadius, circle.mColor, circle.mLayer);
+		}
+	});
+}
@@ -0,0 +1,160 @@
+#include "SoftwareEngine.h"
+#include "Profiler.h"
+#include <chrono>
+
+SoftwareEngine::SoftwareEngine()
+{
+	mRasterizeTime = 0.0f;
+}
+
+SoftwareEngine::~SoftwareEngine()
+{
+
+}
+
+void SoftwareEngine::Run(exGameInterface* pGame)
+{
+	mRasterizer.Initialize(kViewportWidth, kViewportHeight);
+	mRasterizer.SetGlyphAtlas(&mGlyphAtlas);
+
+	WindowlessEngine::Run(pGame);
+}
+
+void SoftwareEngine::OnFrame(float fDeltaT)
+{
+	std::chrono::steady_clock::time_point frameStart = std::chrono::steady_clock::now();
+
+	const int nCulled = RecordFrame(fDeltaT);
+
+	exColor clearColor;
+	mGame->GetClearColor(clearColor);
+
+	mRasterizer.BeginFrame(clearColor);
+
+	// Counted before the flush clears them
+	const int nCommands = mCommandBuffer.GetCommandCount();
+
+	FlushCommands();
+
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	mRasterizer.Rasterize(mJobSystem);
+	mRasterizeTime = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+	// Nothing is uploaded or bound without a GPU
+	++mStats.mFrame;
+	mStats.mCommands = nCommands;
+	mStats.mCulledCommands = nCulled;
+	mStats.mDrawCalls = mRasterizer.GetPrimitiveCount();
+	mStats.mVertices = mRasterizer.GetVertexCount();
+	mStats.mFrameMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+
+	mStatsWriter.Write(mStats);
+}
+
+void SoftwareEngine::FlushCommands()
+{
+	PROFILE_FUNCTION();
+
+	const int nCommands = mCommandBuffer.GetCommandCount();
+
+	// The same order EngineH draws in, which is what makes later draws on a layer end up on top
+	mCommandBuffer.Sort();
+
+	// Fonts loaded since the last frame may have added atlas pages
+	mTextPageBatches.resize(mGlyphAtlas.GetPageCount());
+
+	for (int i = 0; i < nCommands; ++i)
+	{
+		const RenderCommand& command = mCommandBuffer.GetSortedCommand(i);
+
+		switch (command.mType)
+		{
+		case PRIMITIVE_TYPE::BOX:
+			mRasterizer.AddBox(WorldToScreen(command.mP1), WorldToScreen(command.mP2), command.mColor);
+			break;
+		case PRIMITIVE_TYPE::CIRCLE:
+			mRasterizer.AddCircle(WorldToScreen(command.mP1), command.mRadius * mCameraZoom, command.mColor);
+			break;
+		case PRIMITIVE_TYPE::LINE:
+		case PRIMITIVE_TYPE::LINE_BOX:
+		case PRIMITIVE_TYPE::LINE_CIRCLE:
+		{
+			// Tessellated in world space like EngineH does, then every vertex is moved to the screen
+			mLineBatch.Clear();
+
+			if (command.mType == PRIMITIVE_TYPE::LINE)
+			{
+				mLineTessellator.AddLine(mLineBatch, command.mP1, command.mP2, command.mWidth, command.mColor, command.mLayer);
+			}
+			else if (command.mType == PRIMITIVE_TYPE::LINE_BOX)
+			{
+				mLineTessellator.AddLineBox(mLineBatch, command.mP1, command.mP2, command.mWidth, command.mColor, command.mLayer);
+			}
+			else
+			{
+				mLineTessellator.AddLineCircle(mLineBatch, command.mP1, command.mRadius, mCameraZoom, command.mWidth, command.mColor, command.mLayer);
+			}
+
+			const BatchVertex* pVertices = mLineBatch.GetVertices();
+			const int nVertices = mLineBatch.GetVertexCount();
+
+			mScreenPoints.resize(nVertices);
+
+			for (int v = 0; v < nVertices; ++v)
+			{
+				mScreenPoints[v] = WorldToScreen(exVector2(pVertices[v].mPosition[0], pVertices[v].mPosition[1]));
+			}
+
+			mRasterizer.AddTriangles(mScreenPoints.data(), nVertices, command.mColor);
+			break;
+		}
+		case PRIMITIVE_TYPE::TEXT:
+		{
+			mFonts[command.mFontID].AddText(mTextPageBatches, command.mP1, mCommandBuffer.GetText(command), command.mColor, command.mLayer);
+
+			// Every glyph is 6 vertices, the first one its top left corner and the last one its bottom right
+			for (int nPage = 0; nPage < (int)mTextPageBatches.size(); ++nPage)
+			{
+				RenderBatch& pageBatch = mTextPageBatches[nPage];
+				const BatchVertex* pVertices = pageBatch.GetVertices();
+
+				for (int v = 0; v + 6 <= pageBatch.GetVertexCount(); v += 6)
+				{
+					const BatchVertex& topLeft = pVertices[v];
+					const BatchVertex& bottomRight = pVertices[v + 5];
+					const float texCoords[4] = { topLeft.mTexCoords[0], topLeft.mTexCoords[1], bottomRight.mTexCoords[0], bottomRight.mTexCoords[1] };
+
+					mRasterizer.AddGlyph(WorldToScreen(exVector2(topLeft.mPosition[0], topLeft.mPosition[1])),
+						WorldToScreen(exVector2(bottomRight.mPosition[0], bottomRight.mPosition[1])), texCoords, nPage, command.mColor);
+				}
+
+				pageBatch.Clear();
+			}
+			break;
+		}
+		}
+	}
+
+	mCommandBuffer.Clear();
+}
+
+exVector2 SoftwareEngine::WorldToScreen(const exVector2& v2World) const
+{
+	// The camera's position ends up in the middle of the viewport, scaled around it by the zoom
+	return exVector2((v2World.x - mCameraPosition.x) * mCameraZoom + kViewportWidth / 2.0f, (v2World.y - mCameraPosition.y) * mCameraZoom + kViewportHeight / 2.0f);
+}
+
+void SoftwareEngine::SetWorkerThreadCount(int nThreads)
+{
+	mJobSystem.Initialize(nThreads);
+}
+
+float SoftwareEngine::GetRasterizeTimeLastFrame() const
+{
+	return mRasterizeTime;
+}
+
+const SoftwareRasterizer& SoftwareEngine::GetRasterizer() const
+{
+	return mRasterizer;
+}
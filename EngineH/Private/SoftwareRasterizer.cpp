@@ -0,0 +1,597 @@
+#include "SoftwareRasterizer.h"
+#include "GlyphAtlas.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cstdio>
+
+// Span fills use the widest stores the compiler is allowed to emit, SSE2 is always there on x64
+#if defined(__AVX2__)
+#define RASTER_AVX2 1
+#include <immintrin.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RASTER_SSE2 1
+#include <emmintrin.h>
+#endif
+
+//-----------------------------------------------------------------
+// Span helpers
+//-----------------------------------------------------------------
+
+// Writes nCount pixels of a single color
+static void FillSpan(uint32_t* pPixels, int nCount, uint32_t uColor)
+{
+	int i = 0;
+
+#if defined(RASTER_AVX2)
+	const __m256i color8 = _mm256_set1_epi32((int)uColor);
+
+	for (; i + 8 <= nCount; i += 8)
+	{
+		_mm256_storeu_si256((__m256i*)(pPixels + i), color8);
+	}
+#endif
+
+#if defined(RASTER_SSE2)
+	const __m128i color4 = _mm_set1_epi32((int)uColor);
+
+	for (; i + 4 <= nCount; i += 4)
+	{
+		_mm_storeu_si128((__m128i*)(pPixels + i), color4);
+	}
+#endif
+
+	for (; i < nCount; ++i)
+	{
+		pPixels[i] = uColor;
+	}
+}
+
+// dst = (src * a + dst * (255 - a)) / 255 on every channel, rounded
+static uint32_t BlendPixel(uint32_t uDestination, uint32_t uSource, uint32_t uAlpha)
+{
+	uint32_t uResult = 0;
+
+	for (int nShift = 0; nShift < 32; nShift += 8)
+	{
+		uint32_t x = ((uSource >> nShift) & 0xFF) * uAlpha + ((uDestination >> nShift) & 0xFF) * (255 - uAlpha) + 128;
+		x = (x + (x >> 8)) >> 8;
+		uResult |= x << nShift;
+	}
+
+	return uResult;
+}
+
+// Blends 4 pixels towards a single color, each with its own alpha
+static void BlendSpan4(uint32_t* pPixels, uint32_t uColor, const uint32_t* pAlphas)
+{
+#if defined(RASTER_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i max = _mm_set1_epi16(255);
+	const __m128i half = _mm_set1_epi16(128);
+
+	__m128i destination = _mm_loadu_si128((const __m128i*)pPixels);
+	__m128i source = _mm_set1_epi32((int)uColor);
+
+	// Spreading each pixel's alpha over its 4 channels
+	__m128i alpha = _mm_setr_epi32((int)pAlphas[0], (int)pAlphas[1], (int)pAlphas[2], (int)pAlphas[3]);
+	alpha = _mm_or_si128(alpha, _mm_slli_epi32(alpha, 8));
+	alpha = _mm_or_si128(alpha, _mm_slli_epi32(alpha, 16));
+
+	__m128i result[2];
+
+	for (int nHalf = 0; nHalf < 2; ++nHalf)
+	{
+		__m128i d = (nHalf == 0) ? _mm_unpacklo_epi8(destination, zero) : _mm_unpackhi_epi8(destination, zero);
+		__m128i s = (nHalf == 0) ? _mm_unpacklo_epi8(source, zero) : _mm_unpackhi_epi8(source, zero);
+		__m128i a = (nHalf == 0) ? _mm_unpacklo_epi8(alpha, zero) : _mm_unpackhi_epi8(alpha, zero);
+
+		// At most 255 * 255 + 128, which still fits the unsigned 16 bits
+		__m128i x = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(s, a), _mm_mullo_epi16(d, _mm_sub_epi16(max, a))), half);
+		result[nHalf] = _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+	}
+
+	_mm_storeu_si128((__m128i*)pPixels, _mm_packus_epi16(result[0], result[1]));
+#else
+	for (int i = 0; i < 4; ++i)
+	{
+		pPixels[i] = BlendPixel(pPixels[i], uColor, pAlphas[i]);
+	}
+#endif
+}
+
+// Far enough outside any framebuffer that clamping to it never changes what gets drawn
+const float kMaxPixelCoordinate = 16777216.0f;
+
+// First pixel whose center is at or past the coordinate
+static int PixelCeil(float fCoordinate)
+{
+	fCoordinate = std::max(-kMaxPixelCoordinate, std::min(kMaxPixelCoordinate, fCoordinate));
+	return (int)ceilf(fCoordinate - 0.5f);
+}
+
+// Last pixel whose center is at or before the coordinate
+static int PixelFloor(float fCoordinate)
+{
+	fCoordinate = std::max(-kMaxPixelCoordinate, std::min(kMaxPixelCoordinate, fCoordinate));
+	return (int)floorf(fCoordinate - 0.5f);
+}
+
+//-----------------------------------------------------------------
+//-----------------------------------------------------------------
+
+SoftwareRasterizer::SoftwareRasterizer()
+{
+	mWidth = 0;
+	mHeight = 0;
+	mTilesX = 0;
+	mTilesY = 0;
+	mClearColor = 0;
+	mGlyphAtlas = nullptr;
+}
+
+SoftwareRasterizer::~SoftwareRasterizer()
+{
+
+}
+
+void SoftwareRasterizer::Initialize(int nWidth, int nHeight)
+{
+	mWidth = nWidth;
+	mHeight = nHeight;
+	mTilesX = (nWidth + kRasterTileSize - 1) / kRasterTileSize;
+	mTilesY = (nHeight + kRasterTileSize - 1) / kRasterTileSize;
+
+	mPixels.assign(mWidth * mHeight, 0);
+	mTileBins.resize(mTilesX * mTilesY);
+}
+
+void SoftwareRasterizer::BeginFrame(const exColor& clearColor)
+{
+	mClearColor = PackColor(clearColor);
+
+	mPrimitives.clear();
+	mVertices.clear();
+
+	for (std::vector<int>& bin : mTileBins)
+	{
+		bin.clear();
+	}
+}
+
+void SoftwareRasterizer::AddBox(const exVector2& v2Min, const exVector2& v2Max, const exColor& color)
+{
+	RasterPrimitive primitive = {};
+	primitive.mType = RASTER_PRIMITIVE::BOX;
+	primitive.mColor = PackColor(color);
+	primitive.mBounds[0] = std::min(v2Min.x, v2Max.x);
+	primitive.mBounds[1] = std::min(v2Min.y, v2Max.y);
+	primitive.mBounds[2] = std::max(v2Min.x, v2Max.x);
+	primitive.mBounds[3] = std::max(v2Min.y, v2Max.y);
+
+	AddPrimitive(primitive);
+}
+
+void SoftwareRasterizer::AddCircle(const exVector2& v2Center, float fRadius, const exColor& color)
+{
+	RasterPrimitive primitive = {};
+	primitive.mType = RASTER_PRIMITIVE::CIRCLE;
+	primitive.mColor = PackColor(color);
+	primitive.mCenter[0] = v2Center.x;
+	primitive.mCenter[1] = v2Center.y;
+	primitive.mRadius = fRadius;
+	primitive.mBounds[0] = v2Center.x - fRadius;
+	primitive.mBounds[1] = v2Center.y - fRadius;
+	primitive.mBounds[2] = v2Center.x + fRadius;
+	primitive.mBounds[3] = v2Center.y + fRadius;
+
+	AddPrimitive(primitive);
+}
+
+void SoftwareRasterizer::AddTriangles(const exVector2* pPoints, int nCount, const exColor& color)
+{
+	nCount -= nCount % 3;
+
+	if (nCount == 0)
+	{
+		return;
+	}
+
+	RasterPrimitive primitive = {};
+	primitive.mType = RASTER_PRIMITIVE::TRIANGLES;
+	primitive.mColor = PackColor(color);
+	primitive.mFirstVertex = (int)mVertices.size();
+	primitive.mVertexCount = nCount;
+	primitive.mBounds[0] = primitive.mBounds[2] = pPoints[0].x;
+	primitive.mBounds[1] = primitive.mBounds[3] = pPoints[0].y;
+
+	for (int i = 0; i < nCount; ++i)
+	{
+		primitive.mBounds[0] = std::min(primitive.mBounds[0], pPoints[i].x);
+		primitive.mBounds[1] = std::min(primitive.mBounds[1], pPoints[i].y);
+		primitive.mBounds[2] = std::max(primitive.mBounds[2], pPoints[i].x);
+		primitive.mBounds[3] = std::max(primitive.mBounds[3], pPoints[i].y);
+	}
+
+	mVertices.insert(mVertices.end(), pPoints, pPoints + nCount);
+
+	AddPrimitive(primitive);
+}
+
+void SoftwareRasterizer::AddGlyph(const exVector2& v2Min, const exVector2& v2Max, const float* pTexCoords, int nPage, const exColor& color)
+{
+	RasterPrimitive primitive = {};
+	primitive.mType = RASTER_PRIMITIVE::GLYPH;
+
+	// Blending against an opaque framebuffer, the color's own alpha only scales the coverage
+	primitive.mColor = PackColor(color);
+	primitive.mOpacity = color.mColor[3] / 255.0f;
+
+	primitive.mBounds[0] = v2Min.x;
+	primitive.mBounds[1] = v2Min.y;
+	primitive.mBounds[2] = v2Max.x;
+	primitive.mBounds[3] = v2Max.y;
+
+	for (int i = 0; i < 4; ++i)
+	{
+		primitive.mTexCoords[i] = pTexCoords[i];
+	}
+
+	primitive.mPage = nPage;
+
+	AddPrimitive(primitive);
+}
+
+void SoftwareRasterizer::SetGlyphAtlas(const GlyphAtlas* pAtlas)
+{
+	mGlyphAtlas = pAtlas;
+}
+
+void SoftwareRasterizer::AddPrimitive(const RasterPrimitive& primitive)
+{
+	// Culling what is entirely off screen, everything else goes in the bin of every tile its bounds touch
+	if (primitive.mBounds[2] < 0.0f || primitive.mBounds[3] < 0.0f || primitive.mBounds[0] >= (float)mWidth || primitive.mBounds[1] >= (float)mHeight)
+	{
+		return;
+	}
+
+	const int nIndex = (int)mPrimitives.size();
+	mPrimitives.push_back(primitive);
+
+	// Clamping before converting, the bounds can be far outside of what an int holds
+	const int nTileX0 = (int)std::max(0.0f, primitive.mBounds[0]) / kRasterTileSize;
+	const int nTileY0 = (int)std::max(0.0f, primitive.mBounds[1]) / kRasterTileSize;
+	const int nTileX1 = (int)std::min((float)(mWidth - 1), primitive.mBounds[2]) / kRasterTileSize;
+	const int nTileY1 = (int)std::min((float)(mHeight - 1), primitive.mBounds[3]) / kRasterTileSize;
+
+	for (int nTileY = nTileY0; nTileY <= nTileY1; ++nTileY)
+	{
+		for (int nTileX = nTileX0; nTileX <= nTileX1; ++nTileX)
+		{
+			mTileBins[nTileY * mTilesX + nTileX].push_back(nIndex);
+		}
+	}
+}
+
+void SoftwareRasterizer::Rasterize(JobSystem& jobSystem)
+{
+	PROFILE_FUNCTION();
+
+	// A tile per job, the tiles with the most primitives take the longest and the others get stolen around them
+	jobSystem.ParallelFor(mTilesX * mTilesY, 1, [this](int nBegin, int nEnd)
+	{
+		for (int nTile = nBegin; nTile < nEnd; ++nTile)
+		{
+			RasterizeTile(nTile);
+		}
+	});
+}
+
+void SoftwareRasterizer::RasterizeTile(int nTile)
+{
+	// The tile's pixels, max exclusive
+	const int nMinX = (nTile % mTilesX) * kRasterTileSize;
+	const int nMinY = (nTile / mTilesX) * kRasterTileSize;
+	const int nMaxX = std::min(nMinX + kRasterTileSize, mWidth);
+	const int nMaxY = std::min(nMinY + kRasterTileSize, mHeight);
+
+	for (int y = nMinY; y < nMaxY; ++y)
+	{
+		FillSpan(&mPixels[y * mWidth + nMinX], nMaxX - nMinX, mClearColor);
+	}
+
+	for (int nIndex : mTileBins[nTile])
+	{
+		const RasterPrimitive& primitive = mPrimitives[nIndex];
+
+		switch (primitive.mType)
+		{
+		case RASTER_PRIMITIVE::BOX:
+			DrawBox(primitive, nMinX, nMinY, nMaxX, nMaxY);
+			break;
+		case RASTER_PRIMITIVE::CIRCLE:
+			DrawCircle(primitive, nMinX, nMinY, nMaxX, nMaxY);
+			break;
+		case RASTER_PRIMITIVE::TRIANGLES:
+			DrawTriangles(primitive, nMinX, nMinY, nMaxX, nMaxY);
+			break;
+		case RASTER_PRIMITIVE::GLYPH:
+			DrawGlyph(primitive, nMinX, nMinY, nMaxX, nMaxY);
+			break;
+		}
+	}
+}
+
+void SoftwareRasterizer::DrawBox(const RasterPrimitive& primitive, int nMinX, int nMinY, int nMaxX, int nMaxY)
+{
+	// Like GL, a pixel is covered when its center is inside
+	const int x0 = std::max(nMinX, PixelCeil(primitive.mBounds[0]));
+	const int y0 = std::max(nMinY, PixelCeil(primitive.mBounds[1]));
+	const int x1 = std::min(nMaxX, PixelCeil(primitive.mBounds[2]));
+	const int y1 = std::min(nMaxY, PixelCeil(primitive.mBounds[3]));
+
+	// Boxes thinner than a pixel center cover nothing, x0 can even be the tile's right edge
+	if (x0 >= x1 || y0 >= y1)
+	{
+		return;
+	}
+
+	for (int y = y0; y < y1; ++y)
+	{
+		FillSpan(&mPixels[y * mWidth + x0], x1 - x0, primitive.mColor);
+	}
+}
+
+void SoftwareRasterizer::DrawCircle(const RasterPrimitive& primitive, int nMinX, int nMinY, int nMaxX, int nMaxY)
+{
+	const float cx = primitive.mCenter[0];
+	const float cy = primitive.mCenter[1];
+	const float r = primitive.mRadius;
+
+	const int y0 = std::max(nMinY, PixelCeil(cy - r));
+	const int y1 = std::min(nMaxY, PixelCeil(cy + r) + 1);
+
+	for (int y = y0; y < y1; ++y)
+	{
+		// Each row of a circle is a single span
+		const float dy = y + 0.5f - cy;
+		const float fSquared = r * r - dy * dy;
+
+		if (fSquared < 0.0f)
+		{
+			continue;
+		}
+
+		const float fHalfWidth = sqrtf(fSquared);
+		const int x0 = std::max(nMinX, PixelCeil(cx - fHalfWidth));
+		const int x1 = std::min(nMaxX, PixelFloor(cx + fHalfWidth) + 1);
+
+		if (x1 > x0)
+		{
+			FillSpan(&mPixels[y * mWidth + x0], x1 - x0, primitive.mColor);
+		}
+	}
+}
+
+void SoftwareRasterizer::DrawTriangles(const RasterPrimitive& primitive, int nMinX, int nMinY, int nMaxX, int nMaxY)
+{
+	const exVector2* pVertices = &mVertices[primitive.mFirstVertex];
+
+	for (int i = 0; i < primitive.mVertexCount; i += 3)
+	{
+		exVector2 a = pVertices[i];
+		exVector2 b = pVertices[i + 1];
+		exVector2 c = pVertices[i + 2];
+
+		const float fArea = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+
+		if (fArea == 0.0f)
+		{
+			continue;
+		}
+
+		// Winding them all the same way, so inside is where every edge function is positive
+		if (fArea < 0.0f)
+		{
+			std::swap(b, c);
+		}
+
+		const int x0 = std::max(nMinX, PixelCeil(std::min(a.x, std::min(b.x, c.x))));
+		const int y0 = std::max(nMinY, PixelCeil(std::min(a.y, std::min(b.y, c.y))));
+		const int x1 = std::min(nMaxX, PixelCeil(std::max(a.x, std::max(b.x, c.x))) + 1);
+		const int y1 = std::min(nMaxY, PixelCeil(std::max(a.y, std::max(b.y, c.y))) + 1);
+
+		if (x0 >= x1 || y0 >= y1)
+		{
+			continue;
+		}
+
+		// Edge function of v0 -> v1 at p, A * p.x + B * p.y + C
+		const exVector2* edges[3][2] = { { &a, &b }, { &b, &c }, { &c, &a } };
+		float A[3], B[3], C[3];
+
+		for (int e = 0; e < 3; ++e)
+		{
+			const exVector2& v0 = *edges[e][0];
+			const exVector2& v1 = *edges[e][1];
+			A[e] = -(v1.y - v0.y);
+			B[e] = v1.x - v0.x;
+			C[e] = -(A[e] * v0.x + B[e] * v0.y);
+		}
+
+		for (int y = y0; y < y1; ++y)
+		{
+			const float py = y + 0.5f;
+			uint32_t* pRow = &mPixels[y * mWidth];
+			int x = x0;
+
+#if defined(RASTER_SSE2)
+			// 4 pixels per step, writing the covered ones and keeping the others
+			const __m128i color = _mm_set1_epi32((int)primitive.mColor);
+			const __m128 zero = _mm_setzero_ps();
+			const __m128 steps = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+
+			__m128 rowA[3], rowC[3];
+
+			for (int e = 0; e < 3; ++e)
+			{
+				rowA[e] = _mm_set1_ps(A[e]);
+				rowC[e] = _mm_set1_ps(B[e] * py + C[e]);
+			}
+
+			for (; x + 4 <= x1; x += 4)
+			{
+				const __m128 px = _mm_add_ps(_mm_set1_ps((float)x), steps);
+
+				__m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(rowA[0], px), rowC[0]), zero);
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(rowA[1], px), rowC[1]), zero));
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(rowA[2], px), rowC[2]), zero));
+
+				const __m128i mask = _mm_castps_si128(inside);
+				const __m128i destination = _mm_loadu_si128((const __m128i*)(pRow + x));
+				_mm_storeu_si128((__m128i*)(pRow + x), _mm_or_si128(_mm_and_si128(mask, color), _mm_andnot_si128(mask, destination)));
+			}
+#endif
+
+			for (; x < x1; ++x)
+			{
+				const float px = x + 0.5f;
+
+				if (A[0] * px + B[0] * py + C[0] >= 0.0f && A[1] * px + B[1] * py + C[1] >= 0.0f && A[2] * px + B[2] * py + C[2] >= 0.0f)
+				{
+					pRow[x] = primitive.mColor;
+				}
+			}
+		}
+	}
+}
+
+void SoftwareRasterizer::DrawGlyph(const RasterPrimitive& primitive, int nMinX, int nMinY, int nMaxX, int nMaxY)
+{
+	if (mGlyphAtlas == nullptr || primitive.mPage >= mGlyphAtlas->GetPageCount())
+	{
+		return;
+	}
+
+	const unsigned char* pCoverage = mGlyphAtlas->GetPagePixels(primitive.mPage);
+
+	const float fWidth = primitive.mBounds[2] - primitive.mBounds[0];
+	const float fHeight = primitive.mBounds[3] - primitive.mBounds[1];
+
+	if (fWidth <= 0.0f || fHeight <= 0.0f)
+	{
+		return;
+	}
+
+	const int x0 = std::max(nMinX, PixelCeil(primitive.mBounds[0]));
+	const int y0 = std::max(nMinY, PixelCeil(primitive.mBounds[1]));
+	const int x1 = std::min(nMaxX, PixelCeil(primitive.mBounds[2]));
+	const int y1 = std::min(nMaxY, PixelCeil(primitive.mBounds[3]));
+
+	if (x0 >= x1 || y0 >= y1)
+	{
+		return;
+	}
+
+	// Nearest texel of the page for each pixel center, the quad is usually exactly the size of the bitmap
+	const float fTexelsPerPixelX = (primitive.mTexCoords[2] - primitive.mTexCoords[0]) * kGlyphAtlasPageSize / fWidth;
+	const float fTexelsPerPixelY = (primitive.mTexCoords[3] - primitive.mTexCoords[1]) * kGlyphAtlasPageSize / fHeight;
+	const float fTexelX = primitive.mTexCoords[0] * kGlyphAtlasPageSize;
+	const float fTexelY = primitive.mTexCoords[1] * kGlyphAtlasPageSize;
+
+	// The color's alpha, from 0 to 256 so a full coverage stays 255
+	const uint32_t uOpacity = (uint32_t)(primitive.mOpacity * 256.0f);
+
+	for (int y = y0; y < y1; ++y)
+	{
+		const int nTexelY = std::min(kGlyphAtlasPageSize - 1, (int)(fTexelY + (y + 0.5f - primitive.mBounds[1]) * fTexelsPerPixelY));
+		const unsigned char* pCoverageRow = pCoverage + nTexelY * kGlyphAtlasPageSize;
+		uint32_t* pRow = &mPixels[y * mWidth];
+
+		for (int x = x0; x < x1; x += 4)
+		{
+			uint32_t alphas[4] = { 0, 0, 0, 0 };
+			const int nCount = std::min(4, x1 - x);
+
+			for (int i = 0; i < nCount; ++i)
+			{
+				const int nTexelX = std::min(kGlyphAtlasPageSize - 1, (int)(fTexelX + (x + i + 0.5f - primitive.mBounds[0]) * fTexelsPerPixelX));
+				alphas[i] = (pCoverageRow[nTexelX] * uOpacity) >> 8;
+			}
+
+			if (nCount == 4)
+			{
+				BlendSpan4(pRow + x, primitive.mColor, alphas);
+			}
+			else
+			{
+				for (int i = 0; i < nCount; ++i)
+				{
+					pRow[x + i] = BlendPixel(pRow[x + i], primitive.mColor, alphas[i]);
+				}
+			}
+		}
+	}
+}
+
+const uint32_t* SoftwareRasterizer::GetPixels() const
+{
+	return mPixels.data();
+}
+
+int SoftwareRasterizer::GetWidth() const
+{
+	return mWidth;
+}
+
+int SoftwareRasterizer::GetHeight() const
+{
+	return mHeight;
+}
+
+int SoftwareRasterizer::GetPrimitiveCount() const
+{
+	return (int)mPrimitives.size();
+}
+
+int SoftwareRasterizer::GetVertexCount() const
+{
+	return (int)mVertices.size();
+}
+
+bool SoftwareRasterizer::WriteImage(const char* szFile) const
+{
+	FILE* pFile = fopen(szFile, "wb");
+
+	if (pFile == nullptr)
+	{
+		return false;
+	}
+
+	fprintf(pFile, "P6\n%d %d\n255\n", mWidth, mHeight);
+
+	std::vector<unsigned char> row(mWidth * 3);
+
+	for (int y = 0; y < mHeight; ++y)
+	{
+		for (int x = 0; x < mWidth; ++x)
+		{
+			const uint32_t uPixel = mPixels[y * mWidth + x];
+			row[x * 3 + 0] = (unsigned char)(uPixel & 0xFF);
+			row[x * 3 + 1] = (unsigned char)((uPixel >> 8) & 0xFF);
+			row[x * 3 + 2] = (unsigned char)((uPixel >> 16) & 0xFF);
+		}
+
+		fwrite(row.data(), 1, row.size(), pFile);
+	}
+
+	return fclose(pFile) == 0;
+}
+
+uint32_t SoftwareRasterizer::PackColor(const exColor& color)
+{
+	// Only glyphs are blended, like the GL shaders everything else ignores the alpha
+	return (uint32_t)color.mColor[0] | ((uint32_t)color.mColor[1] << 8) | ((uint32_t)color.mColor[2] << 16) | (255u << 24);
+}
@@ -0,0 +1,276 @@
+#include "SpatialGrid.h"
+
+// Size of the cell table to start with, grown whenever it gets half full
+const int kInitialTableSize = 1024;
+
+SpatialGrid::SpatialGrid()
+{
+	mCellSize = 1.0f;
+	mInverseCellSize = 1.0f;
+	mCount = 0;
+
+	mTable.assign(kInitialTableSize, -1);
+}
+
+SpatialGrid::~SpatialGrid()
+{
+
+}
+
+void SpatialGrid::Initialize(float fCellSize)
+{
+	Clear();
+
+	mCellSize = fCellSize;
+	mInverseCellSize = 1.0f / fCellSize;
+}
+
+int SpatialGrid::Insert(const exVector2& v2Min, const exVector2& v2Max)
+{
+	int nID;
+
+	if (!mFreeIDs.empty())
+	{
+		nID = mFreeIDs.back();
+		mFreeIDs.pop_back();
+	}
+	else
+	{
+		nID = (int)mBounds.size();
+		mBounds.push_back(Bounds());
+		mRanges.push_back(CellRange());
+	}
+
+	Bounds& bounds = mBounds[nID];
+	bounds.mMinX = v2Min.x;
+	bounds.mMinY = v2Min.y;
+	bounds.mMaxX = v2Max.x;
+	bounds.mMaxY = v2Max.y;
+
+	mRanges[nID] = GetCellRange(v2Min, v2Max);
+	AddToCells(nID, mRanges[nID]);
+
+	++mCount;
+
+	return nID;
+}
+
+void SpatialGrid::Update(int nID, const exVector2& v2Min, const exVector2& v2Max)
+{
+	Bounds& bounds = mBounds[nID];
+	bounds.mMinX = v2Min.x;
+	bounds.mMinY = v2Min.y;
+	bounds.mMaxX = v2Max.x;
+	bounds.mMaxY = v2Max.y;
+
+	const CellRange range = GetCellRange(v2Min, v2Max);
+	CellRange& oldRange = mRanges[nID];
+
+	// Most moves stay within the same cells, which only takes the bounds above
+	if (range.mMinX == oldRange.mMinX && range.mMinY == oldRange.mMinY && range.mMaxX == oldRange.mMaxX && range.mMaxY == oldRange.mMaxY)
+	{
+		return;
+	}
+
+	// Leaving the cells that aren't overlapped anymore and joining the new ones, the ones in both are left alone
+	for (int nY = oldRange.mMinY; nY <= oldRange.mMaxY; ++nY)
+	{
+		for (int nX = oldRange.mMinX; nX <= oldRange.mMaxX; ++nX)
+		{
+			if (!range.Contains(nX, nY))
+			{
+				RemoveFromCell(nID, FindCell(nX, nY));
+			}
+		}
+	}
+
+	for (int nY = range.mMinY; nY <= range.mMaxY; ++nY)
+	{
+		for (int nX = range.mMinX; nX <= range.mMaxX; ++nX)
+		{
+			if (!oldRange.Contains(nX, nY))
+			{
+				mCells[FindOrAddCell(nX, nY)].mObjects.push_back(nID);
+			}
+		}
+	}
+
+	oldRange = range;
+}
+
+void SpatialGrid::Remove(int nID)
+{
+	RemoveFromCells(nID, mRanges[nID]);
+
+	// An empty range marks the ID as free
+	mRanges[nID].mMinX = 1;
+	mRanges[nID].mMinY = 1;
+	mRanges[nID].mMaxX = 0;
+	mRanges[nID].mMaxY = 0;
+
+	mFreeIDs.push_back(nID);
+	--mCount;
+}
+
+void SpatialGrid::InsertMany(const exVector2* pMins, const exVector2* pMaxs, int nCount, int* pIDs)
+{
+	// Growing once for all of them rather than as they come
+	const size_t uNewIDs = ((size_t)nCount > mFreeIDs.size()) ? nCount - mFreeIDs.size() : 0;
+	mBounds.reserve(mBounds.size() + uNewIDs);
+	mRanges.reserve(mRanges.size() + uNewIDs);
+
+	for (int i = 0; i < nCount; ++i)
+	{
+		pIDs[i] = Insert(pMins[i], pMaxs[i]);
+	}
+}
+
+void SpatialGrid::UpdateMany(const int* pIDs, const exVector2* pMins, const exVector2* pMaxs, int nCount)
+{
+	for (int i = 0; i < nCount; ++i)
+	{
+		Update(pIDs[i], pMins[i], pMaxs[i]);
+	}
+}
+
+void SpatialGrid::RemoveMany(const int* pIDs, int nCount)
+{
+	for (int i = 0; i < nCount; ++i)
+	{
+		Remove(pIDs[i]);
+	}
+}
+
+void SpatialGrid::Clear()
+{
+	mBounds.clear();
+	mRanges.clear();
+	mFreeIDs.clear();
+	mCount = 0;
+
+	mCells.clear();
+	mTable.assign(kInitialTableSize, -1);
+}
+
+int SpatialGrid::GetCount() const
+{
+	return mCount;
+}
+
+float SpatialGrid::GetCellSize() const
+{
+	return mCellSize;
+}
+
+SpatialGrid::CellRange SpatialGrid::GetCellRange(const exVector2& v2Min, const exVector2& v2Max) const
+{
+	CellRange range;
+	range.mMinX = ToCell(v2Min.x);
+	range.mMinY = ToCell(v2Min.y);
+	range.mMaxX = ToCell(v2Max.x);
+	range.mMaxY = ToCell(v2Max.y);
+
+	return range;
+}
+
+int SpatialGrid::FindCell(int nX, int nY) const
+{
+	const int64_t nKey = MakeCellKey(nX, nY);
+	const uint32_t uMask = (uint32_t)mTable.size() - 1;
+
+	// Linear probing, the table is never more than half full so a free slot always ends the search
+	for (uint32_t uSlot = HashCellKey(nKey) & uMask; ; uSlot = (uSlot + 1) & uMask)
+	{
+		const int nCell = mTable[uSlot];
+
+		if (nCell < 0 || mCells[nCell].mKey == nKey)
+		{
+			return nCell;
+		}
+	}
+}
+
+int SpatialGrid::FindOrAddCell(int nX, int nY)
+{
+	const int64_t nKey = MakeCellKey(nX, nY);
+	const uint32_t uMask = (uint32_t)mTable.size() - 1;
+
+	uint32_t uSlot = HashCellKey(nKey) & uMask;
+
+	for (; mTable[uSlot] >= 0; uSlot = (uSlot + 1) & uMask)
+	{
+		if (mCells[mTable[uSlot]].mKey == nKey)
+		{
+			return mTable[uSlot];
+		}
+	}
+
+	const int nCell = (int)mCells.size();
+	mCells.push_back(Cell());
+	mCells.back().mKey = nKey;
+	mTable[uSlot] = nCell;
+
+	if (mCells.size() * 2 > mTable.size())
+	{
+		GrowTable();
+	}
+
+	return nCell;
+}
+
+void SpatialGrid::AddToCells(int nID, const CellRange& range)
+{
+	for (int nY = range.mMinY; nY <= range.mMaxY; ++nY)
+	{
+		for (int nX = range.mMinX; nX <= range.mMaxX; ++nX)
+		{
+			mCells[FindOrAddCell(nX, nY)].mObjects.push_back(nID);
+		}
+	}
+}
+
+void SpatialGrid::RemoveFromCells(int nID, const CellRange& range)
+{
+	for (int nY = range.mMinY; nY <= range.mMaxY; ++nY)
+	{
+		for (int nX = range.mMinX; nX <= range.mMaxX; ++nX)
+		{
+			RemoveFromCell(nID, FindCell(nX, nY));
+		}
+	}
+}
+
+void SpatialGrid::RemoveFromCell(int nID, int nCell)
+{
+	std::vector<int>& objects = mCells[nCell].mObjects;
+
+	// Cells hold a handful of objects, the order within one doesn't matter
+	for (size_t i = 0; i < objects.size(); ++i)
+	{
+		if (objects[i] == nID)
+		{
+			objects[i] = objects.back();
+			objects.pop_back();
+			return;
+		}
+	}
+}
+
+void SpatialGrid::GrowTable()
+{
+	mTable.assign(mTable.size() * 2, -1);
+
+	const uint32_t uMask = (uint32_t)mTable.size() - 1;
+
+	for (int nCell = 0; nCell < (int)mCells.size(); ++nCell)
+	{
+		uint32_t uSlot = HashCellKey(mCells[nCell].mKey) & uMask;
+
+		while (mTable[uSlot] >= 0)
+		{
+			uSlot = (uSlot + 1) & uMask;
+		}
+
+		mTable[uSlot] = nCell;
+	}
+}
@@ -0,0 +1,144 @@
+#include "StreamBuffer.h"
+#include "GLStateCache.h"
+#include "GLEW.h"
+
+// How long a single wait on a fence may block before trying again, in nanoseconds
+const GLuint64 kFenceTimeout = 1000000;
+
+StreamBuffer::StreamBuffer()
+{
+	mStateCache = nullptr;
+	mTarget = 0;
+	mBuffer = 0;
+	mRegionSize = 0;
+	mRegion = 0;
+	mHead = 0;
+	mRegionReady = false;
+	mBytesStreamedThisFrame = 0;
+	mBytesStreamedLastFrame = 0;
+
+	for (int i = 0; i < kFramesInFlight; ++i)
+	{
+		mFences[i] = nullptr;
+	}
+}
+
+StreamBuffer::~StreamBuffer()
+{
+	// The GL objects are released along with the context
+}
+
+void StreamBuffer::Initialize(GLStateCache& stateCache, GLenum eTarget, size_t uRegionSize)
+{
+	mStateCache = &stateCache;
+	mTarget = eTarget;
+	mRegionSize = uRegionSize;
+
+	glGenBuffers(1, &mBuffer);
+	mStateCache->BindBuffer(mTarget, mBuffer);
+	glBufferData(mTarget, mRegionSize * kFramesInFlight, nullptr, GL_STREAM_DRAW);
+}
+
+void* StreamBuffer::Map(size_t uSize, size_t uAlignment, size_t& uOutOffset)
+{
+	if (!mRegionReady)
+	{
+		WaitForRegion();
+	}
+
+	// Aligning the absolute offset, so vertex allocations can be addressed by index from the start of the buffer
+	size_t uRegionStart = mRegion * mRegionSize;
+	size_t uOffset = ((uRegionStart + mHead + uAlignment - 1) / uAlignment) * uAlignment;
+
+	if (uOffset + uSize > uRegionStart + mRegionSize)
+	{
+		Grow(mHead + uSize + uAlignment);
+
+		uRegionStart = mRegion * mRegionSize;
+		uOffset = ((uRegionStart + mHead + uAlignment - 1) / uAlignment) * uAlignment;
+	}
+
+	mHead = uOffset + uSize - uRegionStart;
+	mBytesStreamedThisFrame += uSize;
+	uOutOffset = uOffset;
+
+	// Nothing the GPU may still be reading lives in this range, so there is no need for the driver to synchronize
+	mStateCache->BindBuffer(mTarget, mBuffer);
+	return glMapBufferRange(mTarget, uOffset, uSize, GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+}
+
+void StreamBuffer::Unmap()
+{
+	mStateCache->BindBuffer(mTarget, mBuffer);
+	glUnmapBuffer(mTarget);
+}
+
+void StreamBuffer::EndFrame()
+{
+	if (mHead > 0)
+	{
+		mFences[mRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		mRegion = (mRegion + 1) % kFramesInFlight;
+	}
+
+	mHead = 0;
+	mRegionReady = false;
+
+	mBytesStreamedLastFrame = mBytesStreamedThisFrame;
+	mBytesStreamedThisFrame = 0;
+}
+
+GLuint StreamBuffer::GetBuffer() const
+{
+	return mBuffer;
+}
+
+size_t StreamBuffer::GetBytesStreamedLastFrame() const
+{
+	return mBytesStreamedLastFrame;
+}
+
+void StreamBuffer::WaitForRegion()
+{
+	GLsync fence = mFences[mRegion];
+
+	if (fence != nullptr)
+	{
+		// Only flushing on the first try, after that the fence is guaranteed to be on its way to the GPU
+		GLbitfield uFlags = GL_SYNC_FLUSH_COMMANDS_BIT;
+
+		while (glClientWaitSync(fence, uFlags, kFenceTimeout) == GL_TIMEOUT_EXPIRED)
+		{
+			uFlags = 0;
+		}
+
+		glDeleteSync(fence);
+		mFences[mRegion] = nullptr;
+	}
+
+	mRegionReady = true;
+}
+
+void StreamBuffer::Grow(size_t uRequiredRegionSize)
+{
+	while (mRegionSize < uRequiredRegionSize)
+	{
+		mRegionSize *= 2;
+	}
+
+	for (int i = 0; i < kFramesInFlight; ++i)
+	{
+		if (mFences[i] != nullptr)
+		{
+			glDeleteSync(mFences[i]);
+			mFences[i] = nullptr;
+		}
+	}
+
+	// Anything already mapped this frame is left behind in the orphaned storage, which is why callers map a frame's data in one go
+	mStateCache->BindBuffer(mTarget, mBuffer);
+	glBufferData(mTarget, mRegionSize * kFramesInFlight, nullptr, GL_STREAM_DRAW);
+
+	mRegion = 0;
+	mHead = 0;
+}
@@ -0,0 +1,121 @@
+#include "SystemScheduler.h"
+#include "Profiler.h"
+
+SystemScheduler::SystemScheduler()
+{
+	mDeltaT = 0.0f;
+}
+
+SystemScheduler::~SystemScheduler()
+{
+
+}
+
+int SystemScheduler::AddSystem(const char* szName, std::function<void(float fDeltaT)> function)
+{
+	System system;
+	system.mName = szName;
+	system.mFunction = std::move(function);
+
+	mSystems.push_back(std::move(system));
+	mGraph.reset();
+
+	return (int)mSystems.size() - 1;
+}
+
+void SystemScheduler::AddAccess(int nSystem, int nType, RESOURCE_ACCESS eAccess)
+{
+	mSystems[nSystem].mAccesses.emplace_back(nType, eAccess);
+	mGraph.reset();
+}
+
+void SystemScheduler::Run(JobSystem& jobSystem, float fDeltaT)
+{
+	PROFILE_FUNCTION();
+
+	if (mGraph == nullptr)
+	{
+		BuildGraph();
+	}
+
+	// Read by the stages, which all start after this
+	mDeltaT = fDeltaT;
+
+	mGraph->Execute(jobSystem);
+	mGraph->Wait(jobSystem);
+}
+
+int SystemScheduler::GetSystemCount() const
+{
+	return (int)mSystems.size();
+}
+
+const char* SystemScheduler::GetSystemName(int nSystem) const
+{
+	return mSystems[nSystem].mName;
+}
+
+float SystemScheduler::GetSystemTime(int nSystem) const
+{
+	return (mGraph != nullptr) ? mGraph->GetStageTime(nSystem) : 0.0f;
+}
+
+bool SystemScheduler::Conflicts(const System& a, const System& b)
+{
+	for (const std::pair<int, RESOURCE_ACCESS>& accessA : a.mAccesses)
+	{
+		for (const std::pair<int, RESOURCE_ACCESS>& accessB : b.mAccesses)
+		{
+			if (accessA.first == accessB.first && (accessA.second == RESOURCE_ACCESS::WRITE || accessB.second == RESOURCE_ACCESS::WRITE))
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+void SystemScheduler::BuildGraph()
+{
+	mGraph.reset(new FrameGraph());
+
+	// A resource per component type, the systems run and finish within Run so none of them outlives it
+	int resources[kMaxComponentTypes];
+
+	for (int nType = 0; nType < kMaxComponentTypes; ++nType)
+	{
+		resources[nType] = -1;
+	}
+
+	for (int nSystem = 0; nSystem < (int)mSystems.size(); ++nSystem)
+	{
+		System& system = mSystems[nSystem];
+
+		mGraph->AddStage(system.mName, STAGE_THREAD::ANY, [this, nSystem]()
+		{
+			mSystems[nSystem].mFunction(mDeltaT);
+		});
+
+		// Only the closest conflicting system would be enough, the graph doesn't mind the rest
+		for (int nEarlier = 0; nEarlier < nSystem; ++nEarlier)
+		{
+			if (Conflicts(mSystems[nEarlier], system))
+			{
+				mGraph->AddDependency(nSystem, nEarlier);
+			}
+		}
+
+		for (const std::pair<int, RESOURCE_ACCESS>& access : system.mAccesses)
+		{
+			if (resources[access.first] < 0)
+			{
+				resources[access.first] = mGraph->AddResource("Component", false);
+			}
+
+			mGraph->AddAccess(nSystem, resources[access.first], access.second);
+		}
+	}
+
+	mGraph->Validate();
+}
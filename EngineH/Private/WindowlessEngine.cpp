@@ -0,0 +1,159 @@
+#include "WindowlessEngine.h"
+#include "Logger.h"
+#include "Profiler.h"
+
+// The step every frame advances the game by, since there is no display to keep up with
+const float kWindowlessFrameTime = 1 / 60.0f;
+
+WindowlessEngine::WindowlessEngine()
+{
+	mGame = nullptr;
+
+	mFrameLimit = 0;
+
+	// Same default camera as EngineH, so every engine shows the same picture
+	mCameraPosition = exVector2(kViewportWidth / 2.0f, kViewportHeight / 2.0f);
+	mCameraZoom = 1.0f;
+
+	mLineWidth = 1.0f;
+
+	mFontCount = 0;
+
+	// Started right away, games can use it as soon as they are initialized
+	mJobSystem.Initialize();
+}
+
+WindowlessEngine::~WindowlessEngine()
+{
+
+}
+
+void WindowlessEngine::Run(exGameInterface* pGame)
+{
+	// Attaching the engine to a game
+	mGame = pGame;
+
+	Profiler::SetThreadName("Main");
+
+	for (int nFrame = 0; mFrameLimit == 0 || nFrame < mFrameLimit; ++nFrame)
+	{
+		PROFILE_SCOPE("Frame");
+		OnFrame(kWindowlessFrameTime);
+	}
+}
+
+int WindowlessEngine::RecordFrame(float fDeltaT)
+{
+	// There are no events without a window
+	mGame->OnEventsConsumed();
+
+	// Running the game, once or at its fixed step, and letting it draw
+	mFixedTimestep.RunFrame(mGame, fDeltaT);
+
+	// Gathering what every thread drew into the frame
+	mCommandRecorder.MergeInto(mCommandBuffer);
+
+	// Dropping what the camera can't see, like EngineH does
+	return mCommandBuffer.CullToView(mCameraPosition, mCameraZoom);
+}
+
+void WindowlessEngine::DrawLine(const exVector2& v2P1, const exVector2& v2P2, const exColor& color, int nLayer)
+{
+	mCommandRecorder.GetThreadBuffer().AddLine(v2P1, v2P2, mLineWidth, color, nLayer);
+}
+
+void WindowlessEngine::DrawBox(const exVector2& v2P1, const exVector2& v2P2, const exColor& color, int nLayer)
+{
+	mCommandRecorder.GetThreadBuffer().AddBox(v2P1, v2P2, color, nLayer);
+}
+
+void WindowlessEngine::DrawLineBox(const exVector2& v2P1, const exVector2& v2P2, const exColor& color, int nLayer)
+{
+	mCommandRecorder.GetThreadBuffer().AddLineBox(v2P1, v2P2, mLineWidth, color, nLayer);
+}
+
+void WindowlessEngine::DrawCircle(const exVector2& v2Center, float fRadius, const exColor& color, int nLayer)
+{
+	mCommandRecorder.GetThreadBuffer().AddCircle(v2Center, fRadius, color, nLayer);
+}
+
+void WindowlessEngine::DrawLineCircle(const exVector2& v2Center, float fRadius, const exColor& color, int nLayer)
+{
+	mCommandRecorder.GetThreadBuffer().AddLineCircle(v2Center, fRadius, mLineWidth, color, nLayer);
+}
+
+int WindowlessEngine::LoadFont(const char* szFile, int nPTSize)
+{
+	// Rasterized for real even when nothing is drawn, text layout needs the glyphs' metrics
+	Font font;
+
+	if (!font.Load(szFile, nPTSize, mGlyphAtlas))
+	{
+		return -1;
+	}
+
+	mFonts.push_back(font);
+	mFontCount.store((int)mFonts.size(), std::memory_order_release);
+
+	return (int)mFonts.size() - 1;
+}
+
+void WindowlessEngine::DrawText(int nFontID, const exVector2& v2Position, const char* szText, const exColor& color, int nLayer)
+{
+	if (nFontID < 0 || nFontID >= mFontCount.load(std::memory_order_acquire) || szText == nullptr)
+	{
+		return;
+	}
+
+	mCommandRecorder.GetThreadBuffer().AddText(nFontID, v2Position, szText, color, nLayer);
+}
+
+void WindowlessEngine::SetCamera(const exVector2& v2Position, float fZoom)
+{
+	mCameraPosition = v2Position;
+
+	// Culling and the projection both divide by the zoom, so anything but a positive one (NaN included) keeps the last zoom
+	if (!(fZoom > 0.0f))
+	{
+		LOG_WARNING("Ignoring camera zoom %f, it has to be above 0\n", fZoom);
+		return;
+	}
+
+	mCameraZoom = fZoom;
+}
+
+void WindowlessEngine::SetLineWidth(float fWidth)
+{
+	mLineWidth = fWidth;
+}
+
+void WindowlessEngine::SetFixedTimestep(float fStep, int nMaxSteps)
+{
+	mFixedTimestep.SetStep(fStep, nMaxSteps);
+}
+
+JobSystem& WindowlessEngine::GetJobSystem()
+{
+	return mJobSystem;
+}
+
+RenderStats WindowlessEngine::GetRenderStats()
+{
+	return mStats;
+}
+
+bool WindowlessEngine::SetRenderStatsFile(const char* szFile)
+{
+	if (szFile == nullptr)
+	{
+		mStatsWriter.Close();
+		return true;
+	}
+
+	return mStatsWriter.Open(szFile);
+}
+
+void WindowlessEngine::SetFrameLimit(int nFrames)
+{
+	mFrameLimit = nFrames;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include "EngineTypes.h"
+
+// Math over whole arrays at once, with SSE on x86 and NEON on ARM, plain C++ everywhere else
+// Points and vectors are passed as structures of arrays, one array of x and one of y, so every lane of a register holds
+// a different point, the arrays don't have to be aligned and any count works, the remainder is done one at a time
+class BatchMath
+{
+public:
+	// pOut = a * b, with the engine's row vector convention that means a point is transformed by a and then by b
+	// pOut may be a or b
+	static void MultiplyMatrix(exMatrix4* pOut, const exMatrix4& a, const exMatrix4& b);
+
+	// Transforms nCount points (z = 0, w = 1) by the matrix, the output arrays may be the input ones
+	static void TransformPoints(const exMatrix4& matrix, const float* pX, const float* pY, float* pOutX, float* pOutY, int nCount);
+
+	// Normalizes nCount vectors in place, zero length vectors are left at zero
+	static void NormalizeVectors(float* pX, float* pY, int nCount);
+
+	// Smallest box containing the nCount points, which has to be at least 1
+	static void ComputeBounds(const float* pX, const float* pY, int nCount, exVector2& v2Min, exVector2& v2Max);
+
+	// Writes the indices of the nCount boxes touching the rectangle to pIndices, in increasing order, and returns how many
+	// Boxes are given by their corners, one array per coordinate, pIndices needs room for nCount
+	static int FindOverlappingBounds(const float* pMinX, const float* pMinY, const float* pMaxX, const float* pMaxY, int nCount,
+		const exVector2& v2RectMin, const exVector2& v2RectMax, uint32_t* pIndices);
+
+	// The instruction set the functions were compiled for
+	static const char* GetInstructionSet();
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "RenderCommandBuffer.h"
+
+// Gives every thread that draws its own RenderCommandBuffer, so the game can draw from several threads at once
+// A thread finds its buffer through a thread local cache, only the first draw of a thread takes the lock to create it
+// At the end of the frame the buffers are merged into one, in the order the threads first drew in, and sorted from there
+// like any other frame, so draws from different threads on the same layer have no particular order between them
+class CommandRecorder
+{
+public:
+	CommandRecorder();
+	~CommandRecorder();
+
+	// The calling thread's buffer
+	RenderCommandBuffer& GetThreadBuffer();
+
+	// Moves every thread's commands into the target and leaves their buffers empty, no thread can be drawing meanwhile
+	void MergeInto(RenderCommandBuffer& target);
+
+	int GetThreadCount() const;
+
+private:
+	RenderCommandBuffer& RegisterThread();
+
+	struct ThreadBuffer
+	{
+		std::thread::id mThread;
+		std::unique_ptr<RenderCommandBuffer> mBuffer;
+	};
+
+	// Tells recorders apart in the thread local cache, unlike their addresses they are never reused
+	uint64_t mID;
+
+	mutable std::mutex mMutex;
+	std::vector<ThreadBuffer> mThreadBuffers;
+};
@@ -1,8 +1,28 @@
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
 #include "EngineInterface.h"
 #include "GameInterface.h"
 #include "EngineTypes.h"
+#include "RenderBatch.h"
+#include "RenderCommandBuffer.h"
+#include "CommandRecorder.h"
+#include "ShaderProgram.h"
+#include "GLStateCache.h"
+#include "StreamBuffer.h"
+#include "GpuTimer.h"
+#include "RenderStats.h"
+#include "FrameBatcher.h"
+#include "Font.h"
+#include "GlyphAtlas.h"
+#include "FixedTimestep.h"
+#include "JobSystem.h"
+#include "FrameGraph.h"
+#include "FrameScheduler.h"
 
 // Forward declaring classes, types and structs in use 
 struct SDL_Window;
@@ -13,19 +33,68 @@ typedef unsigned int GLuint;
 typedef unsigned int GLenum;
 
 #define ATTRIB_POINT_1 0
-#define ATTRIB_POINT_2 1
+#define ATTRIB_INSTANCE_CENTER 1
+#define ATTRIB_INSTANCE_EXTENTS 2
+#define ATTRIB_INSTANCE_COLOR 3
+#define ATTRIB_INSTANCE_LAYER 4
+#define ATTRIB_VERTEX_COLOR 1
+#define ATTRIB_VERTEX_TEXCOORDS 2
 #define countof(x) (sizeof(x) / sizeof(0[x]))
 
+#define CAMERA_BLOCK_BINDING 0
+
+// Contents of the std140 "Camera" uniform block every engine shader declares
+struct CameraBlock
+{
+	exMatrix4 mView;
+	exMatrix4 mProjection;
+};
+
+// Frames the game thread may record ahead of the one the render thread is drawing
+const int kMaxFramesInFlight = 2;
+
+// Everything the game thread hands over to the render thread for one frame
+struct RenderFrame
+{
+	RenderCommandBuffer mCommandBuffer;
+	exColor mClearColor;
+	exVector2 mCameraPosition;
+	float mCameraZoom;
+	int mCulledCommands;
+
+	// The frame's sorted and batched draws, built by the frame graph's sort stage
+	FrameBatcher mFrameBatcher;
+};
+
 struct GraphicsContext
 {
-	GLuint mBoxShaderProgram;
-	GLuint mCircleShaderProgram;
+	// Registry of the engine's programs, indexed by the program stored in the sort keys
+	ShaderProgram mShaderPrograms[(int)SHADER_PROGRAM::COUNT];
+	// Uniform buffer holding the CameraBlock, written once per frame and shared by all the programs
+	GLuint mCameraBuffer;
 	GLint mUniformAngle;
-	GLuint mVBOPoint;
-	GLuint mVAOPoint;
-	GLuint mVBOPoint_Circle;
-	GLuint mVAOPoint_Circle;
+	// Every bind the engine does goes through this, so redundant ones never reach the driver
+	GLStateCache mStateCache;
+	GLuint mVBOUnitQuad;
+	StreamBuffer mInstanceStream;
+	GLuint mVAOBatch;
+	StreamBuffer mVertexStream;
+	GLuint mVAOVertices;
 	float mAngle;
+
+	// Frames being recorded or waiting to be drawn, used round robin
+	RenderFrame mFrames[kMaxFramesInFlight + 1];
+
+	// Fonts are rasterized into the atlas on the CPU when loaded, its pages are uploaded to the textures once there is a context
+	std::vector<Font> mFonts;
+	GlyphAtlas mGlyphAtlas;
+	std::vector<GLuint> mAtlasTextures;
+	// Where this frame's data starts in the two streams
+	size_t mInstanceStreamOffset;
+	int mVertexStreamBase;
+
+	// Times every pass and batch of the frames on the GPU, read back a few frames later
+	GpuTimer mGpuTimer;
 };
 
 enum class BUFFER_INDEX : GLuint
@@ -68,7 +137,46 @@ public:
 	// draw text with a given loaded font
 	virtual void				DrawText(int nFontID, const exVector2& v2Position, const char* szText, const exColor& color, int nLayer);
 
-	virtual void				DrawUsingShaderProgram(GLuint shaderProgram, GLuint vertexArrayObject, const exVector2& position, const exColor& color, int nLayer, int numberOfVertices);
+	// move the camera, v2Position is the world position shown at the center of the viewport
+	virtual void				SetCamera(const exVector2& v2Position, float fZoom);
+
+	// width in world units of the lines and outlines drawn from now on
+	virtual void				SetLineWidth(float fWidth);
+
+	// run the simulation at a fixed step, at most nMaxSteps times per frame, 0 goes back to one step per frame
+	virtual void				SetFixedTimestep(float fStep, int nMaxSteps);
+
+	// workers run the game's jobs next to its own thread
+	virtual JobSystem&			GetJobSystem();
+
+	// the draw counts are those of the last frame drawn, which the render thread may still be a frame behind on
+	virtual RenderStats			GetRenderStats();
+
+	virtual bool				SetRenderStatsFile(const char* szFile);
+
+	// Number of bytes of instance and vertex data streamed to the GPU during the last frame
+	size_t						GetStreamedBytesLastFrame() const;
+
+	// Number of binds and state changes skipped during the last frame because they matched the current GL state
+	int							GetElidedStateChangesLastFrame() const;
+
+	// How frames are paced, fTargetRate is the frames per second FIXED caps at, can be called before or during Run
+	void						SetFramePacing(FRAME_PACING ePacing, float fTargetRate = 60.0f);
+
+	// Average, min, max and jitter of the recent frame times
+	FrameTimings				GetFrameTimings() const;
+
+	// Time each stage of the last frame took, the frame graph's stages followed by the render thread's submit
+	std::vector<StageTiming>	GetStageTimings() const;
+
+	// CPU and GPU time of each pass and batch of the latest frame the GPU finished, tells submission bound frames from fill bound ones
+	GpuTimings					GetGpuTimings() const;
+
+	// Submit from a render thread owning the GL context while the game records the next frame, nFramesInFlight (1 or 2) bounds
+	// how far ahead the game can get, disabled everything runs one after the other on the game's thread, has to be set before Run
+	void						SetRenderThread(bool bEnabled, int nFramesInFlight = 1);
+
+	virtual void				DrawUsingShaderProgram(const DrawRange& range);
 
 private:
 	// Class Functions
@@ -78,24 +186,116 @@ private:
 
 	void ConsumeEvents();
 
+	// Hands the pacing to the scheduler and sets the swap interval it needs on the context
+	void ApplyFramePacing();
+
+	void ApplySwapInterval();
+
+	// Hands the GL context over to the render thread, false if it couldn't take it
+	bool StartRenderThread();
+
+	// Lets the render thread finish the frame it is on, and takes the context back
+	void StopRenderThread();
+
+	void RenderThreadLoop();
+
+	// Passes the recorded frame on to the render thread, then waits until there is a free frame to record the next one into
+	void SubmitFrame();
+
 	void InitializeShaders();
 
 	void InitializeSquareShaders();
 
 	void InitializeCircleShaders();
 
-	static GLuint CompileShader( GLenum eShaderType, const GLchar* pSource );
+	void InitializeLineShaders();
+
+	void InitializeTextShaders();
+
+	void InitializeBatchBuffers();
+
+	// Declares the stages of the frames recorded into the slot, what they touch and what they wait for
+	void BuildFrameGraph(int nSlot);
+
+	// Clears, flushes and presents a recorded frame, on the render thread or the game's one without it
+	void DrawFrame(RenderFrame& frame);
+
+	// Streams the frame's batches and issues one draw per run of commands sharing a shader
+	void FlushBatches(RenderFrame& frame);
+
+	// Creates the textures of new atlas pages and uploads the ones fonts were rasterized into since the last call
+	void UpdateAtlasTextures();
+
+	void InitializeCamera();
 
-	static GLuint LinkProgram( GLuint gluVertexShader, GLuint gluFragmentShader );
+	// Writes the frame's camera view and projection into the camera uniform buffer, once per frame
+	void UpdateCamera(const RenderFrame& frame);
+
+	// Compiles and links the two sources into the program's registry slot, and connects it to the camera block
+	void CreateShaderProgram(SHADER_PROGRAM eProgram, const GLchar* szVertexSource, const GLchar* szFragmentSource);
+
+	static GLuint CompileShader( GLenum eShaderType, const GLchar* pSource );
 
 	void GL_IgnoreError();
 
 private:
 
 	SDL_Window * mWindow;												// It serves as a canvas to out put what is drawn by the GPU
-	SDL_GLContext * mGLContext;											// Tracks the contexts of the things this specific instance of the Engine draws 
+	SDL_GLContext mGLContext;											// Tracks the contexts of the things this specific instance of the Engine draws 
 	exGameInterface* mGame;
 
+	exVector2 mCameraPosition;
+	float mCameraZoom;
+	float mLineWidth;
+
+	FixedTimestep mFixedTimestep;
+
+	JobSystem mJobSystem;
+
+	FrameScheduler mFrameScheduler;
+	FRAME_PACING mFramePacing;
+	float mTargetFrameRate;
+
+	// The frame the game is recording into
+	int mRecordingFrame;
+
+	// Frames are handed over by counting, the render thread draws while it has drawn fewer than were submitted
+	std::thread mRenderThread;
+	std::mutex mRenderMutex;
+	std::condition_variable mFrameSubmitted;
+	std::condition_variable mFrameDrawn;
+	uint64_t mSubmittedFrames;
+	uint64_t mDrawnFrames;
+	bool mRenderThreadEnabled;
+	bool mRenderThreadRunning;
+	bool mRenderThreadFailed;
+	bool mRenderThreadShutdown;
+	int mFramesInFlight;
+	// Set when the pacing changes while the render thread owns the context
+	std::atomic<bool> mSwapIntervalDirty;
+
+	// Every thread drawing during the game's Run records into its own buffer, merged into the frame once it is done
+	CommandRecorder mCommandRecorder;
+
+	// One graph per frame slot, so a frame's cull and sort can still be running while the next frame's graph executes
+	// Declared after the job system so they are destroyed, and waited for, before it
+	FrameGraph mFrameGraphs[kMaxFramesInFlight + 1];
+	float mFrameDeltaT;
+	std::atomic<float> mSubmitTime;
+
+	// Fonts are loaded on the game thread and read by the render thread when flushing
+	std::mutex mFontMutex;
+	// The number of fonts, stored once a font is in so DrawText can check ids from any thread without the mutex
+	std::atomic<int> mFontCount;
+
+	// Counted by whichever thread draws, and handed over once the frame is presented
+	RenderStats mDrawStats;
+	RenderStats mDrawnStats;
+	std::mutex mStatsMutex;
+	uint64_t mFrameCount;
+	float mOnFrameTime;
+	RenderStatsWriter mStatsWriter;
+
 	static GraphicsContext gc;
 };
 
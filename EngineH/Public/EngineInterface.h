@@ -12,7 +12,7 @@
 //-----------------------------------------------------------------
 //-----------------------------------------------------------------
 
-const int kEngineVersion = 1;			// modify when API changes
+const int kEngineVersion = 6;			// modify when API changes
 const int kViewportWidth = 800;
 const int kViewportHeight = 600;
 
@@ -20,6 +20,8 @@ const int kViewportHeight = 600;
 //-----------------------------------------------------------------
 
 class exGameInterface;
+class JobSystem;
+struct RenderStats;
 
 //-----------------------------------------------------------------
 //-----------------------------------------------------------------
@@ -31,6 +33,9 @@ public:
 								// causes all initialization to occur and the main loop to start 
 	virtual void				Run( exGameInterface* pGameInterface ) = 0;
 
+								// the draw functions can be called from several threads at once while the game runs or renders
+								// everything else only from the thread the game is run on
+
 								// draw a line
 	virtual void				DrawLine( const exVector2& v2P1, const exVector2& v2P2, const exColor& color, int nLayer ) = 0;
 
@@ -52,6 +57,28 @@ public:
 								// draw text with a given loaded font
 	virtual void				DrawText( int nFontID, const exVector2& v2Position, const char* szText, const exColor& color, int nLayer ) = 0;
 
+								// move the camera, v2Position is the world position shown at the center of the viewport
+								// a zoom above 1 magnifies, the default camera is centered on the viewport with a zoom of 1
+								// a zoom of 0 or less is ignored, the camera keeps the last one
+	virtual void				SetCamera( const exVector2& v2Position, float fZoom ) = 0;
+
+								// width in world units of everything drawn by DrawLine, DrawLineBox and DrawLineCircle from now on, 1 by default
+	virtual void				SetLineWidth( float fWidth ) = 0;
+
+								// run the simulation at a fixed step of fStep seconds, at most nMaxSteps times per frame
+								// draw in exGameInterface::Render when using it, an fStep of 0 goes back to one Run per frame
+	virtual void				SetFixedTimestep( float fStep, int nMaxSteps ) = 0;
+
+								// the engine's job system, to spread the game's work over every core
+								// the thread the game runs on takes part in it while it waits on jobs
+	virtual JobSystem&			GetJobSystem() = 0;
+
+								// draw calls, uploads, binds and CPU time of the last frame the engine finished
+	virtual RenderStats			GetRenderStats() = 0;
+
+								// append the stats of every frame to a CSV file from now on, nullptr stops, false if the file can't be created
+	virtual bool				SetRenderStatsFile( const char* szFile ) = 0;
+
 };
 
 //-----------------------------------------------------------------
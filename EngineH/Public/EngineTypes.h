@@ -18,10 +18,8 @@ struct exVector2
 public:
 	exVector2() = default;
 
-	exVector2(float x, float y)
+	constexpr exVector2(float x, float y) : x(x), y(y)
 	{
-		this->x = x;
-		this->y = y;
 	}
 
 	void Normalize()
@@ -31,32 +29,89 @@ public:
 		y = y / magnitude;
 	}
 
-	float Magnitude()
+	exVector2 Normalized() const
 	{
-		return (sqrt((x*x) + (y*y)));
+		float magnitude = Magnitude();
+		return { x / magnitude, y / magnitude };
+	}
+
+	float Magnitude() const
+	{
+		return (sqrtf((x*x) + (y*y)));
+	}
+
+	constexpr float SquaredMagnitude() const
+	{
+		return (x*x) + (y*y);
 	}
 
-	bool operator== (exVector2& pVector)
+	constexpr bool operator== (const exVector2& pVector) const
 	{
 		return (x == pVector.x && y == pVector.y);
 	}
 
-	exVector2 operator* (float pNumber)
+	constexpr bool operator!= (const exVector2& pVector) const
+	{
+		return !(*this == pVector);
+	}
+
+	constexpr exVector2 operator* (float pNumber) const
 	{
 		return { this->x * pNumber , this->y * pNumber };
 	}
 
-	exVector2 operator- (exVector2& pVector)
+	constexpr exVector2 operator/ (float pNumber) const
+	{
+		return { this->x / pNumber , this->y / pNumber };
+	}
+
+	constexpr exVector2 operator+ (const exVector2& pVector) const
+	{
+		return { this->x + pVector.x , this->y + pVector.y };
+	}
+
+	constexpr exVector2 operator- (const exVector2& pVector) const
 	{
 		return { this->x - pVector.x , this->y - pVector.y };
 	}
 
-	static float DotProduct(exVector2& pVector1, exVector2& pVector2)
+	constexpr exVector2 operator- () const
+	{
+		return { -this->x , -this->y };
+	}
+
+	exVector2& operator+= (const exVector2& pVector)
+	{
+		x += pVector.x;
+		y += pVector.y;
+		return *this;
+	}
+
+	exVector2& operator-= (const exVector2& pVector)
+	{
+		x -= pVector.x;
+		y -= pVector.y;
+		return *this;
+	}
+
+	exVector2& operator*= (float pNumber)
+	{
+		x *= pNumber;
+		y *= pNumber;
+		return *this;
+	}
+
+	static constexpr float DotProduct(const exVector2& pVector1, const exVector2& pVector2)
 	{
 		return (pVector1.x * pVector2.x + pVector1.y * pVector2.y);
 	}
 };
 
+constexpr exVector2 operator* (float pNumber, const exVector2& pVector)
+{
+	return pVector * pNumber;
+}
+
 
 //-----------------------------------------------------------------
 //-----------------------------------------------------------------
@@ -101,6 +156,17 @@ public:
 	exMatrix4() = default;
 	~exMatrix4() = default;
 
+	constexpr exMatrix4(	float f11, float f12, float f13, float f14,
+							float f21, float f22, float f23, float f24,
+							float f31, float f32, float f33, float f34,
+							float f41, float f42, float f43, float f44 )
+		: m11(f11), m12(f12), m13(f13), m14(f14)
+		, m21(f21), m22(f22), m23(f23), m24(f24)
+		, m31(f31), m32(f32), m33(f33), m34(f34)
+		, m41(f41), m42(f42), m43(f43), m44(f44)
+	{
+	}
+
 	float* ToFloatPtr()
 	{
 		return &m11;
@@ -111,47 +177,56 @@ public:
 		return &m11;
 	}
 
-	static void exOrthographicProjectionMatrix(exMatrix4* pOut, float fWidth, float fHeight, float fNearPlane, float fFarPlane)
+	// this * other, a point is transformed by this and then by other (row vectors), computed by BatchMath::MultiplyMatrix
+	exMatrix4 operator* (const exMatrix4& other) const;
+
+	static constexpr exMatrix4 exIdentityMatrix()
+	{
+		return exMatrix4(	1.0f, 0.0f, 0.0f, 0.0f,
+							0.0f, 1.0f, 0.0f, 0.0f,
+							0.0f, 0.0f, 1.0f, 0.0f,
+							0.0f, 0.0f, 0.0f, 1.0f );
+	}
+
+	static constexpr exMatrix4 exOrthographicProjectionMatrix(float fWidth, float fHeight, float fNearPlane, float fFarPlane)
 	{
 		// http://msdn.microsoft.com/en-us/library/windows/desktop/dd373965%28v=vs.85%29.aspx
 		// http://www.scratchapixel.com/lessons/3d-basic-rendering/perspective-and-orthographic-projection-matrix/orthographic-projection-matrix
 		// https://blog.demofox.org/2017/03/31/orthogonal-projection-matrix-plainly-explained/
 
-		pOut->m11 = 2.0f / fWidth;
-		pOut->m12 = 0.0f;
-		pOut->m13 = 0.0f;
-		pOut->m14 = 0.0f;
+		return exMatrix4(	2.0f / fWidth, 0.0f, 0.0f, 0.0f,
+							0.0f, 2.0f / -fHeight, 0.0f, 0.0f,
+							0.0f, 0.0f, -2.0f / (fFarPlane - fNearPlane), 0.0f,
+							-1.0f, 1.0f, -((fFarPlane + fNearPlane) / (fFarPlane - fNearPlane)), 1.0f );
+	}
 
-		pOut->m21 = 0.0f;
-		pOut->m22 = 2.0f / -fHeight;
-		pOut->m23 = 0.0f;
-		pOut->m24 = 0.0f;
+	static constexpr exMatrix4 exMakeTranslationMatrix(const exVector2& v2Position)
+	{
+		return exMakeScaleTranslationMatrix(1.0f, v2Position);
+	}
 
-		pOut->m31 = 0.0f;
-		pOut->m32 = 0.0f;
-		pOut->m33 = -2.0f / (fFarPlane - fNearPlane);
-		pOut->m34 = 0.0f;
+	static constexpr exMatrix4 exMakeScaleTranslationMatrix(float fScale, const exVector2& v2Position)
+	{
+		// uniform scale in x and y, applied before the translation
+		return exMatrix4(	fScale, 0.0f, 0.0f, 0.0f,
+							0.0f, fScale, 0.0f, 0.0f,
+							0.0f, 0.0f, 1.0f, 0.0f,
+							v2Position.x, v2Position.y, 0.0f, 1.0f );
+	}
 
-		pOut->m41 = -1.0f;
-		pOut->m42 = 1.0f;
-		pOut->m43 = -((fFarPlane + fNearPlane) / (fFarPlane - fNearPlane));
-		pOut->m44 = 1.0f;
+	static void exOrthographicProjectionMatrix(exMatrix4* pOut, float fWidth, float fHeight, float fNearPlane, float fFarPlane)
+	{
+		*pOut = exOrthographicProjectionMatrix(fWidth, fHeight, fNearPlane, fFarPlane);
 	}
 
 	static void exMakeTranslationMatrix(exMatrix4* pOut, const exVector2& v2Position)
 	{
-		pOut->m11 = 1.0f;
-		pOut->m22 = 1.0f;
-		pOut->m33 = 1.0f;
-		pOut->m44 = 1.0f;
-
-		pOut->m12 = pOut->m13 = pOut->m14 = 0.0f;
-		pOut->m21 = pOut->m23 = pOut->m24 = 0.0f;
-		pOut->m31 = pOut->m32 = pOut->m34 = 0.0f;
+		*pOut = exMakeTranslationMatrix(v2Position);
+	}
 
-		pOut->m41 = v2Position.x;	// identity matrix apart from this translation
-		pOut->m42 = v2Position.y;
-		pOut->m43 = 0.0f;
+	static void exMakeScaleTranslationMatrix(exMatrix4* pOut, float fScale, const exVector2& v2Position)
+	{
+		*pOut = exMakeScaleTranslationMatrix(fScale, v2Position);
 	}
 
 public:
@@ -0,0 +1,279 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "JobSystem.h"
+
+// Bytes of component data every chunk holds
+const int kEntityChunkSize = 16 * 1024;
+
+// Component types a program can have, every archetype is a mask of them
+const int kMaxComponentTypes = 64;
+
+// Refers to an entity, the generation tells it apart from the entities that had the same index before it
+struct Entity
+{
+	uint32_t mIndex;
+	uint32_t mGeneration;
+
+	bool operator==(const Entity& other) const { return mIndex == other.mIndex && mGeneration == other.mGeneration; }
+	bool operator!=(const Entity& other) const { return !(*this == other); }
+};
+
+// Generations start at 1, so this never refers to anything
+const Entity kNullEntity = { 0, 0 };
+
+// Entities and their components, stored by archetype, the set of component types an entity has
+// Every archetype keeps its entities in chunks of kEntityChunkSize bytes, each with one array per component type, so a query
+// walks plain contiguous arrays of just the components it asks for, all the chunks of an archetype are full but the last
+// Components are plain structures, copied with memcpy whenever an entity changes archetype or another one moves into its place
+// Adding, removing and destroying (structural changes) may only happen while nothing iterates the world, component values
+// can be changed by any thread that a query hands them to
+class EntityWorld
+{
+public:
+	EntityWorld();
+	~EntityWorld();
+
+	// Creates an entity with the given components, at most one of each type
+	template <typename... Components>
+	Entity CreateEntity(const Components&... components)
+	{
+		const Entity entity = AllocateEntity(MakeMask<Components...>());
+		const EntityRecord& record = mRecords[entity.mIndex];
+
+		(WriteComponent(record, components), ...);
+
+		return entity;
+	}
+
+	void DestroyEntity(Entity entity);
+
+	bool IsAlive(Entity entity) const;
+
+	// Moves the entity to the archetype with the component, or overwrites the component if it has it already
+	template <typename T>
+	void AddComponent(Entity entity, const T& component)
+	{
+		if (!IsAlive(entity))
+		{
+			return;
+		}
+
+		const uint64_t uBit = 1ull << GetComponentType<T>();
+
+		if ((mArchetypes[mRecords[entity.mIndex].mArchetype]->mMask & uBit) == 0)
+		{
+			MoveEntity(entity, mArchetypes[mRecords[entity.mIndex].mArchetype]->mMask | uBit);
+		}
+
+		WriteComponent(mRecords[entity.mIndex], component);
+	}
+
+	template <typename T>
+	void RemoveComponent(Entity entity)
+	{
+		if (!IsAlive(entity))
+		{
+			return;
+		}
+
+		const uint64_t uBit = 1ull << GetComponentType<T>();
+
+		if ((mArchetypes[mRecords[entity.mIndex].mArchetype]->mMask & uBit) != 0)
+		{
+			MoveEntity(entity, mArchetypes[mRecords[entity.mIndex].mArchetype]->mMask & ~uBit);
+		}
+	}
+
+	// nullptr if the entity is gone or doesn't have the component, valid until the next structural change
+	template <typename T>
+	T* GetComponent(Entity entity)
+	{
+		if (!IsAlive(entity))
+		{
+			return nullptr;
+		}
+
+		const EntityRecord& record = mRecords[entity.mIndex];
+		const Archetype& archetype = *mArchetypes[record.mArchetype];
+
+		if ((archetype.mMask & (1ull << GetComponentType<T>())) == 0)
+		{
+			return nullptr;
+		}
+
+		return GetArray<T>(archetype, *archetype.mChunks[record.mChunk]) + record.mRow;
+	}
+
+	template <typename T>
+	bool HasComponent(Entity entity) const
+	{
+		return IsAlive(entity) && (mArchetypes[mRecords[entity.mIndex].mArchetype]->mMask & (1ull << GetComponentType<T>())) != 0;
+	}
+
+	int GetEntityCount() const;
+
+	// Calls function(nCount, pEntities, pComponents...) for every chunk of entities having all the components, with the
+	// chunk's arrays of them, which hold nCount entries each
+	template <typename... Components, typename Function>
+	void ForEachChunk(Function&& function)
+	{
+		const uint64_t uMask = MakeMask<Components...>();
+
+		for (const std::unique_ptr<Archetype>& pArchetype : mArchetypes)
+		{
+			if ((pArchetype->mMask & uMask) != uMask)
+			{
+				continue;
+			}
+
+			for (const std::unique_ptr<Chunk>& pChunk : pArchetype->mChunks)
+			{
+				function(pChunk->mCount, GetEntities(*pChunk), GetArray<Components>(*pArchetype, *pChunk)...);
+			}
+		}
+	}
+
+	// Calls function(components...) for every entity having all the components
+	template <typename... Components, typename Function>
+	void ForEach(Function&& function)
+	{
+		ForEachChunk<Components...>([&function](int nCount, const Entity*, Components*... pComponents)
+		{
+			for (int i = 0; i < nCount; ++i)
+			{
+				function(pComponents[i]...);
+			}
+		});
+	}
+
+	// ForEachChunk with the chunks spread over the job system's threads, returns once they are all done
+	template <typename... Components, typename Function>
+	void ParallelForEachChunk(JobSystem& jobSystem, Function&& function)
+	{
+		// Chunks are the unit of work, each is big enough for a job of its own
+		std::vector<std::pair<const Archetype*, Chunk*>> chunks;
+		const uint64_t uMask = MakeMask<Components...>();
+
+		for (const std::unique_ptr<Archetype>& pArchetype : mArchetypes)
+		{
+			if ((pArchetype->mMask & uMask) == uMask)
+			{
+				for (const std::unique_ptr<Chunk>& pChunk : pArchetype->mChunks)
+				{
+					chunks.emplace_back(pArchetype.get(), pChunk.get());
+				}
+			}
+		}
+
+		jobSystem.ParallelFor((int)chunks.size(), 1, [&chunks, &function](int nBegin, int nEnd)
+		{
+			for (int i = nBegin; i < nEnd; ++i)
+			{
+				const Archetype& archetype = *chunks[i].first;
+				Chunk& chunk = *chunks[i].second;
+
+				function(chunk.mCount, GetEntities(chunk), GetArray<Components>(archetype, chunk)...);
+			}
+		});
+	}
+
+	// Every component type gets a number the first time it is used, from any thread
+	// Queries can ask for const components, which are the same type
+	template <typename T>
+	static int GetComponentType()
+	{
+		if constexpr (std::is_const<T>::value)
+		{
+			return GetComponentType<typename std::remove_const<T>::type>();
+		}
+		else
+		{
+			static_assert(std::is_trivially_copyable<T>::value, "Components are copied with memcpy");
+			static_assert(alignof(T) <= 64, "Chunks are only 64 byte aligned");
+
+			static const int nType = RegisterComponentType(sizeof(T));
+			return nType;
+		}
+	}
+
+private:
+	struct Chunk
+	{
+		int mCount;
+		alignas(64) unsigned char mData[kEntityChunkSize];
+	};
+
+	struct Archetype
+	{
+		uint64_t mMask;
+		std::vector<int> mTypes;
+		size_t mOffsets[kMaxComponentTypes];	// where each component type's array starts in a chunk, after the entities
+		int mCapacity;							// entities per chunk
+		std::vector<std::unique_ptr<Chunk>> mChunks;
+	};
+
+	// Where an entity lives, mArchetype is -1 while the index is free
+	struct EntityRecord
+	{
+		uint32_t mGeneration;
+		int mArchetype;
+		int mChunk;
+		int mRow;
+	};
+
+	template <typename... Components>
+	static uint64_t MakeMask()
+	{
+		return (0ull | ... | (1ull << GetComponentType<Components>()));
+	}
+
+	template <typename T>
+	static T* GetArray(const Archetype& archetype, Chunk& chunk)
+	{
+		return reinterpret_cast<T*>(chunk.mData + archetype.mOffsets[GetComponentType<T>()]);
+	}
+
+	static Entity* GetEntities(Chunk& chunk)
+	{
+		return reinterpret_cast<Entity*>(chunk.mData);
+	}
+
+	template <typename T>
+	void WriteComponent(const EntityRecord& record, const T& component)
+	{
+		const Archetype& archetype = *mArchetypes[record.mArchetype];
+		memcpy(GetArray<T>(archetype, *archetype.mChunks[record.mChunk]) + record.mRow, &component, sizeof(T));
+	}
+
+	static int RegisterComponentType(size_t uSize);
+
+	// A new entity with a row in the archetype, its components aren't written yet
+	Entity AllocateEntity(uint64_t uMask);
+
+	// Moves an entity to another archetype, keeping the components both have
+	void MoveEntity(Entity entity, uint64_t uMask);
+
+	int FindOrCreateArchetype(uint64_t uMask);
+
+	// Appends a row for the entity, in the last chunk or a new one
+	void AddRow(Archetype& archetype, Entity entity, int& nChunk, int& nRow);
+
+	// Fills the row with the archetype's last entity, so the chunks stay packed
+	void RemoveRow(Archetype& archetype, int nChunk, int nRow);
+
+	std::vector<std::unique_ptr<Archetype>> mArchetypes;
+	std::unordered_map<uint64_t, int> mArchetypeIndices;
+
+	std::vector<EntityRecord> mRecords;
+	std::vector<uint32_t> mFreeIndices;
+	int mEntityCount;
+
+	// Emptied chunks, all chunks are the same size so any archetype can take them
+	std::vector<std::unique_ptr<Chunk>> mFreeChunks;
+};
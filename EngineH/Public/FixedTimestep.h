@@ -0,0 +1,40 @@
+#pragma once
+
+class exGameInterface;
+
+// Steps the game's simulation at a fixed rate, independent of how fast frames are rendered
+// Frame time goes into an accumulator and the game runs one step per whole step in it, what's left over is the alpha
+// the game is told to render with, to interpolate between its last two simulated states
+// Disabled (the default) it runs the game once per frame with the frame's own time
+class FixedTimestep
+{
+public:
+	FixedTimestep();
+	~FixedTimestep();
+
+	// fStep is in seconds, 0 disables the fixed step
+	// At most nMaxSteps run per frame, the rest of a long frame is dropped rather than making the next frame even longer
+	void SetStep(float fStep, int nMaxSteps);
+
+	bool IsEnabled() const;
+
+	// Runs as many steps as the frame's time allows, then renders
+	void RunFrame(exGameInterface* pGame, float fDeltaT);
+
+	// Steps run during the last frame, and the alpha it rendered with
+	int GetStepCountLastFrame() const;
+
+	float GetAlphaLastFrame() const;
+
+	// Time dropped so far because frames took longer than nMaxSteps steps, in seconds
+	float GetDroppedTime() const;
+
+private:
+	float mStep;
+	int mMaxSteps;
+	float mAccumulator;
+
+	int mStepCount;
+	float mAlpha;
+	float mDroppedTime;
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+#include "EngineTypes.h"
+
+class GlyphAtlas;
+class RenderBatch;
+
+// Characters every font rasterizes, printable ASCII
+const int kFirstGlyphCharacter = 32;
+const int kLastGlyphCharacter = 126;
+
+// Where a character's bitmap ended up in the atlas and how to place it
+struct Glyph
+{
+	float mAdvance;								// how far the pen moves after the character
+	float mOffset[2];							// top left of the bitmap relative to the pen on the baseline, y down
+	float mSize[2];
+	float mTexCoords[4];						// u0, v0, u1, v1 in the atlas page
+	int mPage;									// -1 for characters without pixels, like the space
+};
+
+// A TrueType font rasterized at a single size into a GlyphAtlas when it is loaded
+// Everything happens on the CPU, so fonts can be loaded before there is any graphics context
+class Font
+{
+public:
+	Font();
+	~Font();
+
+	// Reads a .ttf file and rasterizes its printable ASCII characters at nPTSize pixels per em, false if the file can't be used
+	bool Load(const char* szFile, int nPTSize, GlyphAtlas& atlas);
+
+	// Characters the font doesn't cover fall back to '?'
+	const Glyph& GetGlyph(char c) const;
+
+	float GetAscent() const;
+
+	float GetLineHeight() const;
+
+	// Lays szText out with v2Position as the top left of its first line, '\n' starts a new line
+	// Every visible character appends two triangles to the batch of the atlas page its glyph is on, 6 vertices
+	// starting with the glyph's top left corner and ending with its bottom right one
+	void AddText(std::vector<RenderBatch>& pageBatches, const exVector2& v2Position, const char* szText, const exColor& color, int nLayer) const;
+
+private:
+	Glyph mGlyphs[kLastGlyphCharacter - kFirstGlyphCharacter + 1];
+	float mAscent;
+	float mLineHeight;
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+#include "RenderBatch.h"
+#include "RenderCommandBuffer.h"
+#include "LineTessellator.h"
+
+class Font;
+
+// A run of consecutive commands drawn with a single shader
+// Lines and text are tessellated, so their ranges count vertices, the other programs count instances
+// A run of text is split into one range per glyph atlas page
+struct DrawRange
+{
+	SHADER_PROGRAM mProgram;
+	int mFirst;
+	int mCount;
+	int mPage;
+};
+
+// Turns a frame's recorded commands into the instances and vertices the GPU draws, and the ranges to draw them with
+// Nothing in here touches GL, so every engine goes through the same CPU work
+class FrameBatcher
+{
+public:
+	FrameBatcher();
+	~FrameBatcher();
+
+	// Sorts the commands and generates the frame batch and draw ranges in key order
+	// fScreenScale is the camera's zoom, nAtlasPages the number of pages the fonts' glyphs are spread over
+	void Build(RenderCommandBuffer& commandBuffer, const std::vector<Font>& fonts, int nAtlasPages, float fScreenScale);
+
+	const RenderBatch& GetBatch() const;
+
+	const std::vector<DrawRange>& GetDrawRanges() const;
+
+private:
+	// Moves the glyph quads gathered for a run of text into the frame batch, adding a range for each atlas page they use
+	void AddTextRanges();
+
+	LineTessellator mLineTessellator;
+	// Instances and vertices of the whole frame in sorted order
+	RenderBatch mFrameBatch;
+	std::vector<DrawRange> mDrawRanges;
+	// Glyph quads of the current run of text, one batch per atlas page
+	std::vector<RenderBatch> mTextPageBatches;
+};
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "JobSystem.h"
+
+// Which thread a stage has to run on
+enum class STAGE_THREAD : unsigned char
+{
+	MAIN = 0,									// the thread executing the graph, for anything touching SDL or the game
+	ANY											// a job, on whichever thread gets to it first
+};
+
+enum class RESOURCE_ACCESS : unsigned char
+{
+	READ = 0,
+	WRITE
+};
+
+// How long a stage took, in milliseconds
+struct StageTiming
+{
+	const char* mName;
+	float mMilliseconds;
+};
+
+// The stages of a frame, the order they have to run in, and the resources each of them touches
+// Execute returns as soon as the MAIN stages (and with them everything they depend on) are done, the remaining ANY stages keep
+// running as jobs, so the next frame can start while the tail of this one finishes, Wait is what waits for them
+// Resources shared across frames may only be touched by the stages Execute waits for, resources of a single frame by any stage,
+// and Validate checks that stages touching a resource, at least one of them writing, can never run at the same time
+class FrameGraph
+{
+public:
+	FrameGraph();
+	~FrameGraph();
+
+	// bSharedAcrossFrames is for anything the next frame touches too, rather than a copy only this frame has
+	int AddResource(const char* szName, bool bSharedAcrossFrames);
+
+	int AddStage(const char* szName, STAGE_THREAD eThread, std::function<void()> function);
+
+	// nDependency has to be added before nStage, which keeps the graph free of cycles
+	void AddDependency(int nStage, int nDependency);
+
+	void AddAccess(int nStage, int nResource, RESOURCE_ACCESS eAccess);
+
+	// Logs every unsafe access, false if there was one
+	bool Validate() const;
+
+	// Runs the MAIN stages on the calling thread and the others as jobs, returns once the MAIN stages are done
+	void Execute(JobSystem& jobSystem);
+
+	// Runs jobs until every stage is done
+	void Wait(JobSystem& jobSystem);
+
+	// Sleeps until every stage is done, see JobSystem::WaitWithoutRunning
+	void WaitWithoutRunning(JobSystem& jobSystem);
+
+	int GetStageCount() const;
+
+	const char* GetStageName(int nStage) const;
+
+	// Time the stage took the last time it ran, in milliseconds
+	float GetStageTime(int nStage) const;
+
+private:
+	struct Stage
+	{
+		const char* mName;
+		STAGE_THREAD mThread;
+		std::function<void()> mFunction;
+		std::vector<int> mDependencies;
+		std::vector<int> mDependents;
+		std::vector<std::pair<int, RESOURCE_ACCESS>> mAccesses;
+
+		std::atomic<int> mRemainingDependencies;
+		std::atomic<bool> mReady;				// MAIN stages only, set once they can run
+		std::atomic<float> mTime;
+	};
+
+	struct Resource
+	{
+		const char* mName;
+		bool mShared;
+	};
+
+	// Runs a stage and releases the ones that were only waiting for it
+	void RunStage(int nStage);
+
+	void Release(int nStage);
+
+	// True if nAncestor always finishes before nStage starts
+	bool IsAncestor(int nAncestor, int nStage) const;
+
+	// True if Execute waits for the stage
+	bool IsBlocking(int nStage) const;
+
+	std::vector<std::unique_ptr<Stage>> mStages;
+	std::vector<Resource> mResources;
+
+	JobSystem* mJobSystem;
+	JobGroup mJobs;
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+
+// How the engine paces its frames
+enum class FRAME_PACING : unsigned char
+{
+	VSYNC = 0,									// the buffer swap waits for the display's refresh
+	FIXED,										// no vsync, the scheduler waits until the target rate's next frame is due
+	UNCAPPED,									// no vsync and no waiting
+	ADAPTIVE									// vsync, but a late frame is swapped right away instead of waiting for the next refresh
+};
+
+// Frame times over the last kFrameTimingWindow frames, in milliseconds
+struct FrameTimings
+{
+	double mAverage;
+	double mMin;
+	double mMax;
+	double mJitter;								// standard deviation of the frame time
+	int mFrameCount;							// frames the numbers were taken over
+};
+
+// Number of frames the timings are taken over
+const int kFrameTimingWindow = 120;
+
+// Measures frames with a high resolution counter and, in FIXED mode, waits out the rest of each frame
+// Waiting sleeps while the next frame is far away and spins for the last stretch, since sleeping overshoots by an unknown amount
+class FrameScheduler
+{
+public:
+	// A function returning ticks of a monotonic counter, like SDL_GetPerformanceCounter
+	typedef uint64_t(*CounterFunction)();
+
+	FrameScheduler();
+	~FrameScheduler();
+
+	// Without a counter the scheduler uses std::chrono's steady clock
+	void Initialize(CounterFunction pCounter = nullptr, uint64_t uFrequency = 0);
+
+	// fTargetRate is in frames per second and only used by FIXED
+	void SetPacing(FRAME_PACING ePacing, float fTargetRate);
+
+	FRAME_PACING GetPacing() const;
+
+	// The swap interval to give the GL context for the current pacing
+	int GetSwapInterval() const;
+
+	// Starts a frame, returning the seconds since the previous one started
+	float BeginFrame();
+
+	// Ends a frame, in FIXED mode only returns once the next one is due
+	void EndFrame();
+
+	FrameTimings GetTimings() const;
+
+private:
+	uint64_t Now() const;
+
+	// Sleeps and then spins until the counter reaches uTarget
+	void WaitUntil(uint64_t uTarget);
+
+	double TicksToSeconds(int64_t nTicks) const;
+
+	CounterFunction mCounter;
+	uint64_t mFrequency;
+
+	FRAME_PACING mPacing;
+	float mTargetRate;
+	uint64_t mFramePeriod;						// ticks between frames in FIXED mode
+	uint64_t mNextFrame;						// when the next frame is due in FIXED mode
+	uint64_t mFrameStart;
+	bool mStarted;
+
+	// Running estimate of how long a 1 ms sleep really takes, mean plus one standard deviation is what gets reserved for spinning
+	double mSleepMean;
+	double mSleepM2;
+	int64_t mSleepCount;
+
+	double mFrameTimes[kFrameTimingWindow];
+	int mFrameTimeCount;
+	int mFrameTimeHead;
+};
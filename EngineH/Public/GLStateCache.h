@@ -0,0 +1,72 @@
+#pragma once
+
+// Forward declaring the GL types in use
+typedef unsigned int GLuint;
+typedef unsigned int GLenum;
+
+// Number of texture units the cache shadows, binds to the ones above it always reach GL
+const int kCachedTextureUnits = 8;
+
+// Shadows the GL binding state the engine touches, so binds matching what is already bound never reach the driver
+// Everything that changes these bindings has to go through the cache, or the cache has to be invalidated afterwards
+class GLStateCache
+{
+public:
+	GLStateCache();
+	~GLStateCache();
+
+	void UseProgram(GLuint program);
+
+	void BindVertexArray(GLuint vertexArray);
+
+	// GL_ARRAY_BUFFER and GL_UNIFORM_BUFFER are shadowed, other targets are passed straight through
+	void BindBuffer(GLenum eTarget, GLuint buffer);
+
+	// Binds the buffer to an indexed binding point, which also binds it to the generic target
+	void BindBufferBase(GLenum eTarget, GLuint uIndex, GLuint buffer);
+
+	void BindTexture2D(int nUnit, GLuint texture);
+
+	// GL_DEPTH_TEST and GL_BLEND are shadowed, other capabilities are passed straight through
+	void SetCapability(GLenum eCapability, bool bEnabled);
+
+	// Forgets everything, the next call of each kind always reaches GL
+	void Invalidate();
+
+	// Rolls this frame's counters over, they are reported through the LastFrame getters
+	void EndFrame();
+
+	int GetStateChangesLastFrame() const;
+
+	int GetElidedStateChangesLastFrame() const;
+
+	// Programs and vertex arrays that actually had to be bound, part of the state changes
+	int GetProgramBindsLastFrame() const;
+
+	int GetVertexArrayBindsLastFrame() const;
+
+private:
+	// Returns true if the value changed (and updates the shadow), counting the call either way
+	bool Update(GLuint& shadow, GLuint value);
+
+	// Marks a shadowed value as unknown, no real binding can ever match it
+	static const GLuint kUnknown = 0xFFFFFFFF;
+
+	GLuint mProgram;
+	GLuint mVertexArray;
+	GLuint mArrayBuffer;
+	GLuint mUniformBuffer;
+	GLuint mActiveTextureUnit;
+	GLuint mTextures[kCachedTextureUnits];
+	GLuint mDepthTest;
+	GLuint mBlend;
+
+	int mStateChanges;
+	int mElidedStateChanges;
+	int mStateChangesLastFrame;
+	int mElidedStateChangesLastFrame;
+	int mProgramBinds;
+	int mVertexArrayBinds;
+	int mProgramBindsLastFrame;
+	int mVertexArrayBindsLastFrame;
+};
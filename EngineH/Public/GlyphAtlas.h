@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vector>
+
+// Size in pixels of a square atlas page
+const int kGlyphAtlasPageSize = 512;
+
+// Packs glyph bitmaps into square single-channel pages using shelves (rows of glyphs sharing a height)
+// Only lives on the CPU, the renderer uploads the pages it is told are dirty
+class GlyphAtlas
+{
+public:
+	GlyphAtlas();
+	~GlyphAtlas();
+
+	// Finds room for a nWidth x nHeight bitmap, starting a new shelf or page when the current one is full
+	// Returns false if the bitmap is bigger than a whole page
+	bool Allocate(int nWidth, int nHeight, int& nOutPage, int& nOutX, int& nOutY);
+
+	// Copies a tightly packed bitmap to a spot returned by Allocate and marks its page dirty
+	void Write(int nPage, int nX, int nY, int nWidth, int nHeight, const unsigned char* pPixels);
+
+	int GetPageCount() const;
+
+	const unsigned char* GetPagePixels(int nPage) const;
+
+	bool IsPageDirty(int nPage) const;
+
+	// Called once the page has been uploaded
+	void ClearDirty(int nPage);
+
+private:
+	struct Page
+	{
+		std::vector<unsigned char> mPixels;
+		int mShelfY;							// top of the shelf being filled
+		int mShelfHeight;						// tallest bitmap on that shelf so far
+		int mShelfX;							// where the next bitmap goes on that shelf
+		bool mDirty;
+	};
+
+	void AddPage();
+
+	std::vector<Page> mPages;
+};
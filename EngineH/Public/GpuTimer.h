@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Forward declaring the GL types in use
+typedef unsigned int GLuint;
+
+// The parts of a frame the GPU timer tells apart
+enum class GPU_PASS : unsigned char
+{
+	CLEAR = 0,
+	UPLOAD,										// the camera, glyph atlas and streamed batches
+	BOX,
+	CIRCLE,
+	LINE,
+	TEXT,
+	SWAP,
+	COUNT
+};
+
+// Time a pass took on the CPU issuing it and on the GPU running it, in milliseconds
+struct GpuPassTiming
+{
+	float mCpuMilliseconds;
+	float mGpuMilliseconds;
+	int mBatches;
+};
+
+// A single draw of a pass, with the number of instances or vertices it drew
+struct GpuBatchTiming
+{
+	GPU_PASS mPass;
+	int mCount;
+	float mCpuMilliseconds;
+	float mGpuMilliseconds;
+};
+
+// Everything measured for the most recent frame whose queries came back
+// A GPU time well above the CPU time of the same pass means the GPU is the bottleneck (fill, blending), the other way around it is the submission
+struct GpuTimings
+{
+	bool mSupported;							// false when the context has no timer queries, nothing else is filled in then
+	uint64_t mFrame;							// the frame the timings are from, a few frames behind the one being drawn
+	float mCpuMilliseconds;						// the whole frame, first pass to swap
+	float mGpuMilliseconds;
+	GpuPassTiming mPasses[(int)GPU_PASS::COUNT];
+	std::vector<GpuBatchTiming> mBatches;
+	int mDroppedFrames;							// frames whose results weren't back in time and were thrown away
+};
+
+// Number of frames whose queries can be waiting on the GPU at once
+const int kGpuTimerFrames = 4;
+
+// Marks a single frame can hold, the last one is kept for the swap
+const int kMaxGpuMarks = 256;
+
+// Times the passes and batches of a frame on the GPU with GL_TIMESTAMP queries
+// Every Mark() puts a timestamp in the command stream, the time between two of them is charged to the pass of the later one
+// Frames use a ring of query sets, results are only read once the GPU says they are available so reading them never stalls,
+// a frame whose set is needed again before its results came back is dropped instead
+// Has to be used on the thread owning the GL context, GetTimings() can be called from any thread
+class GpuTimer
+{
+public:
+	GpuTimer();
+	~GpuTimer();
+
+	// Creates the queries, false if the context can't do timer queries, in which case every other call does nothing
+	bool Initialize();
+
+	bool IsSupported() const;
+
+	// Reads back the frames the GPU is done with, then puts the frame's starting timestamp down
+	void BeginFrame();
+
+	// Ends whatever ran since the previous mark, nCount is the batch's instances or vertices
+	void Mark(GPU_PASS ePass, int nCount = 0);
+
+	void EndFrame();
+
+	GpuTimings GetTimings() const;
+
+	static const char* GetPassName(GPU_PASS ePass);
+
+private:
+	struct PassMark
+	{
+		GPU_PASS mPass;
+		int mCount;
+		float mCpuMilliseconds;
+	};
+
+	struct FrameQueries
+	{
+		// The first query is the frame's start, every mark ends with the one after it
+		GLuint mQueries[kMaxGpuMarks + 1];
+		PassMark mMarks[kMaxGpuMarks];
+		int mMarkCount;
+		uint64_t mFrame;
+		bool mPending;
+	};
+
+	// Reads the pending frames in the order they were drawn, up to the first one the GPU isn't done with
+	void ReadBackFrames();
+
+	void ReadBackFrame(FrameQueries& frame);
+
+	double NowMilliseconds() const;
+
+	bool mSupported;
+	bool mFrameOpen;
+	uint64_t mFrame;
+	uint64_t mReadFrame;						// oldest frame that may still be pending
+	double mLastMarkTime;
+	int mDroppedFrames;
+
+	FrameQueries mFrames[kGpuTimerFrames];
+
+	mutable std::mutex mMutex;
+	GpuTimings mLatest;
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vector>
+#include "WindowlessEngine.h"
+#include "FrameBatcher.h"
+
+// An engine without a window, a GL context or any pixels
+// Draws are recorded, sorted and batched exactly like EngineH does, and the batches are copied into a CPU side stream in place
+// of the GPU's, so the whole game and engine CPU path can be measured on machines without a GPU
+class HeadlessEngine : public WindowlessEngine
+{
+public:
+	HeadlessEngine();
+	~HeadlessEngine();
+
+	int							GetCommandCountLastFrame() const;
+
+	// Number of draws EngineH would have issued for the last frame
+	int							GetDrawCountLastFrame() const;
+
+	// Number of bytes of instance and vertex data EngineH would have streamed to the GPU for the last frame
+	size_t						GetStreamedBytesLastFrame() const;
+
+	// The draws of the last frame, in the order they would have been issued
+	const std::vector<DrawRange>& GetDrawRanges() const;
+
+protected:
+	virtual void OnFrame(float fDeltaT);
+
+private:
+	// Batches what was recorded and copies it into the stream
+	void FlushBatches();
+
+	// Counts what EngineH would have drawn, uploaded and bound for the frame
+	void UpdateStats(float fFrameMilliseconds);
+
+private:
+	FrameBatcher mFrameBatcher;
+
+	// Stands in for the GPU's stream buffers, it only ever grows
+	std::vector<unsigned char> mStream;
+
+	int mCommandCount;
+	int mCulledCount;
+	size_t mStreamedBytes;
+};
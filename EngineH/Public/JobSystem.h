@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobSystem;
+
+// Counts the jobs run into it that haven't finished yet, so they can be waited on together
+// Jobs can also be held back until every job of another group has finished, see JobSystem::Run
+class JobGroup
+{
+public:
+	JobGroup();
+	~JobGroup();
+
+	// True once every job run into the group has finished
+	bool IsDone() const;
+
+private:
+	friend class JobSystem;
+
+	std::atomic<int> mPending;
+
+	// Jobs waiting for this group to finish, guarded with the group's mutex, which is also held while finishing a job
+	std::mutex mMutex;
+	std::vector<std::pair<std::function<void()>, JobGroup*>> mContinuations;
+
+	// Signaled with the mutex held when the last pending job finishes
+	std::condition_variable mDone;
+};
+
+// A work stealing scheduler, one deque of jobs per thread
+// Threads push and pop their own jobs at the back of their deque and steal from the front of the others' when it is empty
+// The thread that created the system has a deque too and runs jobs while it waits, so it never just blocks
+// Every deque has its own lock, they are only contended while stealing
+class JobSystem
+{
+public:
+	JobSystem();
+	~JobSystem();
+
+	// Starts the workers, a negative count starts one per hardware thread beyond the calling one
+	void Initialize(int nWorkerThreads = -1);
+
+	// Lets the workers finish the jobs they are on and stops them, then runs every job still queued or waiting on a group
+	// on the calling thread, so no group is left pending
+	void Shutdown();
+
+	// Runs a job, counted in the group, pDependency's jobs all finish before it starts if there is one
+	void Run(JobGroup& group, std::function<void()> job, JobGroup* pDependency = nullptr);
+
+	// Runs jobs until every job in the group has finished
+	void Wait(JobGroup& group);
+
+	// Sleeps until every job in the group has finished, without running any, for threads whose own work mustn't queue
+	// up behind other jobs, like the one owning the GL context, without workers it runs them like Wait since nothing else would
+	void WaitWithoutRunning(JobGroup& group);
+
+	// Calls function(nBegin, nEnd) over [0, nCount) split into ranges of at least nGrainSize, and returns once they are all done
+	// A grain size of 0 or less picks one giving every thread a few ranges to balance with
+	void ParallelFor(int nCount, int nGrainSize, const std::function<void(int nBegin, int nEnd)>& function);
+
+	// Runs one queued job on the calling thread, popping one of its own or stealing one, false if there was none anywhere
+	bool TryRunJob();
+
+	// Workers plus the calling thread
+	int GetThreadCount() const;
+
+private:
+	struct Job
+	{
+		std::function<void()> mFunction;
+		JobGroup* mGroup;
+	};
+
+	struct WorkQueue
+	{
+		std::mutex mMutex;
+		std::deque<Job> mJobs;
+	};
+
+	void Push(Job& job);
+
+	void Execute(Job& job);
+
+	void WorkerLoop(int nQueue);
+
+	// The deque of the calling thread, threads that aren't part of the system share the first one
+	int GetQueueIndex() const;
+
+	std::vector<std::unique_ptr<WorkQueue>> mQueues;
+	std::vector<std::thread> mWorkers;
+
+	// Tells job systems apart in the thread local queue index, unlike their addresses they are never reused
+	uint64_t mID;
+
+	// Workers sleep while there are no jobs queued anywhere
+	std::atomic<int> mQueuedJobs;
+	std::mutex mSleepMutex;
+	std::condition_variable mJobQueued;
+	bool mShutdown;
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+#include "EngineTypes.h"
+
+class RenderBatch;
+
+// Turns lines and outlines into triangles, so they can be drawn from the same vertex stream as one batch
+// Every segment is expanded into a quad of the given width centered on it, and the corners of polylines are
+// filled with a miter join (or a bevel when the miter would get too long)
+class LineTessellator
+{
+public:
+	LineTessellator();
+	~LineTessellator();
+
+	void AddLine(RenderBatch& batch, const exVector2& v2P1, const exVector2& v2P2, float fWidth, const exColor& color, int nLayer);
+
+	void AddLineBox(RenderBatch& batch, const exVector2& v2P1, const exVector2& v2P2, float fWidth, const exColor& color, int nLayer);
+
+	// fScreenScale is how many pixels one world unit covers, so the number of segments follows the radius on screen
+	void AddLineCircle(RenderBatch& batch, const exVector2& v2Center, float fRadius, float fScreenScale, float fWidth, const exColor& color, int nLayer);
+
+	// Expands a polyline going through nCount points, bClosed joins the last point back to the first
+	void AddPolyline(RenderBatch& batch, const exVector2* pPoints, int nCount, bool bClosed, float fWidth, const exColor& color, int nLayer);
+
+	// Number of segments for a circle outline of the given radius in pixels, so that it never strays more than a fraction of a pixel from the true circle
+	static int GetCircleSegmentCount(float fScreenRadius);
+
+private:
+	void AddSegment(RenderBatch& batch, const exVector2& v2P1, const exVector2& v2P2, float fHalfWidth, const exColor& color, int nLayer);
+
+	void AddJoin(RenderBatch& batch, const exVector2& v2Previous, const exVector2& v2Point, const exVector2& v2Next, float fHalfWidth, const exColor& color, int nLayer);
+
+	// Scratch space for the points of circle outlines
+	std::vector<exVector2> mPoints;
+};
@@ -0,0 +1,250 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+// How bad a message is, the levels below ENGINEH_LOG_LEVEL are compiled out
+enum class LOG_LEVEL : unsigned char
+{
+	VERBOSE = 0,
+	INFO,
+	WARNING,
+	SEVERE
+};
+
+// 0 keeps every message, 4 compiles all of them out
+#ifndef ENGINEH_LOG_LEVEL
+#define ENGINEH_LOG_LEVEL 1
+#endif
+
+// Bytes of messages every thread can have waiting to be written, has to be a power of 2
+const int kLogBufferSize = 64 * 1024;
+
+// Longest string argument kept, longer ones are cut
+const int kMaxLogStringLength = 1024;
+
+// Argument count of the records filling the end of a buffer when the next one doesn't fit there
+const unsigned char kLogSkipRecord = 0xFF;
+
+// What a message's arguments are stored as
+enum class LOG_ARGUMENT : unsigned char
+{
+	INT = 0,
+	UINT,
+	DOUBLE,
+	STRING,
+	POINTER
+};
+
+// Starts every record in a thread's buffer, followed by the arguments, each a LOG_ARGUMENT and its value
+// Records are 8 byte aligned and never wrap, the end of the buffer is skipped with a record marked kLogSkipRecord
+struct LogRecordHeader
+{
+	uint32_t mSize;								// the whole record, header included
+	LOG_LEVEL mLevel;
+	unsigned char mArgumentCount;
+	const char* mFormat;
+	int64_t mTime;								// steady_clock ticks, orders the messages of different threads
+};
+
+// A single producer, single consumer ring of records, written by its thread and read by the logger's
+struct LogThreadBuffer
+{
+	unsigned char mData[kLogBufferSize];
+	std::atomic<uint64_t> mHead;				// bytes written so far, published after each record
+	std::atomic<uint64_t> mTail;				// bytes read so far
+	std::atomic<uint64_t> mDropped;				// messages that didn't fit
+};
+
+// Logs printf style messages without formatting them or touching a file on the calling thread
+// A message's format pointer and its arguments are copied in binary into the thread's own ring, which takes no lock,
+// a background thread formats them and writes them to stderr (and the debugger's output on Windows) or a file
+// The format has to outlive the program, which string literals do, strings passed as arguments are copied
+// A message is dropped rather than waited on when its thread's ring is full, the number of dropped ones is logged later
+class Logger
+{
+public:
+	template <typename... Args>
+	static void Write(LOG_LEVEL eLevel, const char* szFormat, const Args&... args)
+	{
+		const uint32_t uSize = (uint32_t)((sizeof(LogRecordHeader) + ... + ArgumentSize(args)) + 7) & ~7u;
+
+		LogThreadBuffer* pBuffer = tBuffer;
+
+		if (pBuffer == nullptr)
+		{
+			pBuffer = RegisterThread();
+		}
+
+		unsigned char* pRecord = Reserve(pBuffer, uSize);
+
+		if (pRecord == nullptr)
+		{
+			pBuffer->mDropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		LogRecordHeader header;
+		header.mSize = uSize;
+		header.mLevel = eLevel;
+		header.mArgumentCount = (unsigned char)sizeof...(Args);
+		header.mFormat = szFormat;
+		header.mTime = Now();
+		memcpy(pRecord, &header, sizeof(header));
+
+		[[maybe_unused]] unsigned char* pArgument = pRecord + sizeof(header);
+		(WriteArgument(pArgument, args), ...);
+
+		Commit(pBuffer, uSize, eLevel);
+	}
+
+	// Writes to the file from now on instead of stderr, nullptr goes back to stderr, false if the file can't be created
+	static bool SetFile(const char* szFile);
+
+	// Returns once every message logged before the call has been written
+	static void Flush();
+
+	// Writes what is left and stops the background thread, messages logged after it are written on the spot
+	// Called on exit, only needed before then to be sure nothing is lost on a crash
+	static void Shutdown();
+
+private:
+	static LogThreadBuffer* RegisterThread();
+
+	static int64_t Now();
+
+	// Room for uSize bytes in the thread's ring, nullptr if it is full
+	static unsigned char* Reserve(LogThreadBuffer* pBuffer, uint32_t uSize)
+	{
+		const uint64_t uHead = pBuffer->mHead.load(std::memory_order_relaxed);
+		const uint64_t uOffset = uHead & (kLogBufferSize - 1);
+		const uint64_t uContiguous = kLogBufferSize - uOffset;
+
+		// A record that would wrap starts at the beginning of the buffer instead
+		const uint64_t uNeeded = (uContiguous < uSize) ? uContiguous + uSize : uSize;
+
+		if (uHead + uNeeded - pBuffer->mTail.load(std::memory_order_acquire) > (uint64_t)kLogBufferSize)
+		{
+			return nullptr;
+		}
+
+		if (uContiguous < uSize)
+		{
+			// Only the size and argument count are read from a skipped stretch, and there are always at least 8 bytes of it
+			const uint32_t uSkipped = (uint32_t)uContiguous;
+			memcpy(pBuffer->mData + uOffset + offsetof(LogRecordHeader, mSize), &uSkipped, sizeof(uSkipped));
+			pBuffer->mData[uOffset + offsetof(LogRecordHeader, mArgumentCount)] = kLogSkipRecord;
+			pBuffer->mHead.store(uHead + uContiguous, std::memory_order_release);
+			return pBuffer->mData;
+		}
+
+		return pBuffer->mData + uOffset;
+	}
+
+	// Publishes the record Reserve handed out
+	static void Commit(LogThreadBuffer* pBuffer, uint32_t uSize, LOG_LEVEL eLevel);
+
+	template <typename T>
+	static size_t ArgumentSize(const T& value)
+	{
+		if constexpr (std::is_same<T, std::string>::value)
+		{
+			return 1 + sizeof(uint32_t) + ClampLength(value.size());
+		}
+		else if constexpr (std::is_same<typename std::decay<T>::type, const char*>::value || std::is_same<typename std::decay<T>::type, char*>::value)
+		{
+			return 1 + sizeof(uint32_t) + ClampLength((value != nullptr) ? strlen(value) : 0);
+		}
+		else
+		{
+			static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value, "Only numbers, strings and pointers can be logged");
+			return 1 + sizeof(uint64_t);
+		}
+	}
+
+	template <typename T>
+	static void WriteArgument(unsigned char*& pArgument, const T& value)
+	{
+		if constexpr (std::is_same<T, std::string>::value)
+		{
+			WriteString(pArgument, value.data(), ClampLength(value.size()));
+		}
+		else if constexpr (std::is_same<typename std::decay<T>::type, const char*>::value || std::is_same<typename std::decay<T>::type, char*>::value)
+		{
+			WriteString(pArgument, (value != nullptr) ? value : "(null)", (value != nullptr) ? ClampLength(strlen(value)) : 6);
+		}
+		else if constexpr (std::is_floating_point<T>::value)
+		{
+			WriteValue(pArgument, LOG_ARGUMENT::DOUBLE, (double)value);
+		}
+		else if constexpr (std::is_pointer<T>::value)
+		{
+			WriteValue(pArgument, LOG_ARGUMENT::POINTER, (uint64_t)(uintptr_t)value);
+		}
+		else if constexpr (std::is_enum<T>::value)
+		{
+			WriteValue(pArgument, LOG_ARGUMENT::INT, (int64_t)value);
+		}
+		else if constexpr (std::is_signed<T>::value)
+		{
+			WriteValue(pArgument, LOG_ARGUMENT::INT, (int64_t)value);
+		}
+		else
+		{
+			WriteValue(pArgument, LOG_ARGUMENT::UINT, (uint64_t)value);
+		}
+	}
+
+	template <typename T>
+	static void WriteValue(unsigned char*& pArgument, LOG_ARGUMENT eType, T value)
+	{
+		*pArgument++ = (unsigned char)eType;
+		memcpy(pArgument, &value, sizeof(value));
+		pArgument += sizeof(value);
+	}
+
+	static void WriteString(unsigned char*& pArgument, const char* szText, size_t uLength)
+	{
+		const uint32_t uLength32 = (uint32_t)uLength;
+
+		*pArgument++ = (unsigned char)LOG_ARGUMENT::STRING;
+		memcpy(pArgument, &uLength32, sizeof(uLength32));
+		memcpy(pArgument + sizeof(uLength32), szText, uLength);
+		pArgument += sizeof(uLength32) + uLength;
+	}
+
+	static size_t ClampLength(size_t uLength)
+	{
+		return (uLength < (size_t)kMaxLogStringLength) ? uLength : (size_t)kMaxLogStringLength;
+	}
+
+	static inline thread_local LogThreadBuffer* tBuffer = nullptr;
+};
+
+#if ENGINEH_LOG_LEVEL <= 0
+#define LOG_VERBOSE(...) Logger::Write(LOG_LEVEL::VERBOSE, __VA_ARGS__)
+#else
+#define LOG_VERBOSE(...) ((void)0)
+#endif
+
+#if ENGINEH_LOG_LEVEL <= 1
+#define LOG_INFO(...) Logger::Write(LOG_LEVEL::INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...) ((void)0)
+#endif
+
+#if ENGINEH_LOG_LEVEL <= 2
+#define LOG_WARNING(...) Logger::Write(LOG_LEVEL::WARNING, __VA_ARGS__)
+#else
+#define LOG_WARNING(...) ((void)0)
+#endif
+
+#if ENGINEH_LOG_LEVEL <= 3
+#define LOG_SEVERE(...) Logger::Write(LOG_LEVEL::SEVERE, __VA_ARGS__)
+#else
+#define LOG_SEVERE(...) ((void)0)
+#endif
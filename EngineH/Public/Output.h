@@ -1,20 +1,21 @@
 #pragma once
 
 #include <string>
+#include <type_traits>
+#include "Logger.h"
 
+// The engine's original logging calls, kept for games using them, they log at the INFO level through the Logger
 class Console
 {
 public:
 	static void Log(const char* text);
-	static void LogString(std::string text);
+	static void LogString(const std::string& text);
 	static void LogOpenGL(unsigned int error);
 
 	// Templating the log function
 	template <typename T>
 	static void LogType(T text)
 	{
-		std::string temp(std::to_string(text));
-		const char* finalChar = temp.c_str();
-		Log(finalChar);
+		LOG_INFO(std::is_floating_point<T>::value ? "%f" : "%d", text);
 	}
 };
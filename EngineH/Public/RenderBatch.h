@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+#include "EngineTypes.h"
+
+// Per-instance attributes of a box or circle, the shape itself comes from the shared unit quad
+struct InstanceData
+{
+	float mCenter[2];
+	float mHalfExtents[2];						// half width and height of a box, the radius twice for a circle
+	unsigned char mColor[4];
+	float mLayer;
+};
+
+// A vertex of the primitives that are tessellated on the CPU (lines and text), drawn as plain triangles
+struct BatchVertex
+{
+	float mPosition[3];							// x, y and the layer as z
+	unsigned char mColor[4];
+	float mTexCoords[2];						// position in the glyph atlas page, unused by lines
+};
+
+// Collects the instances and vertices of every primitive drawn during a frame, so they can be streamed to the GPU in one go
+class RenderBatch
+{
+public:
+	RenderBatch();
+	~RenderBatch();
+
+	// Appends an instance of the unit quad centered on v2Center and scaled to the given half extents
+	void AddInstance(const exVector2& v2Center, float fHalfWidth, float fHalfHeight, const exColor& color, int nLayer);
+
+	// Appends a single vertex, every 3 consecutive ones make a triangle
+	void AddVertex(const exVector2& v2Position, const exColor& color, int nLayer);
+
+	void AddVertex(const exVector2& v2Position, float fU, float fV, const exColor& color, int nLayer);
+
+	// Appends all the vertices of another batch
+	void AppendVertices(const RenderBatch& batch);
+
+	// Drops all the instances and vertices, keeping the memory around for the next frame
+	void Clear();
+
+	const InstanceData* GetInstances() const;
+
+	int GetInstanceCount() const;
+
+	int GetInstancesSizeInBytes() const;
+
+	const BatchVertex* GetVertices() const;
+
+	int GetVertexCount() const;
+
+	int GetVerticesSizeInBytes() const;
+
+private:
+	std::vector<InstanceData> mInstances;
+	std::vector<BatchVertex> mVertices;
+};
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "EngineTypes.h"
+
+// The kinds of primitives that can be recorded into a command buffer
+enum class PRIMITIVE_TYPE : unsigned char
+{
+	BOX = 0,
+	CIRCLE,
+	LINE,
+	LINE_BOX,
+	LINE_CIRCLE,
+	TEXT
+};
+
+// Shader programs the primitives are drawn with, part of the sort key so that draws sharing a program end up next to each other
+enum class SHADER_PROGRAM : unsigned char
+{
+	BOX = 0,
+	CIRCLE,
+	LINE,
+	TEXT,
+	COUNT
+};
+
+// A single recorded draw, with everything needed to generate its vertices at the end of the frame
+struct RenderCommand
+{
+	uint64_t mKey;
+	PRIMITIVE_TYPE mType;
+	exColor mColor;
+	int mLayer;
+	exVector2 mP1;								// first corner of a box, center of a circle, start of a line, top left of text
+	exVector2 mP2;								// second corner of a box, end of a line
+	float mRadius;
+	float mWidth;								// width of lines and outlines
+	int mFontID;
+	int mTextOffset;							// where the text starts in the buffer's text storage
+};
+
+// Records the draws of a frame and sorts them on a packed 64-bit key before they are submitted
+// Key layout, most significant first: layer (16 bits) | program (8 bits) | primitive type (8 bits) | depth (32 bits)
+class RenderCommandBuffer
+{
+public:
+	RenderCommandBuffer();
+	~RenderCommandBuffer();
+
+	void AddBox(const exVector2& v2P1, const exVector2& v2P2, const exColor& color, int nLayer);
+
+	void AddCircle(const exVector2& v2Center, float fRadius, const exColor& color, int nLayer);
+
+	void AddLine(const exVector2& v2P1, const exVector2& v2P2, float fWidth, const exColor& color, int nLayer);
+
+	void AddLineBox(const exVector2& v2P1, const exVector2& v2P2, float fWidth, const exColor& color, int nLayer);
+
+	void AddLineCircle(const exVector2& v2Center, float fRadius, float fWidth, const exColor& color, int nLayer);
+
+	// The text is copied, the caller's string only has to live until this returns
+	void AddText(int nFontID, const exVector2& v2Position, const char* szText, const exColor& color, int nLayer);
+
+	// The text of a TEXT command, valid until the buffer is cleared
+	const char* GetText(const RenderCommand& command) const;
+
+	// Adds another buffer's commands after this one's, as if they had been recorded here in the same order
+	void Append(const RenderCommandBuffer& other);
+
+	// Trades commands with another buffer, which is all a merge takes when only one of them has any
+	void Swap(RenderCommandBuffer& other);
+
+	// Drops the commands that can't touch the viewport seen by the camera, returns how many were dropped
+	// The bounds are tested four at a time, before any vertex is generated, text is always kept since how far it reaches depends on its font
+	int CullToView(const exVector2& v2CameraPosition, float fCameraZoom);
+
+	// Radix sorts the recorded commands on their keys, equal keys keep the order they were recorded in
+	void Sort();
+
+	// Drops all the commands, keeping the memory around for the next frame
+	void Clear();
+
+	int GetCommandCount() const;
+
+	// Only valid after Sort(), returns the commands in key order
+	const RenderCommand& GetSortedCommand(int nIndex) const;
+
+	static uint64_t MakeSortKey(int nLayer, SHADER_PROGRAM eProgram, PRIMITIVE_TYPE eType, uint32_t uDepth);
+
+	static SHADER_PROGRAM GetProgramFromKey(uint64_t uKey);
+
+	static SHADER_PROGRAM GetProgramForPrimitive(PRIMITIVE_TYPE eType);
+
+private:
+	// Stamps the key on a command and stores it along with its bounds
+	void AddCommand(RenderCommand& command);
+
+	// Stores the world space box a command can touch
+	void AddBounds(const RenderCommand& command);
+
+	// What actually gets sorted, moving 16 bytes per entry instead of whole commands
+	struct SortEntry
+	{
+		uint64_t mKey;
+		uint32_t mIndex;
+	};
+
+	std::vector<RenderCommand> mCommands;
+	std::vector<SortEntry> mSortEntries;
+	std::vector<SortEntry> mSortScratch;
+
+	// The bounds of every command, one array per coordinate and apart from the commands so culling reads nothing else
+	std::vector<float> mBoundsMinX;
+	std::vector<float> mBoundsMinY;
+	std::vector<float> mBoundsMaxX;
+	std::vector<float> mBoundsMaxY;
+
+	// Indices of the commands that survive culling
+	std::vector<uint32_t> mVisible;
+
+	// The strings of this frame's text commands, one after the other with their terminators
+	std::vector<char> mText;
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+// What the engine did for a frame, counters an engine has no use for stay at 0
+struct RenderStats
+{
+	RenderStats();
+
+	uint64_t mFrame;
+	int mCommands;								// draws recorded by the game and left after culling
+	int mCulledCommands;						// draws dropped for being outside the camera's view
+	int mDrawCalls;								// draws issued to the GPU, primitives handed to the rasterizer for the software engine
+	int mInstances;
+	int mVertices;								// every instance counts its 4 quad corners
+	size_t mUploadedBytes;						// streamed instances and vertices, the camera block and glyph atlas pages
+	int mProgramBinds;
+	int mVertexArrayBinds;
+	int mStateChanges;							// every bind and capability change reaching GL, programs and vertex arrays included
+	int mElidedStateChanges;
+	float mFrameMilliseconds;					// CPU time spent in the engine's OnFrame
+};
+
+// Appends one line of RenderStats per frame to a CSV file, with a header naming the columns
+class RenderStatsWriter
+{
+public:
+	RenderStatsWriter();
+	~RenderStatsWriter();
+
+	// Starts a new file, replacing the one being written if any, false if it can't be created
+	bool Open(const char* szFile);
+
+	void Close();
+
+	bool IsOpen() const;
+
+	void Write(const RenderStats& stats);
+
+private:
+	FILE* mFile;
+};
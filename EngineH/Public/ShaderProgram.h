@@ -0,0 +1,75 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "EngineTypes.h"
+
+// Forward declaring the GL types in use
+typedef int GLint;
+typedef unsigned int GLuint;
+typedef unsigned int GLenum;
+
+// Handle to a uniform of a known type, resolved once when the program is linked
+// Only ShaderProgram::GetUniform hands out valid ones, and only if the shader declares the uniform with a matching type
+template <typename T>
+struct UniformHandle
+{
+	GLint mLocation = -1;
+
+	bool IsValid() const
+	{
+		return mLocation >= 0;
+	}
+};
+
+// An active uniform or attribute as reported by GL after linking
+struct ShaderVariable
+{
+	std::string mName;
+	GLint mLocation;
+	GLenum mType;
+	GLint mSize;
+};
+
+// A linked GL program, reflected at link time so nothing is ever looked up by name while drawing
+class ShaderProgram
+{
+public:
+	ShaderProgram();
+	~ShaderProgram();
+
+	// Links the two shaders and reflects the program's active uniforms and attributes, false if linking failed
+	bool Link(GLuint gluVertexShader, GLuint gluFragmentShader);
+
+	GLuint GetHandle() const;
+
+	// Supported types are exMatrix4, exColorF, exVector2, float and int (which also covers samplers)
+	template <typename T>
+	UniformHandle<T> GetUniform(const char* szName) const;
+
+	// -1 if the program has no active attribute with that name
+	GLint GetAttributeLocation(const char* szName) const;
+
+	// Connects the named uniform block to a binding point, false if the program has no such block
+	bool BindUniformBlock(const char* szName, GLuint uBindingPoint) const;
+
+	const std::vector<ShaderVariable>& GetUniforms() const;
+
+	const std::vector<ShaderVariable>& GetAttributes() const;
+
+	// The program has to be in use for these
+	void SetUniform(UniformHandle<exMatrix4> handle, const exMatrix4& value) const;
+	void SetUniform(UniformHandle<exColorF> handle, const exColorF& value) const;
+	void SetUniform(UniformHandle<exVector2> handle, const exVector2& value) const;
+	void SetUniform(UniformHandle<float> handle, float value) const;
+	void SetUniform(UniformHandle<int> handle, int value) const;
+
+private:
+	void Reflect();
+
+	const ShaderVariable* FindUniform(const char* szName) const;
+
+	GLuint mProgram;
+	std::vector<ShaderVariable> mUniforms;
+	std::vector<ShaderVariable> mAttributes;
+};
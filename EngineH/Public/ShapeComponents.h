@@ -0,0 +1,45 @@
+#pragma once
+
+#include "EngineTypes.h"
+
+class EntityWorld;
+class exEngineInterface;
+
+// Where an entity is, the center of its shape
+// Whatever moves it sets the previous position to where it was before the step, shapes are drawn between the two
+struct TransformComponent
+{
+	exVector2 mPosition;
+	exVector2 mPreviousPosition;
+};
+
+// How far an entity moves every second
+struct VelocityComponent
+{
+	exVector2 mVelocity;
+};
+
+// Drawn with DrawBox, around the transform's position
+struct BoxComponent
+{
+	exVector2 mHalfSize;
+	exColor mColor;
+	int mLayer;
+};
+
+// Drawn with DrawCircle, around the transform's position
+struct CircleComponent
+{
+	float mRadius;
+	exColor mColor;
+	int mLayer;
+};
+
+// Draws the entities having a transform and a box or a circle straight from their chunks
+// The chunks are split over the engine's job system, each thread records into its own command buffer
+// fAlpha is the one Render gets, 0 draws the shapes at their previous positions and 1 at their current ones
+class ShapeRenderer
+{
+public:
+	static void Draw(EntityWorld& world, exEngineInterface* pEngine, float fAlpha);
+};
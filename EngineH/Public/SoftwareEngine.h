@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+#include "WindowlessEngine.h"
+#include "RenderBatch.h"
+#include "LineTessellator.h"
+#include "SoftwareRasterizer.h"
+
+// An engine rendering on the CPU, for machines without a GPU
+// It records and sorts draws exactly like EngineH, then hands them to a tiled, multithreaded SoftwareRasterizer instead of GL
+class SoftwareEngine : public WindowlessEngine
+{
+public:
+	SoftwareEngine();
+	~SoftwareEngine();
+
+	virtual void				Run(exGameInterface* pGameInterface);
+
+	// Restarts the job system, which also rasterizes the tiles, with that many workers next to the thread running the game
+	// Negative uses every hardware thread, it can't be called while the game runs
+	void						SetWorkerThreadCount(int nThreads);
+
+	// Time spent rasterizing the last frame, in milliseconds
+	float						GetRasterizeTimeLastFrame() const;
+
+	// The last frame rendered
+	const SoftwareRasterizer&	GetRasterizer() const;
+
+protected:
+	virtual void OnFrame(float fDeltaT);
+
+private:
+	// Sorts everything recorded this frame and turns it into screen space primitives for the rasterizer
+	void FlushCommands();
+
+	exVector2 WorldToScreen(const exVector2& v2World) const;
+
+private:
+	float mRasterizeTime;
+
+	LineTessellator mLineTessellator;
+	// Scratch space for tessellating a single command
+	RenderBatch mLineBatch;
+	std::vector<exVector2> mScreenPoints;
+
+	// A batch per atlas page, for laying out a single text command
+	std::vector<RenderBatch> mTextPageBatches;
+
+	SoftwareRasterizer mRasterizer;
+};
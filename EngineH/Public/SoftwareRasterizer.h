@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "EngineTypes.h"
+
+class GlyphAtlas;
+class JobSystem;
+
+// Width and height in pixels of the tiles the framebuffer is split into, each tile is rasterized by a single job
+const int kRasterTileSize = 64;
+
+enum class RASTER_PRIMITIVE : unsigned char
+{
+	BOX = 0,
+	CIRCLE,
+	TRIANGLES,
+	GLYPH
+};
+
+// A primitive in screen space (pixels, y down), in the order it has to be drawn
+struct RasterPrimitive
+{
+	RASTER_PRIMITIVE mType;
+	uint32_t mColor;							// packed RGBA, red in the lowest byte
+	float mBounds[4];							// min x, min y, max x, max y
+	float mCenter[2];							// circles only
+	float mRadius;								// circles only
+	int mFirstVertex;							// triangles only, every 3 vertices make a triangle
+	int mVertexCount;
+	float mTexCoords[4];						// glyphs only, u0, v0, u1, v1 of the atlas page
+	int mPage;									// glyphs only
+	float mOpacity;								// glyphs only, the color's alpha
+};
+
+// Rasterizes boxes, circles, triangles and glyphs into an RGBA8 framebuffer on the CPU
+// Primitives are binned into tiles as they are added, then the tiles are rasterized in parallel as jobs
+// Everything is opaque apart from the glyphs, which are blended with their coverage, so drawing in order is all the depth handling needed
+class SoftwareRasterizer
+{
+public:
+	SoftwareRasterizer();
+	~SoftwareRasterizer();
+
+	// Allocates the framebuffer
+	void Initialize(int nWidth, int nHeight);
+
+	// Drops last frame's primitives, the framebuffer is cleared to the color when the tiles are rasterized
+	void BeginFrame(const exColor& clearColor);
+
+	void AddBox(const exVector2& v2Min, const exVector2& v2Max, const exColor& color);
+
+	void AddCircle(const exVector2& v2Center, float fRadius, const exColor& color);
+
+	// nCount points, every 3 make a triangle
+	void AddTriangles(const exVector2* pPoints, int nCount, const exColor& color);
+
+	// The glyph's quad covers v2Min to v2Max and samples the page's coverage between the two texture coordinates
+	void AddGlyph(const exVector2& v2Min, const exVector2& v2Max, const float* pTexCoords, int nPage, const exColor& color);
+
+	// Where glyphs sample their coverage from
+	void SetGlyphAtlas(const GlyphAtlas* pAtlas);
+
+	// Rasterizes every tile on the job system's threads, returns once the whole framebuffer is done
+	void Rasterize(JobSystem& jobSystem);
+
+	// RGBA8 pixels, row after row from the top
+	const uint32_t* GetPixels() const;
+
+	int GetWidth() const;
+
+	int GetHeight() const;
+
+	// Primitives added since BeginFrame, and the vertices of their triangles
+	int GetPrimitiveCount() const;
+
+	int GetVertexCount() const;
+
+	// Writes the framebuffer as a binary PPM, false if the file can't be written
+	bool WriteImage(const char* szFile) const;
+
+	static uint32_t PackColor(const exColor& color);
+
+private:
+	void AddPrimitive(const RasterPrimitive& primitive);
+
+	void RasterizeTile(int nTile);
+
+	void DrawBox(const RasterPrimitive& primitive, int nMinX, int nMinY, int nMaxX, int nMaxY);
+
+	void DrawCircle(const RasterPrimitive& primitive, int nMinX, int nMinY, int nMaxX, int nMaxY);
+
+	void DrawTriangles(const RasterPrimitive& primitive, int nMinX, int nMinY, int nMaxX, int nMaxY);
+
+	void DrawGlyph(const RasterPrimitive& primitive, int nMinX, int nMinY, int nMaxX, int nMaxY);
+
+	int mWidth;
+	int mHeight;
+	int mTilesX;
+	int mTilesY;
+	std::vector<uint32_t> mPixels;
+	uint32_t mClearColor;
+
+	std::vector<RasterPrimitive> mPrimitives;
+	std::vector<exVector2> mVertices;
+	// Indices of the primitives touching each tile, in drawing order
+	std::vector<std::vector<int>> mTileBins;
+	const GlyphAtlas* mGlyphAtlas;
+};
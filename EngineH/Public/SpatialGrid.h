@@ -0,0 +1,351 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "EngineTypes.h"
+
+// Finds the objects of a game near a point, a box or a ray without testing every one of them
+// A uniform grid of square cells over an unbounded world, only the cells something has touched exist, found through a hash table
+// Every object is listed in each cell its box overlaps, so the cell size should be around the size of a typical object,
+// much smaller makes big objects expensive to move and much larger makes queries test more objects than they need to
+// Objects are identified by the ID Insert returns, IDs of removed objects are handed out again
+// Queries call a function for every object found, each object once, and allocate nothing
+// The grid isn't thread safe, but any number of threads can query it at once while nothing changes it
+class SpatialGrid
+{
+public:
+	SpatialGrid();
+	~SpatialGrid();
+
+	// Drops everything, the cells included, and starts over with cells fCellSize wide
+	void Initialize(float fCellSize);
+
+	// Returns the new object's ID
+	int Insert(const exVector2& v2Min, const exVector2& v2Max);
+
+	// Moves an object, which only touches the cells when it has moved into different ones
+	void Update(int nID, const exVector2& v2Min, const exVector2& v2Max);
+
+	void Remove(int nID);
+
+	// The same over arrays of objects, pIDs gets the IDs of the inserted ones
+	void InsertMany(const exVector2* pMins, const exVector2* pMaxs, int nCount, int* pIDs);
+
+	void UpdateMany(const int* pIDs, const exVector2* pMins, const exVector2* pMaxs, int nCount);
+
+	void RemoveMany(const int* pIDs, int nCount);
+
+	// Removes every object, the cells go too since a scrolling world can leave a lot of them behind
+	void Clear();
+
+	int GetCount() const;
+
+	float GetCellSize() const;
+
+	// Calls function(nID) for every object whose box overlaps the box
+	template <typename Function>
+	void QueryBox(const exVector2& v2Min, const exVector2& v2Max, Function&& function) const
+	{
+		CellRange range;
+		range.mMinX = ToCell(v2Min.x);
+		range.mMinY = ToCell(v2Min.y);
+		range.mMaxX = ToCell(v2Max.x);
+		range.mMaxY = ToCell(v2Max.y);
+
+		ForEachInRange(range, [&](int nID, int nX, int nY)
+		{
+			const CellRange& objectRange = mRanges[nID];
+
+			// An object spanning several of the cells is only reported from the first of them
+			if (nX != Max(objectRange.mMinX, range.mMinX) || nY != Max(objectRange.mMinY, range.mMinY))
+			{
+				return;
+			}
+
+			const Bounds& bounds = mBounds[nID];
+
+			if (bounds.mMaxX >= v2Min.x && bounds.mMinX <= v2Max.x && bounds.mMaxY >= v2Min.y && bounds.mMinY <= v2Max.y)
+			{
+				function(nID);
+			}
+		});
+	}
+
+	// Calls function(nID) for every object whose box is within fRadius of the center
+	template <typename Function>
+	void QueryRadius(const exVector2& v2Center, float fRadius, Function&& function) const
+	{
+		const float fSquaredRadius = fRadius * fRadius;
+
+		QueryBox(exVector2(v2Center.x - fRadius, v2Center.y - fRadius), exVector2(v2Center.x + fRadius, v2Center.y + fRadius), [&](int nID)
+		{
+			const Bounds& bounds = mBounds[nID];
+
+			// Distance from the center to the closest point of the box
+			const float fDX = v2Center.x - Clamp(v2Center.x, bounds.mMinX, bounds.mMaxX);
+			const float fDY = v2Center.y - Clamp(v2Center.y, bounds.mMinY, bounds.mMaxY);
+
+			if (fDX * fDX + fDY * fDY <= fSquaredRadius)
+			{
+				function(nID);
+			}
+		});
+	}
+
+	// Calls function(nID, fDistance) for every object the ray hits within fMaxDistance, which has to be finite
+	// fDistance is how far along the ray the object's box starts, 0 for boxes around the origin
+	// The cells are walked from the origin outwards, so objects come roughly but not exactly nearest first
+	template <typename Function>
+	void QueryRay(const exVector2& v2Origin, const exVector2& v2Direction, float fMaxDistance, Function&& function) const
+	{
+		const float fLength = v2Direction.Magnitude();
+
+		if (fLength <= 0.0f || !(fMaxDistance >= 0.0f))
+		{
+			return;
+		}
+
+		const exVector2 v2Step = v2Direction / fLength;
+		const float fInverseX = (v2Step.x != 0.0f) ? 1.0f / v2Step.x : INFINITY;
+		const float fInverseY = (v2Step.y != 0.0f) ? 1.0f / v2Step.y : INFINITY;
+
+		// Walking the cells the ray crosses in order, one step along x or y at a time
+		int nX = ToCell(v2Origin.x);
+		int nY = ToCell(v2Origin.y);
+		const int nStepX = (v2Step.x > 0.0f) ? 1 : ((v2Step.x < 0.0f) ? -1 : 0);
+		const int nStepY = (v2Step.y > 0.0f) ? 1 : ((v2Step.y < 0.0f) ? -1 : 0);
+
+		// Distances along the ray to the next vertical and horizontal cell edges, and between two of them
+		float fNextX = (nStepX != 0) ? ((nX + (nStepX > 0 ? 1 : 0)) * mCellSize - v2Origin.x) * fInverseX : INFINITY;
+		float fNextY = (nStepY != 0) ? ((nY + (nStepY > 0 ? 1 : 0)) * mCellSize - v2Origin.y) * fInverseY : INFINITY;
+		const float fDeltaX = (nStepX != 0) ? mCellSize * fabsf(fInverseX) : INFINITY;
+		const float fDeltaY = (nStepY != 0) ? mCellSize * fabsf(fInverseY) : INFINITY;
+
+		bool bFirst = true;
+		int nPreviousX = nX;
+		int nPreviousY = nY;
+
+		for (;;)
+		{
+			const int nCell = FindCell(nX, nY);
+
+			if (nCell >= 0)
+			{
+				for (int nID : mCells[nCell].mObjects)
+				{
+					// The cells the ray crosses inside an object's range are consecutive, it is reported from the first of them
+					if (!bFirst && mRanges[nID].Contains(nPreviousX, nPreviousY))
+					{
+						continue;
+					}
+
+					float fDistance;
+
+					if (IntersectRay(mBounds[nID], v2Origin, fInverseX, fInverseY, fMaxDistance, fDistance))
+					{
+						function(nID, fDistance);
+					}
+				}
+			}
+
+			const float fNext = (fNextX < fNextY) ? fNextX : fNextY;
+
+			if (fNext > fMaxDistance)
+			{
+				break;
+			}
+
+			bFirst = false;
+			nPreviousX = nX;
+			nPreviousY = nY;
+
+			if (fNextX < fNextY)
+			{
+				nX += nStepX;
+				fNextX += fDeltaX;
+			}
+			else
+			{
+				nY += nStepY;
+				fNextY += fDeltaY;
+			}
+		}
+	}
+
+private:
+	struct Bounds
+	{
+		float mMinX;
+		float mMinY;
+		float mMaxX;
+		float mMaxY;
+	};
+
+	// The cells an object overlaps, inclusive, empty for IDs that aren't in use
+	struct CellRange
+	{
+		int mMinX;
+		int mMinY;
+		int mMaxX;
+		int mMaxY;
+
+		bool Contains(int nX, int nY) const
+		{
+			return nX >= mMinX && nX <= mMaxX && nY >= mMinY && nY <= mMaxY;
+		}
+	};
+
+	struct Cell
+	{
+		int64_t mKey;
+		std::vector<int> mObjects;
+	};
+
+	// Calls function(nID, nX, nY) for every object listed in every existing cell of the range
+	template <typename Function>
+	void ForEachInRange(const CellRange& range, Function&& function) const
+	{
+		const int64_t nWidth = (int64_t)range.mMaxX - range.mMinX + 1;
+		const int64_t nHeight = (int64_t)range.mMaxY - range.mMinY + 1;
+
+		if (nWidth <= 0 || nHeight <= 0)
+		{
+			return;
+		}
+
+		// A range with more cells than exist is cheaper to answer by going over the cells that do
+		if (nWidth * nHeight > (int64_t)mCells.size())
+		{
+			for (const Cell& cell : mCells)
+			{
+				const int nX = GetCellX(cell.mKey);
+				const int nY = GetCellY(cell.mKey);
+
+				if (range.Contains(nX, nY))
+				{
+					for (int nID : cell.mObjects)
+					{
+						function(nID, nX, nY);
+					}
+				}
+			}
+
+			return;
+		}
+
+		for (int nY = range.mMinY; nY <= range.mMaxY; ++nY)
+		{
+			for (int nX = range.mMinX; nX <= range.mMaxX; ++nX)
+			{
+				const int nCell = FindCell(nX, nY);
+
+				if (nCell >= 0)
+				{
+					for (int nID : mCells[nCell].mObjects)
+					{
+						function(nID, nX, nY);
+					}
+				}
+			}
+		}
+	}
+
+	// Slab test, the distance along the ray at which it enters the box
+	static bool IntersectRay(const Bounds& bounds, const exVector2& v2Origin, float fInverseX, float fInverseY, float fMaxDistance, float& fDistance)
+	{
+		float fEnter = 0.0f;
+		float fExit = fMaxDistance;
+
+		if (fInverseX != INFINITY)
+		{
+			const float fT1 = (bounds.mMinX - v2Origin.x) * fInverseX;
+			const float fT2 = (bounds.mMaxX - v2Origin.x) * fInverseX;
+			fEnter = Max(fEnter, (fT1 < fT2) ? fT1 : fT2);
+			fExit = Min(fExit, (fT1 > fT2) ? fT1 : fT2);
+		}
+		else if (v2Origin.x < bounds.mMinX || v2Origin.x > bounds.mMaxX)
+		{
+			return false;
+		}
+
+		if (fInverseY != INFINITY)
+		{
+			const float fT1 = (bounds.mMinY - v2Origin.y) * fInverseY;
+			const float fT2 = (bounds.mMaxY - v2Origin.y) * fInverseY;
+			fEnter = Max(fEnter, (fT1 < fT2) ? fT1 : fT2);
+			fExit = Min(fExit, (fT1 > fT2) ? fT1 : fT2);
+		}
+		else if (v2Origin.y < bounds.mMinY || v2Origin.y > bounds.mMaxY)
+		{
+			return false;
+		}
+
+		fDistance = fEnter;
+		return fEnter <= fExit;
+	}
+
+	int ToCell(float fCoordinate) const
+	{
+		// Clamped so far away coordinates can't overflow the cell coordinates
+		const float fCell = floorf(fCoordinate * mInverseCellSize);
+		return (fCell < -kMaxCell) ? -kMaxCell : ((fCell > kMaxCell) ? kMaxCell : (int)fCell);
+	}
+
+	CellRange GetCellRange(const exVector2& v2Min, const exVector2& v2Max) const;
+
+	// Index of the cell in mCells, -1 if nothing has ever been in it
+	int FindCell(int nX, int nY) const;
+
+	int FindOrAddCell(int nX, int nY);
+
+	void AddToCells(int nID, const CellRange& range);
+
+	void RemoveFromCells(int nID, const CellRange& range);
+
+	void RemoveFromCell(int nID, int nCell);
+
+	void GrowTable();
+
+	static int64_t MakeCellKey(int nX, int nY)
+	{
+		return (int64_t)(((uint64_t)(uint32_t)nX << 32) | (uint32_t)nY);
+	}
+
+	static int GetCellX(int64_t nKey)
+	{
+		return (int)(uint32_t)((uint64_t)nKey >> 32);
+	}
+
+	static int GetCellY(int64_t nKey)
+	{
+		return (int)(uint32_t)nKey;
+	}
+
+	static uint32_t HashCellKey(int64_t nKey)
+	{
+		return (uint32_t)(((uint64_t)nKey * 0x9E3779B97F4A7C15ull) >> 32);
+	}
+
+	static int Max(int a, int b) { return (a > b) ? a : b; }
+	static float Max(float a, float b) { return (a > b) ? a : b; }
+	static float Min(float a, float b) { return (a < b) ? a : b; }
+	static float Clamp(float f, float fMin, float fMax) { return (f < fMin) ? fMin : ((f > fMax) ? fMax : f); }
+
+	static const int kMaxCell = 1 << 30;
+
+	float mCellSize;
+	float mInverseCellSize;
+
+	// Indexed by object ID
+	std::vector<Bounds> mBounds;
+	std::vector<CellRange> mRanges;
+	std::vector<int> mFreeIDs;
+	int mCount;
+
+	// Cells are never removed before Clear, objects moving back into one find it ready
+	std::vector<Cell> mCells;
+
+	// Open addressing table of indices into mCells, -1 for free slots, its size is a power of 2
+	std::vector<int> mTable;
+};
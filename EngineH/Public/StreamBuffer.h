@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+
+// Forward declaring the GL types in use
+typedef unsigned int GLuint;
+typedef unsigned int GLenum;
+typedef struct __GLsync* GLsync;
+
+class GLStateCache;
+
+// Number of frames the CPU may run ahead of the GPU before it has to wait on a fence
+const int kFramesInFlight = 3;
+
+// A large GL buffer used as a ring, with one region per frame in flight
+// Every frame sub-allocates from its own region through unsynchronized maps, and a fence placed at the end of the frame
+// tells when the GPU is done reading that region so it can be written again, instead of reallocating storage on every upload
+class StreamBuffer
+{
+public:
+	StreamBuffer();
+	~StreamBuffer();
+
+	// Creates the buffer, uRegionSize bytes are available to each frame before the buffer has to grow
+	// All of the buffer's binds go through the given state cache
+	void Initialize(GLStateCache& stateCache, GLenum eTarget, size_t uRegionSize);
+
+	// Reserves uSize bytes in this frame's region and maps them, the returned pointer is write only and valid until Unmap()
+	// uOutOffset is the offset of the allocation from the start of the buffer, a multiple of uAlignment
+	// If the region has to grow, earlier allocations of the same frame are lost, so a frame's data should be mapped at once
+	void* Map(size_t uSize, size_t uAlignment, size_t& uOutOffset);
+
+	void Unmap();
+
+	// Fences the current region once all of the frame's draws have been issued and moves on to the next one
+	void EndFrame();
+
+	GLuint GetBuffer() const;
+
+	size_t GetBytesStreamedLastFrame() const;
+
+private:
+	// Waits until the GPU is done with what was streamed into the current region kFramesInFlight frames ago
+	void WaitForRegion();
+
+	// Orphans the storage for a bigger one, the fenced regions belong to the old storage so they can be dropped
+	void Grow(size_t uRequiredRegionSize);
+
+	GLStateCache* mStateCache;
+	GLenum mTarget;
+	GLuint mBuffer;
+	size_t mRegionSize;
+	int mRegion;
+	size_t mHead;								// next free byte, relative to the start of the current region
+	bool mRegionReady;							// the current region's fence has been waited on
+	GLsync mFences[kFramesInFlight];
+
+	size_t mBytesStreamedThisFrame;
+	size_t mBytesStreamedLastFrame;
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+#include "EntityWorld.h"
+#include "FrameGraph.h"
+
+// Runs the systems updating an EntityWorld, as many of them at once as the components they touch allow
+// Every system declares the component types it reads and writes, a system runs after the systems added before it that write
+// what it touches or touch what it writes, and alongside all the others, each as a job
+// The systems become the stages of a FrameGraph, built again the first time they run after one is added or changed
+// Systems may make no structural changes to the world, those go between runs
+class SystemScheduler
+{
+public:
+	SystemScheduler();
+	~SystemScheduler();
+
+	// Returns the system's number, function gets the time step passed to Run
+	int AddSystem(const char* szName, std::function<void(float fDeltaT)> function);
+
+	template <typename T>
+	void AddRead(int nSystem)
+	{
+		AddAccess(nSystem, EntityWorld::GetComponentType<T>(), RESOURCE_ACCESS::READ);
+	}
+
+	template <typename T>
+	void AddWrite(int nSystem)
+	{
+		AddAccess(nSystem, EntityWorld::GetComponentType<T>(), RESOURCE_ACCESS::WRITE);
+	}
+
+	// Runs every system once and returns when they are all done
+	void Run(JobSystem& jobSystem, float fDeltaT);
+
+	int GetSystemCount() const;
+
+	const char* GetSystemName(int nSystem) const;
+
+	// Time the system took the last time it ran, in milliseconds
+	float GetSystemTime(int nSystem) const;
+
+private:
+	struct System
+	{
+		const char* mName;
+		std::function<void(float fDeltaT)> mFunction;
+		std::vector<std::pair<int, RESOURCE_ACCESS>> mAccesses;	// component types
+	};
+
+	void AddAccess(int nSystem, int nType, RESOURCE_ACCESS eAccess);
+
+	// True if the systems touch a component type and at least one of them writes it
+	static bool Conflicts(const System& a, const System& b);
+
+	void BuildGraph();
+
+	std::vector<System> mSystems;
+
+	// nullptr until the systems next run whenever they change
+	std::unique_ptr<FrameGraph> mGraph;
+
+	float mDeltaT;
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include "EngineInterface.h"
+#include "GameInterface.h"
+#include "EngineTypes.h"
+#include "RenderCommandBuffer.h"
+#include "CommandRecorder.h"
+#include "Font.h"
+#include "GlyphAtlas.h"
+#include "FixedTimestep.h"
+#include "JobSystem.h"
+#include "RenderStats.h"
+
+// What the engines without a window have in common, everything but what they do with a frame once it is recorded
+// Draws are recorded exactly like EngineH does, and the game runs at a fixed step since there is no display to keep up with,
+// so the same game always produces the same frames
+class WindowlessEngine : public exEngineInterface
+{
+public:
+	WindowlessEngine();
+	~WindowlessEngine();
+
+	// Runs the game until the frame limit is reached, or forever if there is none
+	virtual void				Run(exGameInterface* pGameInterface);
+
+	virtual void				DrawLine(const exVector2& v2P1, const exVector2& v2P2, const exColor& color, int nLayer);
+
+	virtual void				DrawBox(const exVector2& v2P1, const exVector2& v2P2, const exColor& color, int nLayer);
+
+	virtual void				DrawLineBox(const exVector2& v2P1, const exVector2& v2P2, const exColor& color, int nLayer);
+
+	virtual void				DrawCircle(const exVector2& v2Center, float fRadius, const exColor& color, int nLayer);
+
+	virtual void				DrawLineCircle(const exVector2& v2Center, float fRadius, const exColor& color, int nLayer);
+
+	virtual int					LoadFont(const char* szFile, int nPTSize);
+
+	virtual void				DrawText(int nFontID, const exVector2& v2Position, const char* szText, const exColor& color, int nLayer);
+
+	virtual void				SetCamera(const exVector2& v2Position, float fZoom);
+
+	virtual void				SetLineWidth(float fWidth);
+
+	virtual void				SetFixedTimestep(float fStep, int nMaxSteps);
+
+	virtual JobSystem&			GetJobSystem();
+
+	virtual RenderStats			GetRenderStats();
+
+	virtual bool				SetRenderStatsFile(const char* szFile);
+
+	// Number of frames Run goes through before returning, 0 (the default) never returns
+	void						SetFrameLimit(int nFrames);
+
+protected:
+	// Everything a frame takes once the game has drawn it
+	virtual void OnFrame(float fDeltaT) = 0;
+
+	// Runs the game for a frame, leaving what it drew and the camera can see in mCommandBuffer, returns the number of draws culled
+	int RecordFrame(float fDeltaT);
+
+protected:
+	exGameInterface* mGame;
+
+	int mFrameLimit;
+
+	exVector2 mCameraPosition;
+	float mCameraZoom;
+	float mLineWidth;
+
+	FixedTimestep mFixedTimestep;
+
+	JobSystem mJobSystem;
+
+	// Every thread drawing during the game's Run records into its own buffer, merged into this one once it is done
+	CommandRecorder mCommandRecorder;
+	RenderCommandBuffer mCommandBuffer;
+
+	std::vector<Font> mFonts;
+	// The number of fonts, stored once a font is in so DrawText can check ids from any thread
+	std::atomic<int> mFontCount;
+	GlyphAtlas mGlyphAtlas;
+
+	RenderStats mStats;
+	RenderStatsWriter mStatsWriter;
+};
@@ -1,4 +1,5 @@
 #include "Game.h"
+#include "ShapeComponents.h"
 
 exGame::exGame()
 {
@@ -14,9 +15,77 @@ void exGame::Initialize(exEngineInterface* pEngine)
 {
 	mEngine = pEngine;
 
-	mBoxColor.SetColor(255, 0, 0);
-	mBoxVertex1 = {150, 0};
-	mBoxVertex2 = {kViewportWidth / 2 , kViewportHeight / 2};
+	// The box from (150, 0) to the middle of the viewport
+	TransformComponent transform;
+	transform.mPosition = exVector2((150 + kViewportWidth / 2) / 2.0f, kViewportHeight / 4.0f);
+	transform.mPreviousPosition = transform.mPosition;
+
+	BoxComponent box;
+	box.mHalfSize = exVector2((kViewportWidth / 2 - 150) / 2.0f, kViewportHeight / 4.0f);
+	box.mColor.SetColor(255, 0, 0);
+	box.mLayer = 1;
+
+	mWorld.CreateEntity(transform, box);
+
+	// A circle bouncing around the viewport
+	transform.mPosition = exVector2(kViewportWidth * 0.75f, kViewportHeight * 0.75f);
+	transform.mPreviousPosition = transform.mPosition;
+
+	VelocityComponent velocity;
+	velocity.mVelocity = exVector2(120.0f, -90.0f);
+
+	CircleComponent circle;
+	circle.mRadius = 40.0f;
+	circle.mColor.SetColor(0, 0, 255);
+	circle.mLayer = 2;
+
+	mWorld.CreateEntity(transform, velocity, circle);
+
+	// Moving writes the transforms bouncing reads, so bouncing always runs once everything has moved
+	const int nMovement = mSystems.AddSystem("Movement", [this](float fDeltaT)
+	{
+		mWorld.ParallelForEachChunk<TransformComponent, const VelocityComponent>(mEngine->GetJobSystem(),
+			[fDeltaT](int nCount, const Entity*, TransformComponent* pTransforms, const VelocityComponent* pVelocities)
+		{
+			for (int i = 0; i < nCount; ++i)
+			{
+				pTransforms[i].mPreviousPosition = pTransforms[i].mPosition;
+				pTransforms[i].mPosition += pVelocities[i].mVelocity * fDeltaT;
+			}
+		});
+	});
+
+	mSystems.AddWrite<TransformComponent>(nMovement);
+	mSystems.AddRead<VelocityComponent>(nMovement);
+
+	const int nBounce = mSystems.AddSystem("Bounce", [this](float fDeltaT)
+	{
+		mWorld.ParallelForEachChunk<const TransformComponent, const CircleComponent, VelocityComponent>(mEngine->GetJobSystem(),
+			[](int nCount, const Entity*, const TransformComponent* pTransforms, const CircleComponent* pCircles, VelocityComponent* pVelocities)
+		{
+			for (int i = 0; i < nCount; ++i)
+			{
+				const exVector2& v2Position = pTransforms[i].mPosition;
+				const float fRadius = pCircles[i].mRadius;
+				exVector2& v2Velocity = pVelocities[i].mVelocity;
+
+				// Only turned around when heading out, a circle already on its way back in keeps going
+				if ((v2Position.x < fRadius && v2Velocity.x < 0.0f) || (v2Position.x > kViewportWidth - fRadius && v2Velocity.x > 0.0f))
+				{
+					v2Velocity.x = -v2Velocity.x;
+				}
+
+				if ((v2Position.y < fRadius && v2Velocity.y < 0.0f) || (v2Position.y > kViewportHeight - fRadius && v2Velocity.y > 0.0f))
+				{
+					v2Velocity.y = -v2Velocity.y;
+				}
+			}
+		});
+	});
+
+	mSystems.AddRead<TransformComponent>(nBounce);
+	mSystems.AddRead<CircleComponent>(nBounce);
+	mSystems.AddWrite<VelocityComponent>(nBounce);
 }
 
 const char* exGame::GetWindowName() const
@@ -44,9 +113,13 @@ void exGame::OnEventsConsumed()
 
 void exGame::Run(float fDeltaT)
 {
-	mEngine->DrawBox(mBoxVertex1, mBoxVertex2, mBoxColor, 1);
-	
-	// Drawing a circle
-	//mEngine->DrawCircle(mBoxVertex1, 40.0f, mBoxColor, 2);
+	// Drawing stays in Render, Run can go several times a frame at a fixed step
+	mSystems.Run(mEngine->GetJobSystem(), fDeltaT);
+}
+
+void exGame::Render(float fAlpha)
+{
+	// Every entity with a shape, a circle is an entity with a CircleComponent instead of the BoxComponent
+	ShapeRenderer::Draw(mWorld, mEngine, fAlpha);
 }
 
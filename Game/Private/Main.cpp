@@ -1,18 +1,267 @@
-
+#ifdef _WIN32
 #include <windows.h>
-#include "EngineH.h"
+#endif
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "HeadlessEngine.h"
+#include "SoftwareEngine.h"
+#include "FrameScheduler.h"
+#include "Profiler.h"
+#include "Logger.h"
 #include "Game.h"
 
-int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow)
+#ifndef ENGINEH_NO_GL
+#include "EngineH.h"
+#endif
+
+// Steps the simulation may take in a single frame before it falls behind instead
+const int kMaxSimulationSteps = 5;
+
+// The engines the game can run on
+enum class BACKEND
+{
+	GL = 0,
+	SOFTWARE,
+	HEADLESS
+};
+
+// How to run the game, picked from the command line
+struct RunOptions
+{
+	RunOptions()
+	{
+#ifndef ENGINEH_NO_GL
+		mBackend = BACKEND::GL;
+#else
+		mBackend = BACKEND::SOFTWARE;
+#endif
+		mFrames = 0;
+		mImage = nullptr;
+		mPacing = FRAME_PACING::VSYNC;
+		mTargetRate = 60.0f;
+		mSimulationRate = 0.0f;
+		mFramesInFlight = 1;
+		mTrace = nullptr;
+		mStats = nullptr;
+		mLog = nullptr;
+	}
+
+	BACKEND mBackend;
+	int mFrames;								// the software and headless engines return after this many frames, never if 0
+	const char* mImage;							// where the software engine writes its last frame, if anywhere
+	FRAME_PACING mPacing;						// the pacing only applies to the GL engine, the others run at a fixed step as fast as they can
+	float mTargetRate;
+	float mSimulationRate;						// above 0 the game's simulation runs at that many steps per second, whatever the frame rate
+	int mFramesInFlight;						// frames the GL engine's render thread may lag behind, 0 renders on the game's thread
+	const char* mTrace;							// where the profiler's Chrome trace is written once the game returns, if anywhere, release builds only have scopes in it when built with ENGINEH_ENABLE_PROFILER
+	const char* mStats;							// CSV file the engine appends every frame's render stats to, if any
+	const char* mLog;							// file the log is written to instead of stderr, if any
+};
+
+// Starts the engine's stats file if one was asked for
+static bool OpenStatsFile(exEngineInterface& engine, const char* szFile)
 {
-	EngineH engine;
+	if (szFile != nullptr && !engine.SetRenderStatsFile(szFile))
+	{
+		fprintf(stderr, "Could not write %s\n", szFile);
+		return false;
+	}
+
+	return true;
+}
+
+static int RunGame(const RunOptions& options)
+{
+	const BACKEND eBackend = options.mBackend;
+	const int nFrames = options.mFrames;
+	const char* szImage = options.mImage;
+	const float fFixedStep = (options.mSimulationRate > 0.0f) ? 1.0f / options.mSimulationRate : 0.0f;
+
+	if (options.mLog != nullptr && !Logger::SetFile(options.mLog))
+	{
+		fprintf(stderr, "Could not write %s\n", options.mLog);
+		return 1;
+	}
+
 	exGame game;
 
-	// Initializing the game
-	game.Initialize(&engine);
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	switch (eBackend)
+	{
+	case BACKEND::GL:
+	{
+#ifndef ENGINEH_NO_GL
+		EngineH engine;
+		engine.SetFramePacing(options.mPacing, options.mTargetRate);
+		engine.SetRenderThread(options.mFramesInFlight > 0, options.mFramesInFlight);
+		engine.SetFixedTimestep(fFixedStep, kMaxSimulationSteps);
+
+		if (!OpenStatsFile(engine, options.mStats))
+		{
+			return 1;
+		}
+
+		// Initializing the game
+		game.Initialize(&engine);
+
+		// Running the game
+		engine.Run(&game);
+#else
+		fprintf(stderr, "This build has no GL engine, use --backend=software or --backend=headless\n");
+		return 1;
+#endif
+		break;
+	}
+	case BACKEND::SOFTWARE:
+	{
+		SoftwareEngine engine;
+		engine.SetFrameLimit(nFrames);
+		engine.SetFixedTimestep(fFixedStep, kMaxSimulationSteps);
 
-	// Running the game
-	engine.Run(&game);
+		if (!OpenStatsFile(engine, options.mStats))
+		{
+			return 1;
+		}
+
+		game.Initialize(&engine);
+		engine.Run(&game);
+
+		if (szImage != nullptr && !engine.GetRasterizer().WriteImage(szImage))
+		{
+			fprintf(stderr, "Could not write %s\n", szImage);
+			return 1;
+		}
+		break;
+	}
+	case BACKEND::HEADLESS:
+	{
+		HeadlessEngine engine;
+		engine.SetFrameLimit(nFrames);
+		engine.SetFixedTimestep(fFixedStep, kMaxSimulationSteps);
+
+		if (!OpenStatsFile(engine, options.mStats))
+		{
+			return 1;
+		}
+
+		game.Initialize(&engine);
+		engine.Run(&game);
+
+		printf("last frame: %d commands, %d draws, %zu bytes streamed\n", engine.GetCommandCountLastFrame(), engine.GetDrawCountLastFrame(), engine.GetStreamedBytesLastFrame());
+		break;
+	}
+	}
+
+	// Only reached when there is a frame limit
+	double fMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	printf("%d frames in %.2f ms, %.4f ms per frame\n", nFrames, fMilliseconds, (nFrames > 0) ? fMilliseconds / nFrames : 0.0);
+
+	if (options.mTrace != nullptr && !Profiler::WriteChromeTrace(options.mTrace))
+	{
+		fprintf(stderr, "Could not write %s\n", options.mTrace);
+		return 1;
+	}
 
 	return 0;
-}
\ No newline at end of file
+}
+
+#ifdef _WIN32
+
+int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow)
+{
+	return RunGame(RunOptions());
+}
+
+#else
+
+// Game [--backend=gl|software|headless] [--frames=N] [--image=file.ppm] [--pacing=vsync|fixed|uncapped|adaptive] [--fps=N] [--sim-rate=N] [--render-thread=0|1|2] [--trace=file.json] [--stats=file.csv] [--log=file.txt]
+int main(int argc, char** argv)
+{
+	RunOptions options;
+
+#ifdef ENGINEH_NO_GL
+	options.mBackend = BACKEND::HEADLESS;
+#endif
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "--backend=gl") == 0)
+		{
+			options.mBackend = BACKEND::GL;
+		}
+		else if (strcmp(argv[i], "--backend=software") == 0)
+		{
+			options.mBackend = BACKEND::SOFTWARE;
+		}
+		else if (strcmp(argv[i], "--backend=headless") == 0)
+		{
+			options.mBackend = BACKEND::HEADLESS;
+		}
+		else if (strncmp(argv[i], "--frames=", 9) == 0)
+		{
+			options.mFrames = atoi(argv[i] + 9);
+		}
+		else if (strncmp(argv[i], "--image=", 8) == 0)
+		{
+			options.mImage = argv[i] + 8;
+		}
+		else if (strcmp(argv[i], "--pacing=vsync") == 0)
+		{
+			options.mPacing = FRAME_PACING::VSYNC;
+		}
+		else if (strcmp(argv[i], "--pacing=fixed") == 0)
+		{
+			options.mPacing = FRAME_PACING::FIXED;
+		}
+		else if (strcmp(argv[i], "--pacing=uncapped") == 0)
+		{
+			options.mPacing = FRAME_PACING::UNCAPPED;
+		}
+		else if (strcmp(argv[i], "--pacing=adaptive") == 0)
+		{
+			options.mPacing = FRAME_PACING::ADAPTIVE;
+		}
+		else if (strncmp(argv[i], "--fps=", 6) == 0)
+		{
+			options.mTargetRate = (float)atof(argv[i] + 6);
+		}
+		else if (strncmp(argv[i], "--sim-rate=", 11) == 0)
+		{
+			options.mSimulationRate = (float)atof(argv[i] + 11);
+		}
+		else if (strncmp(argv[i], "--render-thread=", 16) == 0)
+		{
+			options.mFramesInFlight = atoi(argv[i] + 16);
+		}
+		else if (strncmp(argv[i], "--trace=", 8) == 0)
+		{
+			options.mTrace = argv[i] + 8;
+		}
+		else if (strncmp(argv[i], "--stats=", 8) == 0)
+		{
+			options.mStats = argv[i] + 8;
+		}
+		else if (strncmp(argv[i], "--log=", 6) == 0)
+		{
+			options.mLog = argv[i] + 6;
+		}
+		else
+		{
+			fprintf(stderr, "usage: %s [--backend=gl|software|headless] [--frames=N] [--image=file.ppm] [--pacing=vsync|fixed|uncapped|adaptive] [--fps=N] [--sim-rate=N] [--render-thread=0|1|2] [--trace=file.json] [--stats=file.csv] [--log=file.txt]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	// Without a window nothing would ever stop the software and headless engines
+	if (options.mBackend != BACKEND::GL && options.mFrames <= 0)
+	{
+		options.mFrames = 1000;
+	}
+
+	return RunGame(options);
+}
+
+#endif
@@ -1,5 +1,7 @@
 #include "GameInterface.h"
 #include "EngineInterface.h"
+#include "EntityWorld.h"
+#include "SystemScheduler.h"
 
 class exGame : public exGameInterface
 {
@@ -13,11 +15,13 @@ public:
 	virtual void				OnEvent(SDL_Event* pEvent) override;
 	virtual void				OnEventsConsumed() override;
 	virtual void				Run(float fDeltaT) override;
+	virtual void				Render(float fAlpha) override;
 
 private:
 	exEngineInterface *			mEngine;
 
-	exColor						mBoxColor;
-	exVector2					mBoxVertex1;
-	exVector2					mBoxVertex2;
+	EntityWorld					mWorld;
+
+	// Updates mWorld every step of Run
+	SystemScheduler				mSystems;
 };
@@ -39,6 +39,11 @@ public:
 	virtual void				OnEventsConsumed() = 0;
 
 								// run the simulation
+								// with a fixed timestep this is called zero or more times per frame, always with the step's length
 	virtual void				Run( float fDeltaT ) = 0;
 
+								// draw the frame, called once per frame after the simulation has run
+								// fAlpha is how far the frame is between the last simulated step and the next one, 1 without a fixed timestep
+	virtual void				Render( float fAlpha ) {}
+
 };